@@ -0,0 +1,59 @@
+// FILE: backend/bench/HydrationBench.cpp
+#include "database/Database.h"
+#include "repositories/ListingRepository.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+// Час гідратації Listing з рядків БД: findByStatus("active") по rows активних оголошень,
+// view_count рівномірно в [0, 10000). Результат - найкращий з runs прогонів, процесорний час.
+// Збірка: cmake -DAUTORIA_BUILD_BENCH=ON .. && ./HydrationBench [rows] [runs] [db]
+
+static bool seed(Database& db, int rows) {
+    // Оголошення генеруються одним INSERT ... SELECT з рекурсивного CTE
+    std::string sql =
+        "INSERT INTO listings (seller_id, brand_id, model_id, year, price, currency, exchange_rate, "
+        "                      description, region, mileage, status, edit_count, view_count, "
+        "                      created_at, updated_at, fuel_type, transmission, color, body_type) "
+        "WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < " + std::to_string(rows) + ") "
+        "SELECT 1 + n % 100, 1 + n % 20, 1 + n % 200, 2000 + n % 25, 5000 + n % 50000, 'USD', 41.0, "
+        "       'Опис оголошення ' || n, 'Київ', n % 300000, 'active', n % 5, abs(random()) % 10000, "
+        "       1700000000 + n, 1700000000 + n, 'petrol', 'automatic', 'black', 'sedan' "
+        "FROM seq";
+    return db.execute("BEGIN") && db.execute(sql) && db.execute("COMMIT");
+}
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string path = argc > 3 ? argv[3] : "hydration_bench.db";
+    if (rows <= 0 || runs <= 0) {
+        std::fprintf(stderr, "Usage: %s [rows] [runs] [db]\n", argv[0]);
+        return 1;
+    }
+
+    std::remove(path.c_str());
+    std::shared_ptr<Database> db = Database::create(path);
+    if (!db || !db->initializeSchema() || !seed(*db, rows)) {
+        std::fprintf(stderr, "Failed to prepare %s\n", path.c_str());
+        return 1;
+    }
+
+    ListingRepository repository(db);
+    double best = 0;
+    size_t loaded = 0;
+    for (int run = 0; run < runs; ++run) {
+        std::clock_t start = std::clock();
+        auto listings = repository.findByStatus("active");
+        double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        loaded = listings.size();
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+
+    std::printf("findByStatus(active): %zu listings, best of %d: %.1f ms (%.2f us/row)\n",
+                loaded, runs, best * 1000.0, loaded ? best * 1e6 / loaded : 0.0);
+    std::remove(path.c_str());
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include "../models/User.h"
 #include "../models/Listing.h"
 #include "httplib.h"
+#include "../utils/JsonEscape.h"
 #include <sstream>
 #include <regex>
 #include <iostream>
@@ -11,6 +12,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <fstream>
+#include <map>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -74,34 +76,6 @@ static std::string decodeUnicodeEscapes(const std::string& str) {
     return result;
 }
 
-// Функція для екранування JSON рядків (підтримує UTF-8)
-static std::string escapeJson(const std::string& str) {
-    std::ostringstream oss;
-    for (size_t i = 0; i < str.length(); ++i) {
-        unsigned char c = static_cast<unsigned char>(str[i]);
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                // Контрольні символи (0x00-0x1F) екрануються як \uXXXX
-                if (c < 0x20) {
-                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') 
-                        << static_cast<int>(c);
-                } else {
-                    // Всі інші символи (включаючи UTF-8) додаються як є
-                    oss << c;
-                }
-                break;
-        }
-    }
-    return oss.str();
-}
-
 // Перевірка, чи рядок є валідним UTF-8
 static bool isLikelyUtf8(const std::string& s) {
     const unsigned char* bytes = reinterpret_cast<const unsigned char*>(s.data());
@@ -211,24 +185,164 @@ static std::string sanitizeText(const std::string& in) {
     return out;
 }
 
+// Значення фільтра-списку: "1,5,9"; повторний ключ додає до вже заданих
+static void appendListValues(const std::string& value, std::vector<std::string>& out) {
+    std::istringstream iss(value);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+}
+
+static void appendIntValues(const std::string& value, std::vector<int>& out) {
+    std::vector<std::string> items;
+    appendListValues(value, items);
+    for (const auto& item : items) {
+        try { out.push_back(std::stoi(item)); } catch (...) {}
+    }
+}
+
+// Запис в історію цін; валюта - канонічний код оголошення
+static bool insertPriceHistory(sqlite3* handle, int listingId, double price, Currency currency) {
+    const char* sql = "INSERT INTO price_history (listing_id, price, currency, changed_at) VALUES (?, ?, ?, ?)";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    const std::string& code = currencyName(currency);
+    sqlite3_bind_int(stmt, 1, listingId);
+    sqlite3_bind_double(stmt, 2, price);
+    sqlite3_bind_text(stmt, 3, code.c_str(), static_cast<int>(code.length()), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(time(nullptr)));
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+const size_t ApiServer::kHttpThreads;
+const size_t ApiServer::kMaxEventStreams;
+
 ApiServer::ApiServer(std::shared_ptr<UserRepository> userRepo,
                      std::shared_ptr<ListingRepository> listingRepo,
                      std::shared_ptr<BrandRepository> brandRepo,
                      std::shared_ptr<ModelRepository> modelRepo,
+                     std::shared_ptr<MessageRepository> messageRepo,
                      std::shared_ptr<AuthMiddleware> auth,
                      int port)
     : userRepository_(userRepo), listingRepository_(listingRepo),
       brandRepository_(brandRepo), modelRepository_(modelRepo),
-      authMiddleware_(auth), port_(port), server_(nullptr) {
-    moderationService_ = std::make_shared<ModerationService>();
+      messageRepository_(messageRepo), authMiddleware_(auth), port_(port), server_(nullptr) {
+    // Словник модерації з файлу; поки файлу немає - вбудований список (reload підхопить файл пізніше)
+    moderationService_ = std::make_shared<ModerationService>("/app/build/data/bad_words.txt");
     currencyService_ = CurrencyService::getInstance(); // Singleton
     // StatisticsService потребує Database та ListingRepository
     auto db = listingRepo->getDb();
+    
+    // Курси з локального файлу, якщо він є; інакше - фіксовані курси
+    const std::string ratesFile = "/app/build/data/exchange_rates.json";
+    struct stat ratesStat;
+    if (stat(ratesFile.c_str(), &ratesStat) == 0) {
+        currencyService_->setProvider(std::make_unique<FileExchangeRateProvider>(ratesFile));
+    }
+    if (!currencyService_->attachDatabase(db)) {
+        std::cerr << "Failed to load exchange rate history" << std::endl;
+    }
+    currencyService_->startBackgroundRefresh(std::chrono::seconds(3600));
+    
+    // Довідник регіонів: нормалізація регіону при записі, фільтр по region_id
+    regionDirectory_ = std::make_shared<RegionDirectory>(db);
+    if (!regionDirectory_->load()) {
+        std::cerr << "Failed to load region directory" << std::endl;
+    }
+    listingRepository_->setRegionDirectory(regionDirectory_);
+    if (!regionDirectory_->backfillListings()) {
+        std::cerr << "Failed to backfill listing regions" << std::endl;
+    }
     statisticsService_ = std::make_shared<StatisticsService>(db, listingRepo);
+    
+    // Лічильники платформи: звірка при старті, далі - оновлення з репозиторіїв
+    platformCounters_ = std::make_shared<PlatformCounters>(db);
+    if (!platformCounters_->reconcile()) {
+        std::cerr << "Failed to load platform counters" << std::endl;
+    }
+    listingRepository_->addObserver(platformCounters_);
+    userRepository_->addObserver(platformCounters_);
+    platformCounters_->startReconciliation(std::chrono::seconds(600));
+    
+    // Індекс відбитків описів для пошуку дублікатів
+    duplicateIndex_ = std::make_shared<DuplicateIndex>(db);
+    if (!duplicateIndex_->load()) {
+        std::cerr << "Failed to load duplicate index" << std::endl;
+    }
+    listingRepository_->addObserver(duplicateIndex_);
+    
+    // Модель "також переглядали": побудова у фоні при старті, далі - кожні 30 хв
+    coViewModel_ = std::make_shared<CoViewModel>(db);
+    coViewModel_->startPeriodicRebuild(std::chrono::seconds(1800));
+    
+    // Індекс ознак активних оголошень для "схожих оголошень"
+    featureIndex_ = std::make_shared<FeatureIndex>();
+    if (!featureIndex_->load(*db)) {
+        std::cerr << "Failed to load feature index" << std::endl;
+    }
+    listingRepository_->addObserver(featureIndex_);
+    
+    // Профілі вподобань для персональних рекомендацій (кандидати - рядки індексу ознак)
+    userPreferences_ = std::make_shared<UserPreferenceService>(db, featureIndex_);
+    
+    // Колонка price_uah з'явилась після першого релізу - заповнюємо для старих оголошень
+    if (!listingRepository_->backfillPriceUah()) {
+        std::cerr << "Failed to backfill listing prices in UAH" << std::endl;
+    }
+    
+    // Бітмап-індекс фільтрів каталогу - після дозаповнення region_id та price_uah
+    facetIndex_ = std::make_shared<ListingFacetIndex>();
+    if (!facetIndex_->load(*db)) {
+        std::cerr << "Failed to load facet index" << std::endl;
+    }
+    listingRepository_->addObserver(facetIndex_);
+    
+    // Кількість результатів текстового пошуку - підрахунок у фоні, до нього - оцінка
+    searchCounts_ = std::make_shared<SearchCountCache>(db->getPath(), listingRepository_);
+    listingRepository_->addObserver(searchCounts_);
+    searchCounts_->start();
+    
+    // Упорядковані списки id повторюваних запитів; зміна оголошення скидає записи з його тегами
+    searchResults_ = std::make_shared<SearchResultCache>();
+    listingRepository_->addObserver(searchResults_);
+    
+    // Готовий JSON сторінок оголошень; скидається зміною оголошення, не переглядом
+    listingJson_ = std::make_shared<ListingJsonCache>();
+    listingRepository_->addObserver(listingJson_);
+    
+    // Таблиця розмов з'явилась після першого релізу - заповнюємо з наявних повідомлень
+    if (!messageRepository_->backfillConversations()) {
+        std::cerr << "Failed to backfill conversations" << std::endl;
+    }
+    
+    // Push-події для підключених клієнтів (SSE / long-poll)
+    eventHub_ = std::make_shared<EventHub>(kMaxEventStreams);
+    
+    // Лічильники непрочитаного: звірка при старті, далі - оновлення після кожного запису
+    unreadCounters_ = std::make_shared<UnreadCounters>(db);
+    if (!unreadCounters_->reconcile()) {
+        std::cerr << "Failed to load unread counters" << std::endl;
+    }
+    unreadCounters_->startReconciliation(std::chrono::seconds(300));
+    
+    // Асинхронна модерація: повертаємо в чергу все, що не встигли промодерувати до рестарту
+    moderationQueue_ = std::make_shared<ModerationQueue>(db->getPath(), moderationService_, listingRepository_,
+                                                         eventHub_, unreadCounters_);
+    moderationQueue_->recoverPending(*db);
+    moderationQueue_->start();
 }
 
 ApiServer::~ApiServer() {
     stop();
+    moderationQueue_->stop();
+    searchCounts_->stop();
+    coViewModel_->stopPeriodicRebuild();
+    unreadCounters_->stopReconciliation();
 }
 
 std::string ApiServer::extractAuthToken(const std::string& header) {
@@ -239,6 +353,58 @@ std::string ApiServer::extractAuthToken(const std::string& header) {
     return header;
 }
 
+std::string ApiServer::serializeListings(const std::vector<std::unique_ptr<Listing>>& listings, bool withSeller) {
+    auto prices = Listing::convertPage(listings);
+    std::map<int, std::unique_ptr<User>> sellers;
+    
+    std::ostringstream oss;
+    oss << "[";
+    for (size_t i = 0; i < listings.size(); ++i) {
+        if (i > 0) oss << ",";
+        std::string json = listings[i]->toJson(prices.usd[i], prices.eur[i], prices.uah[i]);
+        if (withSeller) {
+            appendSeller(json, listings[i]->getSellerId(), sellers);
+        }
+        oss << json;
+    }
+    oss << "]";
+    return oss.str();
+}
+
+std::string ApiServer::serializeSummaries(const std::vector<ListingSummary>& summaries, bool withSeller) {
+    auto prices = ListingSummary::convertPage(summaries);
+    std::map<int, std::unique_ptr<User>> sellers;
+    
+    std::ostringstream oss;
+    oss << "[";
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        if (i > 0) oss << ",";
+        std::string json = summaries[i].toJson(prices.usd[i], prices.eur[i], prices.uah[i]);
+        if (withSeller) {
+            appendSeller(json, summaries[i].sellerId, sellers);
+        }
+        oss << json;
+    }
+    oss << "]";
+    return oss.str();
+}
+
+void ApiServer::appendSeller(std::string& json, int sellerId, std::map<int, std::unique_ptr<User>>& sellers) {
+    auto it = sellers.find(sellerId);
+    if (it == sellers.end()) {
+        it = sellers.emplace(sellerId, userRepository_->findById(sellerId)).first;
+    }
+    const auto& seller = it->second;
+    if (seller) {
+        // Додаємо інформацію про продавця
+        json.pop_back(); // видаляємо закриваючу дужку
+        json += ",\"seller\":{\"id\":" + std::to_string(seller->getId()) +
+                ",\"email\":\"" + escapeJson(seller->getEmail()) + "\"" +
+                ",\"firstName\":\"" + escapeJson(seller->getFirstName()) + "\"" +
+                ",\"lastName\":\"" + escapeJson(seller->getLastName()) + "\"}}";
+    }
+}
+
 std::string ApiServer::handleUploadPhoto(int listingId, const httplib::Request& req, const std::string& authToken) {
     // Перевірка авторизації
     auto user = authMiddleware_->authenticate(authToken);
@@ -327,9 +493,9 @@ std::string ApiServer::handleUploadPhoto(int listingId, const httplib::Request&
     }
     photosJson << "]";
     
-    // Оновлюємо оголошення
+    // Оновлюємо лише колонку photos
     listing->setPhotos(photosJson.str());
-    if (listingRepository_->update(std::move(listing))) {
+    if (listingRepository_->updateFields(*listing)) {
         std::ostringstream oss;
         oss << "{\"success\":true,\"message\":\"Photo uploaded\",\"photos\":" << photosJson.str() << "}";
         return oss.str();
@@ -341,11 +507,13 @@ std::string ApiServer::handleUploadPhoto(int listingId, const httplib::Request&
 bool ApiServer::start() {
     auto* srv = new httplib::Server;
     server_ = srv;
+    srv->new_task_queue = [] { return new httplib::ThreadPool(kHttpThreads); };
     
     srv->set_default_headers({
         {"Access-Control-Allow-Origin", "*"},
-        {"Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS"},
+        {"Access-Control-Allow-Methods", "GET, POST, PUT, PATCH, DELETE, OPTIONS"},
         {"Access-Control-Allow-Headers", "Content-Type, Authorization"},
+        {"Access-Control-Expose-Headers", "X-Cursor-Before, X-Cursor-After, X-Total-Count, X-Total-Is-Estimate"},
         {"Content-Type", "application/json; charset=utf-8"}
     });
     
@@ -374,7 +542,16 @@ bool ApiServer::start() {
             if (!queryString.empty()) queryString += "&";
             queryString += param.first + "=" + param.second;
         }
-        res.set_content(handleGetListingsFiltered(queryString), "application/json; charset=utf-8");
+        // Загальна кількість для пагінації; оцінка позначається окремим заголовком
+        size_t total = 0;
+        bool totalIsEstimate = false;
+        std::string result = handleGetListingsFiltered(queryString, &total, &totalIsEstimate);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 400;
+        }
+        res.set_header("X-Total-Count", std::to_string(total));
+        res.set_header("X-Total-Is-Estimate", totalIsEstimate ? "true" : "false");
+        res.set_content(result, "application/json; charset=utf-8");
     });
     
     // GET /api/listings/my - отримати свої оголошення (потрібна авторизація)
@@ -391,8 +568,7 @@ bool ApiServer::start() {
     // GET /api/listings/{id} - отримати конкретне оголошення
     srv->Get(R"(/api/listings/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
         int id = std::stoi(req.matches[1]);
-        std::string token = extractAuthToken(req.get_header_value("Authorization"));
-        std::string result = handleGetListing(id, token);
+        std::string result = handleGetListing(id);
         if (result.find("\"error\"") != std::string::npos) {
             res.status = 404;
         }
@@ -401,6 +577,30 @@ bool ApiServer::start() {
         res.set_header("Content-Type", "application/json; charset=utf-8");
     });
     
+    // GET /api/listings/{id}/price-history - історія цін з конвертацією за курсом на дату зміни
+    srv->Get(R"(/api/listings/(\d+)/price-history)", [this](const httplib::Request& req, httplib::Response& res) {
+        int id = std::stoi(req.matches[1]);
+        std::string result = handleGetPriceHistory(id);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 404;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
+    // GET /api/listings/{id}/similar - схожі оголошення за характеристиками
+    srv->Get(R"(/api/listings/(\d+)/similar)", [this](const httplib::Request& req, httplib::Response& res) {
+        int id = std::stoi(req.matches[1]);
+        size_t limit = 10;
+        if (req.has_param("limit")) {
+            try { limit = static_cast<size_t>(std::max(1, std::min(50, std::stoi(req.get_param_value("limit"))))); } catch (...) {}
+        }
+        std::string result = handleGetSimilarListings(id, limit);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 404;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
     // POST /api/listings - створити оголошення
     srv->Post("/api/listings", [this](const httplib::Request& req, httplib::Response& res) {
         std::string token = extractAuthToken(req.get_header_value("Authorization"));
@@ -424,6 +624,18 @@ bool ApiServer::start() {
         res.set_content(result, "application/json; charset=utf-8");
     });
     
+    // PATCH /api/listings/{id} - часткове оновлення: лише передані поля, UPDATE лише змінених колонок
+    // (PUT лишається для сумісності і обробляється так само)
+    srv->Patch(R"(/api/listings/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+        int id = std::stoi(req.matches[1]);
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        std::string result = handleUpdateListing(id, req.body, token);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 400;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
     // DELETE /api/listings/{id} - видалити оголошення
     srv->Delete(R"(/api/listings/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
         int id = std::stoi(req.matches[1]);
@@ -442,6 +654,11 @@ bool ApiServer::start() {
         res.set_content(handleGetBrands(), "application/json; charset=utf-8");
     });
     
+    // GET /api/regions - довідник регіонів (id для фільтра region_id)
+    srv->Get("/api/regions", [this](const httplib::Request&, httplib::Response& res) {
+        res.set_content(handleGetRegions(), "application/json; charset=utf-8");
+    });
+    
     // GET /api/brands/{id}/models - отримати моделі марки
     srv->Get(R"(/api/brands/(\d+)/models)", [this](const httplib::Request& req, httplib::Response& res) {
         int brandId = std::stoi(req.matches[1]);
@@ -573,6 +790,36 @@ bool ApiServer::start() {
         res.set_content(result, "application/json; charset=utf-8");
     });
     
+    // POST /api/notifications/read-all - позначити всі сповіщення як прочитані
+    srv->Post("/api/notifications/read-all", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string result = handleMarkAllNotificationsRead(token);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 400;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
+    // GET /api/unread - кількість непрочитаних сповіщень та повідомлень (бейджі)
+    srv->Get("/api/unread", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string result = handleGetUnreadCounts(token);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 400;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
     // POST /api/messages - надіслати повідомлення
     srv->Post("/api/messages", [this](const httplib::Request& req, httplib::Response& res) {
         std::string token = extractAuthToken(req.get_header_value("Authorization"));
@@ -587,6 +834,35 @@ bool ApiServer::start() {
     
     // GET /api/messages - отримати повідомлення
     srv->Get("/api/messages", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        int otherUserId = 0;
+        if (req.has_param("user_id")) {
+            try { otherUserId = std::stoi(req.get_param_value("user_id")); } catch (...) {}
+        }
+        int limit = 0;
+        if (req.has_param("limit")) {
+            try { limit = std::stoi(req.get_param_value("limit")); } catch (...) {}
+        }
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string olderCursor;
+        std::string newerCursor;
+        std::string result = handleGetMessages(token, otherUserId, req.get_param_value("before"),
+                                               req.get_param_value("after"), limit, &olderCursor, &newerCursor);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 400;
+        }
+        // Курсори для наступних запитів: before - старіші повідомлення, after - новіші
+        if (!olderCursor.empty()) res.set_header("X-Cursor-Before", olderCursor);
+        if (!newerCursor.empty()) res.set_header("X-Cursor-After", newerCursor);
+        res.set_content(result, "application/json");
+    });
+    
+    // POST /api/messages/read-all?user_id= - позначити прочитаними всі повідомлення (або переписку з user_id)
+    srv->Post("/api/messages/read-all", [this](const httplib::Request& req, httplib::Response& res) {
         std::string token = extractAuthToken(req.get_header_value("Authorization"));
         int otherUserId = 0;
         if (req.has_param("user_id")) {
@@ -597,7 +873,11 @@ bool ApiServer::start() {
             res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
             return;
         }
-        res.set_content(handleGetMessages(token, otherUserId), "application/json");
+        std::string result = handleMarkAllMessagesRead(otherUserId, token);
+        if (result.find("\"error\"") != std::string::npos) {
+            res.status = 400;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
     });
     
     // POST /api/messages/{id}/read - позначити повідомлення як прочитане
@@ -626,6 +906,21 @@ bool ApiServer::start() {
         res.set_content(result, "application/json; charset=utf-8");
     });
     
+    // GET /api/admin/listings/duplicates - можливі дублікати оголошень (модератор)
+    srv->Get("/api/admin/listings/duplicates", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string result = handleGetDuplicateListings(token);
+        if (result.find("\"Unauthorized\"") != std::string::npos) {
+            res.status = 403;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
     // POST /api/admin/listings/{id}/moderate - модерація оголошення
     srv->Post(R"(/api/admin/listings/(\d+)/moderate)", [this](const httplib::Request& req, httplib::Response& res) {
         int id = std::stoi(req.matches[1]);
@@ -686,6 +981,42 @@ bool ApiServer::start() {
         res.set_content(result, "application/json; charset=utf-8");
     });
     
+    // POST /api/admin/moderation/reload - перечитати словник модерації (адмін)
+    srv->Post("/api/admin/moderation/reload", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string result = handleReloadModerationDictionary(token);
+        if (result.find("\"Invalid token\"") != std::string::npos) {
+            res.status = 401;
+        } else if (result.find("\"Unauthorized\"") != std::string::npos) {
+            res.status = 403;
+        } else if (result.find("\"error\"") != std::string::npos) {
+            res.status = 500; // Словник не прочитано - лишилась попередня версія
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
+    // POST /api/admin/recommendations/rebuild - перебудувати модель рекомендацій (адмін)
+    srv->Post("/api/admin/recommendations/rebuild", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string result = handleRebuildRecommendations(token);
+        if (result.find("\"Unauthorized\"") != std::string::npos) {
+            res.status = 403;
+        } else if (result.find("\"error\"") != std::string::npos) {
+            res.status = 500;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
     // POST /api/listings/compare - порівняти оголошення
     srv->Post("/api/listings/compare", [this](const httplib::Request& req, httplib::Response& res) {
         std::string token = extractAuthToken(req.get_header_value("Authorization"));
@@ -784,6 +1115,109 @@ bool ApiServer::start() {
         res.set_content(result, "application/json; charset=utf-8");
     });
     
+    // GET /api/events - події користувача: SSE (text/event-stream) або ?poll=1 - long-poll (JSON)
+    srv->Get("/api/events", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            // EventSource у браузері не передає заголовки
+            token = req.get_param_value("access_token");
+        }
+        auto user = token.empty() ? nullptr : authMiddleware_->authenticate(token);
+        if (!user) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        
+        uint64_t lastEventId = 0;
+        std::string lastEventHeader = req.has_header("Last-Event-ID") ? req.get_header_value("Last-Event-ID")
+                                                                       : req.get_param_value("last_event_id");
+        if (!lastEventHeader.empty()) {
+            try { lastEventId = std::stoull(lastEventHeader); } catch (...) {}
+        }
+        
+        int userId = user->getId();
+        uint64_t currentEventId = 0;
+        if (!eventHub_->connect(userId, currentEventId)) {
+            res.status = 503;
+            res.set_header("Retry-After", "5");
+            res.set_content("{\"error\":\"Too many event streams\"}", "application/json; charset=utf-8");
+            return;
+        }
+        if (lastEventId == 0) {
+            lastEventId = currentEventId;
+        }
+        
+        if (req.has_param("poll")) {
+            auto events = eventHub_->waitForEvents(userId, lastEventId, std::chrono::seconds(25));
+            eventHub_->disconnect(userId);
+            std::ostringstream oss;
+            oss << "{\"events\":[";
+            for (size_t i = 0; i < events.size(); ++i) {
+                if (i > 0) oss << ",";
+                oss << "{\"id\":" << events[i].id << ",\"type\":\"" << events[i].type << "\",\"data\":" << events[i].data << "}";
+                lastEventId = events[i].id;
+            }
+            oss << "],\"lastEventId\":" << lastEventId << "}";
+            res.set_content(oss.str(), "application/json; charset=utf-8");
+            return;
+        }
+        
+        auto cursor = std::make_shared<uint64_t>(lastEventId);
+        res.headers.erase("Content-Type");
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("X-Accel-Buffering", "no");
+        res.set_chunked_content_provider("text/event-stream",
+            [this, userId, cursor](size_t, httplib::DataSink& sink) {
+                // Порожня відповідь за 15 с - коментар-heartbeat, він же виявляє закрите з'єднання
+                auto events = eventHub_->waitForEvents(userId, *cursor, std::chrono::seconds(15));
+                if (eventHub_->isStopping()) {
+                    return false;
+                }
+                std::string chunk = events.empty() ? ": keep-alive\n\n" : "";
+                for (const auto& event : events) {
+                    chunk += EventHub::formatSse(event);
+                    *cursor = event.id;
+                }
+                return sink.write(chunk.data(), chunk.size());
+            },
+            [this, userId](bool) { eventHub_->disconnect(userId); });
+    });
+    
+    // GET /api/admin/events/stats - підключення та затримка доставки подій
+    srv->Get("/api/admin/events/stats", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string result = handleGetEventStats(token);
+        if (result.find("\"Unauthorized\"") != std::string::npos) {
+            res.status = 403;
+        } else if (result.find("\"error\"") != std::string::npos) {
+            res.status = 401;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
+    // GET /api/admin/cache/stats - заповнення та влучання кешів відповідей (адмін)
+    srv->Get("/api/admin/cache/stats", [this](const httplib::Request& req, httplib::Response& res) {
+        std::string token = extractAuthToken(req.get_header_value("Authorization"));
+        if (token.empty()) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json; charset=utf-8");
+            return;
+        }
+        std::string result = handleGetCacheStats(token);
+        if (result.find("\"Unauthorized\"") != std::string::npos) {
+            res.status = 403;
+        } else if (result.find("\"error\"") != std::string::npos) {
+            res.status = 401;
+        }
+        res.set_content(result, "application/json; charset=utf-8");
+    });
+    
     // POST /api/auth/login - логін
     srv->Post("/api/auth/login", [this](const httplib::Request& req, httplib::Response& res) {
         std::string result = handleLogin(req.body);
@@ -808,6 +1242,8 @@ bool ApiServer::start() {
 }
 
 void ApiServer::stop() {
+    // Будимо потоки подій, інакше зупинка сервера чекатиме їхніх таймаутів
+    eventHub_->shutdown();
     if (server_) {
         auto* srv = static_cast<httplib::Server*>(server_);
         srv->stop();
@@ -817,43 +1253,28 @@ void ApiServer::stop() {
 }
 
 std::string ApiServer::handleGetListings(const std::string& query) {
-    auto listings = listingRepository_->findActive();
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < listings.size(); ++i) {
-        if (i > 0) oss << ",";
-        auto seller = userRepository_->findById(listings[i]->getSellerId());
-        std::string json = listings[i]->toJson();
-        if (seller) {
-            // Додаємо інформацію про продавця
-            json.pop_back(); // видаляємо закриваючу дужку
-            json += ",\"seller\":{\"id\":" + std::to_string(seller->getId()) +
-                    ",\"email\":\"" + escapeJson(seller->getEmail()) + "\"" +
-                    ",\"firstName\":\"" + escapeJson(seller->getFirstName()) + "\"" +
-                    ",\"lastName\":\"" + escapeJson(seller->getLastName()) + "\"}}";
-        }
-        oss << json;
-    }
-    oss << "]";
-    return oss.str();
+    auto summaries = listingRepository_->findActiveSummaries();
+    return serializeSummaries(summaries, true);
 }
 
-std::string ApiServer::handleGetListingsFiltered(const std::string& queryString) {
+std::string ApiServer::handleGetListingsFiltered(const std::string& queryString, size_t* total, bool* totalIsEstimate) {
     // Парсимо query параметри
-    std::string searchQuery = "";
-    int brandId = 0;
-    int modelId = 0;
-    double minPrice = 0;
-    double maxPrice = 0;
-    std::string region = "";
-    std::string fuelType = "";
-    std::string transmission = "";
+    ListingFilter filter;
+    std::string priceCurrency = "UAH"; // Валюта меж min_price/max_price
     std::string sortBy = "created_at";
     std::string sortOrder = "DESC";
     int page = 1;
     int perPage = 10;
     
-    // Парсимо query string (формат: "key1=value1&key2=value2")
+    auto parseInt = [](const std::string& value, int& out) {
+        try { out = std::stoi(value); } catch (...) {}
+    };
+    auto parseDouble = [](const std::string& value, double& out) {
+        try { out = std::stod(value); } catch (...) {}
+    };
+    
+    // Парсимо query string (формат: "key1=value1&key2=value2");
+    // фільтри-списки приймають "brand=1,5,9" і повторні ключі
     if (!queryString.empty()) {
         std::istringstream iss(queryString);
         std::string pair;
@@ -864,60 +1285,149 @@ std::string ApiServer::handleGetListingsFiltered(const std::string& queryString)
                 std::string value = pair.substr(pos + 1);
                 
                 if (key == "search") {
-                    searchQuery = value;
+                    filter.searchQuery = value;
                 } else if (key == "brand" || key == "brand_id") {
-                    try { brandId = std::stoi(value); } catch (...) {}
+                    appendIntValues(value, filter.brandIds);
                 } else if (key == "model" || key == "model_id") {
-                    try { modelId = std::stoi(value); } catch (...) {}
+                    appendIntValues(value, filter.modelIds);
                 } else if (key == "min_price") {
-                    try { minPrice = std::stod(value); } catch (...) {}
+                    parseDouble(value, filter.minPriceUah);
                 } else if (key == "max_price") {
-                    try { maxPrice = std::stod(value); } catch (...) {}
+                    parseDouble(value, filter.maxPriceUah);
+                } else if (key == "price_currency") {
+                    priceCurrency = value;
                 } else if (key == "region") {
-                    region = value;
+                    filter.region = value;
+                } else if (key == "region_id") {
+                    // id з /api/regions; невідомий id фільтра не задає
+                    int regionId = 0;
+                    parseInt(value, regionId);
+                    filter.region = regionDirectory_->name(regionId);
                 } else if (key == "fuel_type") {
-                    fuelType = value;
+                    appendListValues(value, filter.fuelTypes);
                 } else if (key == "transmission") {
-                    transmission = value;
+                    appendListValues(value, filter.transmissions);
+                } else if (key == "body_type") {
+                    appendListValues(value, filter.bodyTypes);
+                } else if (key == "color") {
+                    appendListValues(value, filter.colors);
+                } else if (key == "min_year") {
+                    parseInt(value, filter.minYear);
+                } else if (key == "max_year") {
+                    parseInt(value, filter.maxYear);
+                } else if (key == "min_mileage") {
+                    parseInt(value, filter.minMileage);
+                } else if (key == "max_mileage") {
+                    parseInt(value, filter.maxMileage);
+                } else if (key == "min_engine_volume") {
+                    parseDouble(value, filter.minEngineVolume);
+                } else if (key == "max_engine_volume") {
+                    parseDouble(value, filter.maxEngineVolume);
+                } else if (key == "min_engine_power") {
+                    parseInt(value, filter.minEnginePower);
+                } else if (key == "max_engine_power") {
+                    parseInt(value, filter.maxEnginePower);
                 } else if (key == "sort") {
                     sortBy = value;
                 } else if (key == "order") {
                     sortOrder = value;
                 } else if (key == "page") {
-                    try { page = std::stoi(value); } catch (...) {}
+                    parseInt(value, page);
                 } else if (key == "per_page") {
-                    try { perPage = std::stoi(value); } catch (...) {}
+                    parseInt(value, perPage);
                 }
             }
         }
     }
     
+    if (page < 1) page = 1;
+    if (perPage < 1) perPage = 10;
     int offset = (page - 1) * perPage;
     
-    // Використовуємо новий метод пошуку та фільтрації
-    auto listings = listingRepository_->searchAndFilter(
-        searchQuery, brandId, modelId, minPrice, maxPrice,
-        region, fuelType, transmission, sortBy, sortOrder,
-        perPage, offset
-    );
-    
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < listings.size(); ++i) {
-        if (i > 0) oss << ",";
-        auto seller = userRepository_->findById(listings[i]->getSellerId());
-        std::string json = listings[i]->toJson();
-        if (seller) {
-            json.pop_back();
-            json += ",\"seller\":{\"id\":" + std::to_string(seller->getId()) +
-                    ",\"email\":\"" + escapeJson(seller->getEmail()) + "\"" +
-                    ",\"firstName\":\"" + escapeJson(seller->getFirstName()) + "\"" +
-                    ",\"lastName\":\"" + escapeJson(seller->getLastName()) + "\"}}";
+    Currency boundsCurrency;
+    if (!tryParseCurrency(priceCurrency, boundsCurrency)) {
+        return "{\"error\":\"Unknown price_currency: " + escapeJson(priceCurrency) + "\"}";
+    }
+    
+    // Межі переводимо в гривні один раз на запит - фільтр іде по збереженій price_uah
+    double toUah = currencyService_->getSnapshot()->toUah[static_cast<size_t>(boundsCurrency)];
+    filter.minPriceUah *= toUah;
+    filter.maxPriceUah *= toUah;
+    if (!filter.region.empty()) {
+        filter.regionId = regionDirectory_->resolve(filter.region);
+    }
+    
+    std::vector<ListingSummary> summaries;
+    size_t count = 0;
+    bool estimated = false;
+    const size_t pageEnd = static_cast<size_t>(offset) + static_cast<size_t>(perPage);
+    if (SearchResultCache::cacheable(sortBy) && pageEnd <= SearchResultCache::kMaxIds) {
+        // Перші сторінки повторюваних запитів - зріз кешованого списку id і одна вибірка карток
+        std::string key = SearchResultCache::keyOf(filter, sortBy, sortOrder);
+        SearchResultCache::Result cached;
+        if (!searchResults_->lookup(key, cached)) {
+            uint64_t version = searchResults_->version();
+            ListingFacetIndex::ResultPage head;
+            if (facetIndex_->query(filter, sortBy, sortOrder, SearchResultCache::kMaxIds, 0, head)) {
+                cached.ids = std::move(head.ids);
+                cached.total = head.total;
+                cached.totalKnown = true;
+            } else {
+                cached.ids = listingRepository_->searchIds(filter, sortBy, sortOrder, SearchResultCache::kMaxIds, 0);
+                cached.total = cached.ids.size();
+                cached.totalKnown = cached.ids.size() < SearchResultCache::kMaxIds;
+            }
+            searchResults_->store(key, filter, cached, version);
+        }
+        size_t from = std::min(static_cast<size_t>(offset), cached.ids.size());
+        size_t to = std::min(pageEnd, cached.ids.size());
+        summaries = listingRepository_->findSummariesByIds(std::vector<int>(cached.ids.begin() + from,
+                                                                            cached.ids.begin() + to));
+        count = cached.totalKnown ? cached.total : searchTotal(filter, offset, perPage, summaries.size(), estimated);
+    } else {
+        // Фасетні фільтри - перетин бітмапів індексу і одна вибірка карток сторінки;
+        // текстовий пошук, регіон поза довідником і сортування за переглядами - SQL
+        ListingFacetIndex::ResultPage result;
+        if (facetIndex_->query(filter, sortBy, sortOrder, perPage, offset, result)) {
+            summaries = listingRepository_->findSummariesByIds(result.ids);
+            count = result.total;
+        } else {
+            summaries = listingRepository_->searchSummaries(filter, sortBy, sortOrder, perPage, offset);
+            count = searchTotal(filter, offset, perPage, summaries.size(), estimated);
         }
-        oss << json;
     }
-    oss << "]";
-    return oss.str();
+    
+    if (total) *total = count;
+    if (totalIsEstimate) *totalIsEstimate = estimated;
+    return serializeSummaries(summaries, true);
+}
+
+size_t ApiServer::searchTotal(const ListingFilter& filter, int offset, int perPage, size_t pageRows, bool& estimated) {
+    // Структурна частина фільтра рахується індексом точно; вона ж - верхня межа
+    ListingFilter structured = filter;
+    structured.searchQuery.clear();
+    if (structured.regionId == 0) structured.region.clear();
+    ListingFacetIndex::ResultPage bound;
+    facetIndex_->query(structured, "created_at", "DESC", 0, 0, bound);
+    
+    bool textual = !filter.searchQuery.empty() || (!filter.region.empty() && filter.regionId == 0);
+    size_t seen = static_cast<size_t>(offset) + pageRows;
+    size_t count = 0;
+    estimated = false;
+    if (!textual) {
+        // Лише сортування поза індексом (view_count) - кількість з індексу точна
+        count = bound.total;
+    } else if (pageRows < static_cast<size_t>(perPage) && (pageRows > 0 || offset == 0)) {
+        // Неповна сторінка - останні результати
+        count = seen;
+    } else if (!searchCounts_->lookup(SearchCountCache::keyOf(filter), count)) {
+        // Оцінка до фонового підрахунку: не менше вже побачених, не більше межі індексу
+        double expected = bound.total * searchCounts_->selectivity(SearchCountCache::textKeyOf(filter));
+        count = std::max(seen, std::min(bound.total, static_cast<size_t>(expected + 0.5)));
+        estimated = true;
+        searchCounts_->requestCount(filter, bound.total);
+    }
+    return count;
 }
 
 std::string ApiServer::handleAddToFavorites(int listingId, const std::string& authToken) {
@@ -946,9 +1456,13 @@ std::string ApiServer::handleAddToFavorites(int listingId, const std::string& au
         sqlite3_bind_int(stmt, 3, now);
         
         int rc = sqlite3_step(stmt);
+        bool added = sqlite3_changes(db->getHandle()) > 0;
         sqlite3_finalize(stmt);
         
         if (rc == SQLITE_DONE) {
+            if (added) {
+                userPreferences_->recordSignal(user->getId(), *listing, PreferenceSignal::Favorite);
+            }
             return "{\"success\":true,\"message\":\"Added to favorites\"}";
         }
     }
@@ -1005,26 +1519,8 @@ std::string ApiServer::handleGetFavorites(const std::string& authToken) {
     }
     sqlite3_finalize(stmt);
     
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < listingIds.size(); ++i) {
-        auto listing = listingRepository_->findById(listingIds[i]);
-        if (listing) {
-            if (i > 0) oss << ",";
-            auto seller = userRepository_->findById(listing->getSellerId());
-            std::string json = listing->toJson();
-            if (seller) {
-                json.pop_back();
-                json += ",\"seller\":{\"id\":" + std::to_string(seller->getId()) +
-                        ",\"email\":\"" + escapeJson(seller->getEmail()) + "\"" +
-                        ",\"firstName\":\"" + escapeJson(seller->getFirstName()) + "\"" +
-                        ",\"lastName\":\"" + escapeJson(seller->getLastName()) + "\"}}";
-            }
-            oss << json;
-        }
-    }
-    oss << "]";
-    return oss.str();
+    auto summaries = listingRepository_->findSummariesByIds(listingIds);
+    return serializeSummaries(summaries, true);
 }
 
 std::string ApiServer::handleAddComment(int listingId, const std::string& body, const std::string& authToken) {
@@ -1063,19 +1559,17 @@ std::string ApiServer::handleAddComment(int listingId, const std::string& body,
         sqlite3_bind_text(stmt, 3, commentText.c_str(), static_cast<int>(commentText.length()), SQLITE_TRANSIENT);
         time_t now = time(nullptr);
         sqlite3_bind_int(stmt, 4, now);
-        sqlite3_bind_int(stmt, 5, 1); // Автоматично схвалюємо коментарі
+        sqlite3_bind_int(stmt, 5, 0); // Публікується після модерації
     
         int rc = sqlite3_step(stmt);
+        sqlite3_int64 commentId = sqlite3_last_insert_rowid(db->getHandle());
         sqlite3_finalize(stmt);
         
         if (rc == SQLITE_DONE) {
-            // Створюємо сповіщення для продавця
-            std::ostringstream notifSql;
-            notifSql << "INSERT INTO notifications (user_id, type, message, is_read, created_at) VALUES ("
-                     << listing->getSellerId() << ", 'comment', 'Новий коментар на ваше оголошення', 0, " << now << ")";
-            db->execute(notifSql.str());
+            // Продавець отримає сповіщення, коли коментар пройде модерацію
+            moderationQueue_->enqueue(ModerationTarget::Comment, static_cast<int>(commentId));
             
-            return "{\"success\":true,\"message\":\"Comment added\"}";
+            return "{\"success\":true,\"message\":\"Comment added\",\"status\":\"pending\"}";
         }
     }
     
@@ -1173,17 +1667,25 @@ std::string ApiServer::handleMarkNotificationRead(int notificationId, const std:
     }
     
     auto db = listingRepository_->getDb();
-    const char* sql = "UPDATE notifications SET is_read = 1 WHERE id = ? AND user_id = ?";
+    // is_read = 0 в умові: лічильник зменшується лише тоді, коли рядок справді змінився.
+    // Змінені рядки рахуються з RETURNING - sqlite3_changes на спільному з'єднанні
+    // може належати запиту іншого потоку
+    const char* sql = "UPDATE notifications SET is_read = 1 WHERE id = ? AND user_id = ? AND is_read = 0 RETURNING id";
     sqlite3_stmt* stmt;
     
     if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_int(stmt, 1, notificationId);
         sqlite3_bind_int(stmt, 2, user->getId());
         
-        int rc = sqlite3_step(stmt);
+        int changed = 0;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            ++changed;
+        }
         sqlite3_finalize(stmt);
         
         if (rc == SQLITE_DONE) {
+            unreadCounters_->addNotifications(user->getId(), -changed);
             return "{\"success\":true,\"message\":\"Notification marked as read\"}";
         }
     }
@@ -1191,6 +1693,56 @@ std::string ApiServer::handleMarkNotificationRead(int notificationId, const std:
     return "{\"error\":\"Failed to update notification\"}";
 }
 
+std::string ApiServer::handleMarkAllNotificationsRead(const std::string& authToken) {
+    if (authToken.empty()) {
+        return "{\"error\":\"Unauthorized\"}";
+    }
+    
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
+    }
+    
+    auto db = listingRepository_->getDb();
+    const char* sql = "UPDATE notifications SET is_read = 1 WHERE user_id = ? AND is_read = 0 RETURNING id";
+    sqlite3_stmt* stmt;
+    
+    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, user->getId());
+        
+        int changed = 0;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            ++changed;
+        }
+        sqlite3_finalize(stmt);
+        
+        if (rc == SQLITE_DONE) {
+            unreadCounters_->clearNotifications(user->getId());
+            return "{\"success\":true,\"marked\":" + std::to_string(changed) + "}";
+        }
+    }
+    
+    return "{\"error\":\"Failed to update notifications\"}";
+}
+
+std::string ApiServer::handleGetUnreadCounts(const std::string& authToken) {
+    if (authToken.empty()) {
+        return "{\"error\":\"Unauthorized\"}";
+    }
+    
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
+    }
+    
+    UnreadCounts counts = unreadCounters_->get(user->getId());
+    std::ostringstream oss;
+    oss << "{\"notifications\":" << counts.notifications
+        << ",\"messages\":" << counts.messages << "}";
+    return oss.str();
+}
+
 std::string ApiServer::handleCreatePurchaseRequest(int listingId, const std::string& body, const std::string& authToken) {
     if (authToken.empty()) {
         return "{\"error\":\"Unauthorized\"}";
@@ -1236,9 +1788,13 @@ std::string ApiServer::handleCreatePurchaseRequest(int listingId, const std::str
         sqlite3_bind_int(stmt, 6, now);
         
         int rc = sqlite3_step(stmt);
+        sqlite3_int64 requestId = sqlite3_last_insert_rowid(db->getHandle());
         sqlite3_finalize(stmt);
         
         if (rc == SQLITE_DONE) {
+            std::ostringstream event;
+            event << "{\"id\":" << requestId << ",\"listingId\":" << listingId << ",\"buyerId\":" << user->getId() << "}";
+            eventHub_->publish(listing->getSellerId(), "purchase_request", event.str());
             return "{\"success\":true,\"message\":\"Purchase request created\"}";
         }
     }
@@ -1265,37 +1821,13 @@ std::string ApiServer::handleMarkAsSold(int listingId, const std::string& authTo
         return "{\"error\":\"Only seller can mark as sold\"}";
     }
     
+    // Записується лише статус
     listing->setStatus("sold");
     
-    auto listingCopy = std::make_unique<Listing>(listing->getId(), listing->getSellerId(), 
-                                                  listing->getBrandId(), listing->getModelId(),
-                                                  listing->getYear(), listing->getPrice(),
-                                                  listing->getCurrency(), listing->getExchangeRate(),
-                                                  listing->getDescription(), listing->getRegion(),
-                                                  listing->getMileage());
-    listingCopy->setStatus("sold");
-    listingCopy->setPhotos(listing->getPhotos());
-    listingCopy->setFuelType(listing->getFuelType());
-    listingCopy->setTransmission(listing->getTransmission());
-    listingCopy->setColor(listing->getColor());
-    listingCopy->setEngineVolume(listing->getEngineVolume());
-    listingCopy->setBodyType(listing->getBodyType());
-    listingCopy->setDoorsCount(listing->getDoorsCount());
-    listingCopy->setEnginePower(listing->getEnginePower());
-    for (int i = 0; i < listing->getEditCount(); i++) {
-        listingCopy->incrementEditCount();
-    }
-    for (int i = 0; i < listing->getViewCount(); i++) {
-        listingCopy->incrementViewCount();
-    }
-    
-    if (listingRepository_->update(std::move(listingCopy))) {
+    if (listingRepository_->updateFields(*listing)) {
         // Створюємо запис в історії цін
-        auto db = listingRepository_->getDb();
-        std::ostringstream priceHistorySql;
-        priceHistorySql << "INSERT INTO price_history (listing_id, price, currency, changed_at) VALUES ("
-                        << listingId << ", " << listing->getPrice() << ", '" << listing->getCurrency() << "', " << time(nullptr) << ")";
-        db->execute(priceHistorySql.str());
+        insertPriceHistory(listingRepository_->getDb()->getHandle(), listingId, listing->getPrice(),
+                           listing->getCurrencyCode());
         
         return "{\"success\":true,\"message\":\"Listing marked as sold\"}";
     }
@@ -1309,68 +1841,36 @@ std::string ApiServer::handleGetMyListings(const std::string& authToken) {
         return "{\"error\":\"Invalid token\"}";
     }
     
-    auto listings = listingRepository_->findBySellerId(user->getId());
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < listings.size(); ++i) {
-        if (i > 0) oss << ",";
-        try {
-            auto seller = userRepository_->findById(listings[i]->getSellerId());
-            std::string json = listings[i]->toJson();
-            if (seller) {
-                // Додаємо інформацію про продавця
-                if (!json.empty() && json.back() == '}') {
-                    json.pop_back(); // видаляємо закриваючу дужку
-                    json += ",\"seller\":{\"id\":" + std::to_string(seller->getId()) +
-                            ",\"email\":\"" + escapeJson(seller->getEmail()) + "\"" +
-                            ",\"firstName\":\"" + escapeJson(seller->getFirstName()) + "\"" +
-                            ",\"lastName\":\"" + escapeJson(seller->getLastName()) + "\"}}";
-                } else {
-                    // Якщо JSON невалідний, пропускаємо цей запис
-                    continue;
-                }
-            }
-            oss << json;
-        } catch (const std::exception& e) {
-            // Пропускаємо помилкові записи
-            continue;
-        }
-    }
-    oss << "]";
-    return oss.str();
+    auto summaries = listingRepository_->findSummariesBySellerId(user->getId());
+    return serializeSummaries(summaries, true);
 }
 
-std::string ApiServer::handleGetListing(int id, const std::string& authToken) {
-    auto listing = listingRepository_->findById(id);
-    if (!listing) {
-        return "{\"error\":\"Listing not found\"}";
+std::string ApiServer::handleGetListing(int id) {
+    std::string json;
+    int sellerId = 0;
+    if (!listingJson_->lookup(id, json, sellerId)) {
+        // Версії - до читання: зміна оголошення чи курсів під час рендерингу не потрапить у кеш
+        uint64_t version = listingJson_->version();
+        uint64_t rateVersion = currencyService_->getSnapshot()->version;
+        auto listing = listingRepository_->findById(id);
+        if (!listing) {
+            return "{\"error\":\"Listing not found\"}";
+        }
+        
+        json = listing->toJson();
+        sellerId = listing->getSellerId();
+        listingJson_->store(id, json, sellerId, listing->getViewCount(), rateVersion, version);
     }
     
-    // Реєструємо перегляд
-    listingRepository_->incrementViewCount(id);
-    statisticsService_->recordView(id, 0);
+    // Продавець - поза кешем: зміна профілю користувача записи кешу не скидає
+    std::map<int, std::unique_ptr<User>> sellers;
+    appendSeller(json, sellerId, sellers);
     
-    auto seller = userRepository_->findById(listing->getSellerId());
-    std::string json = listing->toJson();
-    if (seller) {
-        // Додаємо інформацію про продавця
-        json.pop_back(); // видаляємо закриваючу дужку
-        json += ",\"seller\":{\"id\":" + std::to_string(seller->getId()) +
-                ",\"email\":\"" + seller->getEmail() + "\"" +
-                ",\"firstName\":\"" + escapeJson(seller->getFirstName()) + "\"" +
-                ",\"lastName\":\"" + escapeJson(seller->getLastName()) + "\"}}";
-    }
+    // Реєструємо перегляд (view_count у БД збільшує recordView); кешований запис
+    // лічить перегляди сам і лишається чинним
+    statisticsService_->recordView(id, 0);
+    listingJson_->recordView(id);
     return json;
-    
-    // Якщо користувач авторизований і має преміум - показуємо статистику
-    if (!authToken.empty()) {
-        auto user = authMiddleware_->authenticate(authToken);
-        if (user && user->isPremium() && user->getId() == listing->getSellerId()) {
-            return listing->toJsonWithStats();
-        }
-    }
-    
-    return listing->toJson();
 }
 
 std::string ApiServer::handleCreateListing(const std::string& body, const std::string& authToken) {
@@ -1441,24 +1941,19 @@ std::string ApiServer::handleCreateListing(const std::string& body, const std::s
     if (std::regex_search(body, match, doorsCountRegex)) doorsCount = std::stoi(match[1]);
     if (std::regex_search(body, match, enginePowerRegex)) enginePower = std::stoi(match[1]);
     
-    // Отримуємо курс валют
-    currencyService_->updateRates();
-    auto rates = currencyService_->getCurrentRates();
-    double exchangeRate;
-    if (currency == "USD") {
-        exchangeRate = rates.usdToUah; // USD/UAH
-    } else if (currency == "EUR") {
-        exchangeRate = rates.eurToUah; // EUR/UAH
-    } else {
-        exchangeRate = 1.0; // UAH
+    // Без поля currency - гривня; заданий невідомий код - помилка
+    Currency currencyCode;
+    if (!tryParseCurrency(currency, currencyCode)) {
+        return "{\"error\":\"Unknown currency: " + escapeJson(currency) + "\"}";
     }
+    currency = currencyName(currencyCode);
     
-    // Модерація
-    std::string status = moderationService_->moderateListing(description);
-    // Перевірка, чи статус не порожній
-    if (status.empty()) {
-        status = "active"; // За замовчуванням активне, якщо модерація не повернула статус
-    }
+    // Отримуємо курс валют (знімок оновлюється фоновим таймером)
+    auto rates = currencyService_->getSnapshot();
+    double exchangeRate = rates->toUah[static_cast<size_t>(currencyCode)]; // XXX/UAH, для UAH = 1
+    
+    // Модерація виконується асинхронно: до вердикту оголошення в очікуванні
+    std::string status = "pending";
     
     auto listing = std::make_unique<Listing>(0, user->getId(), brandId, modelId, year,
                                              price, currency, exchangeRate,
@@ -1477,8 +1972,22 @@ std::string ApiServer::handleCreateListing(const std::string& body, const std::s
         // Отримуємо ID створеного оголошення
         auto db = listingRepository_->getDb();
         sqlite3_int64 lastId = sqlite3_last_insert_rowid(db->getHandle());
+        moderationQueue_->enqueue(ModerationTarget::Listing, static_cast<int>(lastId));
+        
+        // Майже однакові описи (цього чи інших продавців) - позначка для модераторів
+        auto duplicates = duplicateIndex_->findDuplicates(static_cast<int>(lastId));
+        duplicateIndex_->flagDuplicates(static_cast<int>(lastId), duplicates);
+        
         std::ostringstream oss;
-        oss << "{\"success\":true,\"message\":\"Listing created\",\"id\":" << lastId << "}";
+        oss << "{\"success\":true,\"message\":\"Listing created\",\"id\":" << lastId
+            << ",\"status\":\"" << status << "\",\"possibleDuplicates\":[";
+        for (size_t i = 0; i < duplicates.size(); ++i) {
+            if (i > 0) oss << ",";
+            oss << "{\"id\":" << duplicates[i].listingId
+                << ",\"distance\":" << duplicates[i].distance
+                << ",\"sameSeller\":" << (duplicates[i].sellerId == user->getId() ? "true" : "false") << "}";
+        }
+        oss << "]}";
         return oss.str();
     }
     return "{\"error\":\"Failed to create listing\"}";
@@ -1535,7 +2044,7 @@ std::string ApiServer::handleUpdateListing(int id, const std::string& body, cons
     
     std::smatch match;
     double oldPrice = listing->getPrice();
-    std::string oldCurrency = listing->getCurrency();
+    Currency oldCurrency = listing->getCurrencyCode();
     
     // Збираємо нові значення
     int brandId = listing->getBrandId();
@@ -1575,58 +2084,67 @@ std::string ApiServer::handleUpdateListing(int id, const std::string& body, cons
     if (std::regex_search(body, match, doorsCountRegex)) doorsCount = std::stoi(match[1]);
     if (std::regex_search(body, match, enginePowerRegex)) enginePower = std::stoi(match[1]);
     
+    // Без поля currency лишається поточна валюта; заданий невідомий код - помилка
+    Currency currencyCode;
+    if (!tryParseCurrency(currency, currencyCode)) {
+        return "{\"error\":\"Unknown currency: " + escapeJson(currency) + "\"}";
+    }
+    currency = currencyName(currencyCode);
+    
     // Оновлюємо курс валют якщо валюта змінилась
     double exchangeRate = listing->getExchangeRate();
-    if (currency != oldCurrency) {
-        currencyService_->updateRates();
-        auto rates = currencyService_->getCurrentRates();
-        if (currency == "USD") {
-            exchangeRate = rates.usdToUah; // USD/UAH
-        } else if (currency == "EUR") {
-            exchangeRate = rates.eurToUah; // EUR/UAH
-        } else {
-            exchangeRate = 1.0; // UAH
-        }
+    if (currencyCode != oldCurrency) {
+        auto rates = currencyService_->getSnapshot();
+        exchangeRate = rates->toUah[static_cast<size_t>(currencyCode)]; // XXX/UAH, для UAH = 1
     }
     
-    // Модерація нового опису
-    std::string status = moderationService_->moderateListing(description);
+    // Новий опис повертається на модерацію (асинхронно, див. ModerationQueue)
+    std::string status = "pending";
     
-    // Створюємо оновлений об'єкт
-    auto listingCopy = std::make_unique<Listing>(listing->getId(), listing->getSellerId(),
-                                                  brandId, modelId, year, price,
-                                                  currency, exchangeRate,
-                                                  description, region, mileage);
-    listingCopy->setStatus(status);
-    listingCopy->setPhotos(photos);
-    listingCopy->setFuelType(fuelType);
-    listingCopy->setTransmission(transmission);
-    listingCopy->setColor(color);
-    listingCopy->setEngineVolume(engineVolume);
-    listingCopy->setBodyType(bodyType);
-    listingCopy->setDoorsCount(doorsCount);
-    listingCopy->setEnginePower(enginePower);
+    // Змінюємо завантажене оголошення: сеттери позначають лише колонки з іншим значенням
+    listing->setBrandId(brandId);
+    listing->setModelId(modelId);
+    listing->setYear(year);
+    listing->setPrice(price);
+    listing->setCurrency(currency);
+    listing->setExchangeRate(exchangeRate);
+    listing->setDescription(description);
+    listing->setRegion(region);
+    listing->setMileage(mileage);
+    listing->setPhotos(photos);
+    listing->setFuelType(fuelType);
+    listing->setTransmission(transmission);
+    listing->setColor(color);
+    listing->setEngineVolume(engineVolume);
+    listing->setBodyType(bodyType);
+    listing->setDoorsCount(doorsCount);
+    listing->setEnginePower(enginePower);
     
-    // Зберігаємо editCount та viewCount
-    for (int i = 0; i < listing->getEditCount(); i++) {
-        listingCopy->incrementEditCount();
-    }
-    listingCopy->incrementEditCount(); // Додаємо одне редагування
-    for (int i = 0; i < listing->getViewCount(); i++) {
-        listingCopy->incrementViewCount();
+    uint32_t changed = listing->getDirtyFields();
+    if (changed == 0) {
+        // Нічого не змінилось - редагування не враховується, модерація не потрібна
+        return "{\"success\":true,\"status\":\"" + escapeJson(listing->getStatus()) + "\",\"updated\":[]}";
     }
+    listing->setStatus(status);
+    listing->setEditCount(listing->getEditCount() + 1);
     
-    if (listingRepository_->update(std::move(listingCopy))) {
+    // UPDATE лише змінених колонок
+    if (listingRepository_->updateFields(*listing)) {
         // Якщо ціна змінилась, додаємо в історію
-        if (oldPrice != price || oldCurrency != currency) {
-            auto db = listingRepository_->getDb();
-            std::ostringstream priceHistorySql;
-            priceHistorySql << "INSERT INTO price_history (listing_id, price, currency, changed_at) VALUES ("
-                            << id << ", " << price << ", '" << currency << "', " << time(nullptr) << ")";
-            db->execute(priceHistorySql.str());
+        if (oldPrice != listing->getPrice() || oldCurrency != listing->getCurrencyCode()) {
+            insertPriceHistory(listingRepository_->getDb()->getHandle(), id, listing->getPrice(),
+                               listing->getCurrencyCode());
         }
+        moderationQueue_->enqueue(ModerationTarget::Listing, id);
         
-        return "{\"success\":true}";
+        std::ostringstream oss;
+        oss << "{\"success\":true,\"status\":\"pending\",\"updated\":[";
+        auto names = ListingRepository::fieldNames(changed);
+        for (size_t i = 0; i < names.size(); ++i) {
+            oss << (i > 0 ? ",\"" : "\"") << names[i] << "\"";
+        }
+        oss << "]}";
+        return oss.str();
     }
     return "{\"error\":\"Failed to update\"}";
 }
@@ -1675,6 +2193,19 @@ std::string ApiServer::handleGetBrands() {
     return oss.str();
 }
 
+std::string ApiServer::handleGetRegions() {
+    std::ostringstream oss;
+    oss << "[";
+    bool first = true;
+    for (const auto& region : regionDirectory_->all()) {
+        if (!first) oss << ",";
+        first = false;
+        oss << "{\"id\":" << region.first << ",\"name\":\"" << escapeJson(region.second) << "\"}";
+    }
+    oss << "]";
+    return oss.str();
+}
+
 std::string ApiServer::handleGetModels(int brandId) {
     auto models = modelRepository_->getByBrandId(brandId);
     std::ostringstream oss;
@@ -1950,7 +2481,7 @@ std::string ApiServer::handleSendMessage(const std::string& body, const std::str
     }
     
     auto db = listingRepository_->getDb();
-    const char* sql = "INSERT INTO messages (sender_id, receiver_id, listing_id, message_text, is_read, created_at) VALUES (?, ?, ?, ?, ?, ?)";
+    const char* sql = "INSERT INTO messages (sender_id, receiver_id, listing_id, message_text, is_read, created_at, status) VALUES (?, ?, ?, ?, ?, ?, 'pending')";
     sqlite3_stmt* stmt;
     
     if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
@@ -1967,23 +2498,30 @@ std::string ApiServer::handleSendMessage(const std::string& body, const std::str
         sqlite3_bind_int(stmt, 6, now);
         
         int rc = sqlite3_step(stmt);
+        sqlite3_int64 messageId = sqlite3_last_insert_rowid(db->getHandle());
         sqlite3_finalize(stmt);
         
         if (rc == SQLITE_DONE) {
-            // Створюємо сповіщення для отримувача
-            std::ostringstream notifSql;
-            notifSql << "INSERT INTO notifications (user_id, type, message, is_read, created_at) VALUES ("
-                     << receiverId << ", 'message', 'Нове повідомлення від " << escapeJson(user->getFirstName()) << "', 0, " << now << ")";
-            db->execute(notifSql.str());
+            // Отримувач побачить повідомлення та сповіщення після модерації
+            moderationQueue_->enqueue(ModerationTarget::Message, static_cast<int>(messageId));
             
-            return "{\"success\":true,\"message\":\"Message sent\"}";
+            if (listingId > 0) {
+                auto listing = listingRepository_->findById(listingId);
+                if (listing) {
+                    userPreferences_->recordSignal(user->getId(), *listing, PreferenceSignal::Message);
+                }
+            }
+            
+            return "{\"success\":true,\"message\":\"Message sent\",\"status\":\"pending\"}";
         }
     }
     
     return "{\"error\":\"Failed to send message\"}";
 }
 
-std::string ApiServer::handleGetMessages(const std::string& authToken, int otherUserId) {
+std::string ApiServer::handleGetMessages(const std::string& authToken, int otherUserId,
+                                         const std::string& before, const std::string& after, int limit,
+                                         std::string* olderCursor, std::string* newerCursor) {
     if (authToken.empty()) {
         return "{\"error\":\"Unauthorized\"}";
     }
@@ -1993,84 +2531,88 @@ std::string ApiServer::handleGetMessages(const std::string& authToken, int other
         return "{\"error\":\"Invalid token\"}";
     }
     
-    auto db = listingRepository_->getDb();
-    std::ostringstream sql;
-    sqlite3_stmt* stmt;
+    if (otherUserId <= 0) {
+        // Список розмов: один запит до conversations з іменами, останнім повідомленням та непрочитаними
+        std::ostringstream oss;
+        oss << "[";
+        bool first = true;
+        for (const auto& conversation : messageRepository_->findConversations(user->getId())) {
+            if (!first) oss << ",";
+            first = false;
+            oss << "{\"userId\":" << conversation.otherUserId
+                << ",\"firstName\":\"" << escapeJson(conversation.firstName) << "\""
+                << ",\"lastName\":\"" << escapeJson(conversation.lastName) << "\""
+                << ",\"unreadCount\":" << conversation.unreadCount
+                << ",\"lastMessage\":{\"id\":" << conversation.lastMessageId
+                << ",\"senderId\":" << conversation.lastSenderId
+                << ",\"preview\":\"" << escapeJson(conversation.lastMessagePreview) << "\""
+                << ",\"createdAt\":" << conversation.lastAt << "}}";
+        }
+        oss << "]";
+        return oss.str();
+    }
     
-    if (otherUserId > 0) {
-        // Отримати повідомлення з конкретним користувачем
-        sql << "SELECT * FROM messages WHERE (sender_id = ? AND receiver_id = ?) OR (sender_id = ? AND receiver_id = ?) ORDER BY created_at ASC";
-        const std::string sqlStr = sql.str();
-        if (sqlite3_prepare_v2(db->getHandle(), sqlStr.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, user->getId());
-            sqlite3_bind_int(stmt, 2, otherUserId);
-            sqlite3_bind_int(stmt, 3, otherUserId);
-            sqlite3_bind_int(stmt, 4, user->getId());
-        }
-    } else {
-        // Отримати всі повідомлення користувача (список розмов)
-        sql << "SELECT DISTINCT CASE WHEN sender_id = ? THEN receiver_id ELSE sender_id END as other_user_id FROM messages WHERE sender_id = ? OR receiver_id = ?";
-        const std::string sqlStr = sql.str();
-        if (sqlite3_prepare_v2(db->getHandle(), sqlStr.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, user->getId());
-            sqlite3_bind_int(stmt, 2, user->getId());
-            sqlite3_bind_int(stmt, 3, user->getId());
-        }
+    // Повідомлення з конкретним користувачем - сторінка за курсором (createdAt:id)
+    MessageCursor beforeCursor;
+    MessageCursor afterCursor;
+    if (!before.empty() && !after.empty()) {
+        return "{\"error\":\"Use either before or after cursor\"}";
+    }
+    if ((!before.empty() && !MessageCursor::parse(before, beforeCursor)) ||
+        (!after.empty() && !MessageCursor::parse(after, afterCursor))) {
+        return "{\"error\":\"Invalid cursor\"}";
+    }
+    
+    MessagePage page = messageRepository_->findThread(
+        user->getId(), otherUserId,
+        before.empty() ? nullptr : &beforeCursor,
+        after.empty() ? nullptr : &afterCursor,
+        limit > 0 ? limit : MessageRepository::kDefaultPageSize);
+    
+    if (!page.messages.empty()) {
+        const Message& oldest = page.messages.front();
+        const Message& newest = page.messages.back();
+        if (olderCursor && page.hasOlder) *olderCursor = MessageCursor{oldest.createdAt, oldest.id}.toString();
+        if (newerCursor) *newerCursor = MessageCursor{newest.createdAt, newest.id}.toString();
+    } else if (newerCursor && !after.empty()) {
+        // Нових немає - клієнт продовжує опитування з тим самим курсором
+        *newerCursor = after;
     }
     
+    // Учасників переписки двоє - дані відправників завантажуються один раз на сторінку
+    std::map<int, std::unique_ptr<User>> senders;
+    
     std::ostringstream oss;
     oss << "[";
-    bool first = true;
-    
-    if (stmt) {
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            if (!first) oss << ",";
-            first = false;
-            
-            if (otherUserId > 0) {
-                // Повертаємо повідомлення
-                int msgId = sqlite3_column_int(stmt, 0);
-                int senderId = sqlite3_column_int(stmt, 1);
-                int receiverId = sqlite3_column_int(stmt, 2);
-                int listingId = sqlite3_column_int(stmt, 3);
-                const char* messageText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-                int isRead = sqlite3_column_int(stmt, 5);
-                int createdAt = sqlite3_column_int(stmt, 6);
-                
-                auto sender = userRepository_->findById(senderId);
-                
-                oss << "{\"id\":" << msgId
-                    << ",\"senderId\":" << senderId
-                    << ",\"receiverId\":" << receiverId
-                    << ",\"messageText\":\"" << escapeJson(messageText ? messageText : "") << "\""
-                    << ",\"isRead\":" << isRead
-                    << ",\"createdAt\":" << createdAt;
-                
-                if (listingId > 0) {
-                    oss << ",\"listingId\":" << listingId;
-                }
-                
-                if (sender) {
-                    oss << ",\"sender\":{\"id\":" << sender->getId()
-                        << ",\"firstName\":\"" << escapeJson(sender->getFirstName()) << "\""
-                        << ",\"lastName\":\"" << escapeJson(sender->getLastName()) << "\"}}";
-                } else {
-                    oss << "}";
-                }
-            } else {
-                // Повертаємо список розмов
-                int otherUserId = sqlite3_column_int(stmt, 0);
-                auto otherUser = userRepository_->findById(otherUserId);
-                if (otherUser) {
-                    oss << "{\"userId\":" << otherUserId
-                        << ",\"firstName\":\"" << escapeJson(otherUser->getFirstName()) << "\""
-                        << ",\"lastName\":\"" << escapeJson(otherUser->getLastName()) << "\"}";
-                }
-            }
+    for (size_t i = 0; i < page.messages.size(); ++i) {
+        const Message& message = page.messages[i];
+        if (i > 0) oss << ",";
+        
+        auto it = senders.find(message.senderId);
+        if (it == senders.end()) {
+            it = senders.emplace(message.senderId, userRepository_->findById(message.senderId)).first;
+        }
+        const User* sender = it->second.get();
+        
+        oss << "{\"id\":" << message.id
+            << ",\"senderId\":" << message.senderId
+            << ",\"receiverId\":" << message.receiverId
+            << ",\"messageText\":\"" << escapeJson(message.text) << "\""
+            << ",\"isRead\":" << (message.isRead ? 1 : 0)
+            << ",\"createdAt\":" << message.createdAt;
+        
+        if (message.listingId > 0) {
+            oss << ",\"listingId\":" << message.listingId;
+        }
+        
+        if (sender) {
+            oss << ",\"sender\":{\"id\":" << sender->getId()
+                << ",\"firstName\":\"" << escapeJson(sender->getFirstName()) << "\""
+                << ",\"lastName\":\"" << escapeJson(sender->getLastName()) << "\"}}";
+        } else {
+            oss << "}";
         }
-        sqlite3_finalize(stmt);
     }
-    
     oss << "]";
     return oss.str();
 }
@@ -2085,25 +2627,42 @@ std::string ApiServer::handleMarkMessageRead(int messageId, const std::string& a
         return "{\"error\":\"Invalid token\"}";
     }
     
-    auto db = listingRepository_->getDb();
-    const char* sql = "UPDATE messages SET is_read = 1 WHERE id = ? AND receiver_id = ?";
-    sqlite3_stmt* stmt;
-    
-    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, messageId);
-        sqlite3_bind_int(stmt, 2, user->getId());
-        
-        int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        
-        if (rc == SQLITE_DONE) {
-            return "{\"success\":true}";
+    // Разом з повідомленням зменшується лічильник непрочитаних розмови
+    bool counted = false;
+    if (messageRepository_->markRead(messageId, user->getId(), counted)) {
+        if (counted) {
+            unreadCounters_->addMessages(user->getId(), -1);
         }
+        return "{\"success\":true}";
     }
     
     return "{\"error\":\"Failed to mark as read\"}";
 }
 
+std::string ApiServer::handleMarkAllMessagesRead(int otherUserId, const std::string& authToken) {
+    if (authToken.empty()) {
+        return "{\"error\":\"Unauthorized\"}";
+    }
+    
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
+    }
+    
+    int marked = 0;
+    if (!messageRepository_->markAllRead(user->getId(), otherUserId, marked)) {
+        return "{\"error\":\"Failed to mark as read\"}";
+    }
+    
+    // marked - рядки, змінені саме цим запитом (RETURNING у репозиторії)
+    if (otherUserId == 0) {
+        unreadCounters_->clearMessages(user->getId());
+    } else if (otherUserId != user->getId()) {
+        unreadCounters_->addMessages(user->getId(), -marked);
+    }
+    return "{\"success\":true,\"marked\":" + std::to_string(marked) + "}";
+}
+
 // Адмін панель
 std::string ApiServer::handleGetPendingListings(const std::string& authToken) {
     if (authToken.empty()) {
@@ -2120,12 +2679,51 @@ std::string ApiServer::handleGetPendingListings(const std::string& authToken) {
     }
     
     auto listings = listingRepository_->findByStatus("pending");
+    return serializeListings(listings, false);
+}
+
+std::string ApiServer::handleGetDuplicateListings(const std::string& authToken) {
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
+    }
+    
+    if (!authMiddleware_->hasPermission(user.get(), "listings", "moderate")) {
+        return "{\"error\":\"Unauthorized\"}";
+    }
+    
+    // Видалені оголошення відсікаються JOIN-ом
+    auto db = listingRepository_->getDb();
+    const char* sql = "SELECT f.listing_id, f.duplicate_of_id, f.distance, f.same_seller, f.created_at, "
+                      "l.seller_id, l.status, o.seller_id, o.status "
+                      "FROM duplicate_flags f "
+                      "JOIN listings l ON l.id = f.listing_id "
+                      "JOIN listings o ON o.id = f.duplicate_of_id "
+                      "ORDER BY f.created_at DESC, f.id DESC LIMIT 200";
+    sqlite3_stmt* stmt;
     std::ostringstream oss;
     oss << "[";
-    for (size_t i = 0; i < listings.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << listings[i]->toJson();
+    
+    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        bool first = true;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
+            const char* originalStatus = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 8));
+            if (!first) oss << ",";
+            first = false;
+            oss << "{\"listingId\":" << sqlite3_column_int(stmt, 0)
+                << ",\"duplicateOfId\":" << sqlite3_column_int(stmt, 1)
+                << ",\"distance\":" << sqlite3_column_int(stmt, 2)
+                << ",\"sameSeller\":" << (sqlite3_column_int(stmt, 3) ? "true" : "false")
+                << ",\"createdAt\":" << sqlite3_column_int64(stmt, 4)
+                << ",\"sellerId\":" << sqlite3_column_int(stmt, 5)
+                << ",\"status\":\"" << escapeJson(status ? status : "") << "\""
+                << ",\"duplicateOfSellerId\":" << sqlite3_column_int(stmt, 7)
+                << ",\"duplicateOfStatus\":\"" << escapeJson(originalStatus ? originalStatus : "") << "\"}";
+        }
+        sqlite3_finalize(stmt);
     }
+    
     oss << "]";
     return oss.str();
 }
@@ -2164,28 +2762,21 @@ std::string ApiServer::handleModerateListing(int listingId, const std::string& b
     listing->setStatus(status);
     time_t now = time(nullptr);
     
-    auto db = listingRepository_->getDb();
-    const char* sql = "UPDATE listings SET status = ?, last_moderation_date = ? WHERE id = ?";
-    sqlite3_stmt* stmt;
-    
-    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, status.c_str(), static_cast<int>(status.length()), SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 2, now);
-        sqlite3_bind_int(stmt, 3, listingId);
-        
-        int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        
-        if (rc == SQLITE_DONE) {
-            // Створюємо сповіщення для продавця
-            std::ostringstream notifSql;
-            std::string message = status == "active" ? "Ваше оголошення схвалено" : "Ваше оголошення відхилено";
-            notifSql << "INSERT INTO notifications (user_id, type, message, is_read, created_at) VALUES ("
-                     << listing->getSellerId() << ", 'moderation', '" << message << "', 0, " << now << ")";
-            db->execute(notifSql.str());
-            
-            return "{\"success\":true}";
+    // Через репозиторій, щоб лічильники та інші спостерігачі побачили зміну статусу
+    if (listingRepository_->updateStatus(listingId, status, now)) {
+        // Створюємо сповіщення для продавця
+        auto db = listingRepository_->getDb();
+        std::ostringstream notifSql;
+        std::string message = status == "active" ? "Ваше оголошення схвалено" : "Ваше оголошення відхилено";
+        notifSql << "INSERT INTO notifications (user_id, type, message, is_read, created_at) VALUES ("
+                 << listing->getSellerId() << ", 'moderation', '" << message << "', 0, " << now << ")";
+        if (db->execute(notifSql.str())) {
+            unreadCounters_->addNotifications(listing->getSellerId(), 1);
+            eventHub_->publish(listing->getSellerId(), "notification",
+                               "{\"type\":\"moderation\",\"message\":\"" + message + "\"}");
         }
+        
+        return "{\"success\":true}";
     }
     
     return "{\"error\":\"Failed to moderate\"}";
@@ -2275,46 +2866,150 @@ std::string ApiServer::handleGetPlatformStats(const std::string& authToken) {
         return "{\"error\":\"Unauthorized\"}";
     }
     
-    auto db = listingRepository_->getDb();
+    // Лічильники підтримуються в пам'яті - без COUNT(*) по таблицях
+    auto stats = platformCounters_->getStatistics();
     std::ostringstream oss;
+    oss << "{\"userCount\":" << stats.userCount
+        << ",\"listingCount\":" << stats.listingCount
+        << ",\"activeListingCount\":" << stats.activeListingCount
+        << ",\"listingsByStatus\":{";
+    for (size_t i = 0; i < stats.listingsByStatus.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "\"" << stats.listingsByStatus[i].first << "\":" << stats.listingsByStatus[i].second;
+    }
+    oss << "},\"usersByRole\":{";
+    for (size_t i = 0; i < stats.usersByRole.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "\"" << stats.usersByRole[i].first << "\":" << stats.usersByRole[i].second;
+    }
+    oss << "},\"usersByAccountType\":{";
+    for (size_t i = 0; i < stats.usersByAccountType.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "\"" << stats.usersByAccountType[i].first << "\":" << stats.usersByAccountType[i].second;
+    }
+    oss << "},\"reconciledAt\":" << stats.reconciledAt << "}";
     
-    // Отримуємо статистику
-    const char* sql = "SELECT COUNT(*) FROM users";
-    sqlite3_stmt* stmt;
-    int userCount = 0;
-    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            userCount = sqlite3_column_int(stmt, 0);
-        }
-        sqlite3_finalize(stmt);
+    return oss.str();
+}
+
+std::string ApiServer::handleGetEventStats(const std::string& authToken) {
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
     }
     
-    sql = "SELECT COUNT(*) FROM listings";
-    int listingCount = 0;
-    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            listingCount = sqlite3_column_int(stmt, 0);
-        }
-        sqlite3_finalize(stmt);
+    if (!authMiddleware_->hasPermission(user.get(), "system", "statistics")) {
+        return "{\"error\":\"Unauthorized\"}";
     }
     
-    sql = "SELECT COUNT(*) FROM listings WHERE status = 'active'";
-    int activeListingCount = 0;
-    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            activeListingCount = sqlite3_column_int(stmt, 0);
-        }
-        sqlite3_finalize(stmt);
+    auto stats = eventHub_->getStats();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3)
+        << "{\"connections\":" << stats.connections
+        << ",\"maxConnections\":" << stats.maxConnections
+        << ",\"channels\":" << stats.channels
+        << ",\"published\":" << stats.published
+        << ",\"delivered\":" << stats.delivered
+        << ",\"rejectedConnections\":" << stats.rejectedConnections
+        << ",\"avgDeliveryMs\":" << stats.avgDeliveryMs
+        << ",\"maxDeliveryMs\":" << stats.maxDeliveryMs << "}";
+    return oss.str();
+}
+
+std::string ApiServer::handleGetCacheStats(const std::string& authToken) {
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
     }
     
-    oss << "{\"userCount\":" << userCount
-        << ",\"listingCount\":" << listingCount
-        << ",\"activeListingCount\":" << activeListingCount << "}";
+    if (!authMiddleware_->hasPermission(user.get(), "system", "statistics")) {
+        return "{\"error\":\"Unauthorized\"}";
+    }
     
+    auto hitRate = [](uint64_t hits, uint64_t misses) {
+        return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+    };
+    auto listingJson = listingJson_->getStats();
+    uint64_t searchHits = searchResults_->getHitCount();
+    uint64_t searchMisses = searchResults_->getMissCount();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3)
+        << "{\"listingJson\":{\"entries\":" << listingJson.entries
+        << ",\"bytes\":" << listingJson.bytes
+        << ",\"capacityBytes\":" << listingJson.capacityBytes
+        << ",\"hits\":" << listingJson.hits
+        << ",\"misses\":" << listingJson.misses
+        << ",\"hitRate\":" << hitRate(listingJson.hits, listingJson.misses)
+        << ",\"evictions\":" << listingJson.evictions
+        << ",\"invalidations\":" << listingJson.invalidations << "}"
+        << ",\"searchResults\":{\"entries\":" << searchResults_->size()
+        << ",\"hits\":" << searchHits
+        << ",\"misses\":" << searchMisses
+        << ",\"hitRate\":" << hitRate(searchHits, searchMisses) << "}}";
     return oss.str();
 }
 
 // Порівняння оголошень
+std::string ApiServer::handleReloadModerationDictionary(const std::string& authToken) {
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
+    }
+    
+    if (!authMiddleware_->hasPermission(user.get(), "moderation", "manage")) {
+        return "{\"error\":\"Unauthorized\"}";
+    }
+    
+    // Компіляція йде в окремому потоці; перевірки тим часом використовують стару версію
+    DictionaryReport report = moderationService_->reloadAsync().get();
+    if (!report.success) {
+        auto current = moderationService_->describe();
+        std::ostringstream oss;
+        oss << "{\"error\":\"" << escapeJson(report.error) << "\",\"activeVersion\":" << current.version << "}";
+        return oss.str();
+    }
+    
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3)
+        << "{\"success\":true"
+        << ",\"version\":" << report.version
+        << ",\"source\":\"" << escapeJson(report.source) << "\""
+        << ",\"patternCount\":" << report.patternCount
+        << ",\"stateCount\":" << report.stateCount
+        << ",\"memoryBytes\":" << report.memoryBytes
+        << ",\"buildMs\":" << report.buildMs << "}";
+    return oss.str();
+}
+
+std::string ApiServer::handleRebuildRecommendations(const std::string& authToken) {
+    auto user = authMiddleware_->authenticate(authToken);
+    if (!user) {
+        return "{\"error\":\"Invalid token\"}";
+    }
+    
+    if (!authMiddleware_->hasPermission(user.get(), "recommendations", "manage")) {
+        return "{\"error\":\"Unauthorized\"}";
+    }
+    
+    CoViewBuildReport report = coViewModel_->rebuild();
+    if (!report.success) {
+        return "{\"error\":\"Failed to rebuild recommendations\"}";
+    }
+    
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3)
+        << "{\"success\":true"
+        << ",\"sessions\":" << report.sessions
+        << ",\"events\":" << report.events
+        << ",\"pairs\":" << report.pairs
+        << ",\"listings\":" << report.listings
+        << ",\"neighbors\":" << report.neighbors
+        << ",\"threads\":" << report.threads
+        << ",\"buildMs\":" << report.buildMs
+        << ",\"builtAt\":" << static_cast<long long>(report.builtAt) << "}";
+    return oss.str();
+}
+
 std::string ApiServer::handleCompareListings(const std::string& body, const std::string& authToken) {
     if (authToken.empty()) {
         return "{\"error\":\"Unauthorized\"}";
@@ -2369,16 +3064,17 @@ std::string ApiServer::handleCompareListings(const std::string& body, const std:
         
         if (rc == SQLITE_DONE) {
             // Повертаємо порівняння
-            std::ostringstream oss;
-            oss << "{\"id\":" << comparisonId << ",\"listingIds\":" << idsStr << ",\"listings\":[";
-            for (size_t i = 0; i < listingIds.size(); ++i) {
-                if (i > 0) oss << ",";
-                auto listing = listingRepository_->findById(listingIds[i]);
+            std::vector<std::unique_ptr<Listing>> listings;
+            for (int listingId : listingIds) {
+                auto listing = listingRepository_->findById(listingId);
                 if (listing) {
-                    oss << listing->toJson();
+                    userPreferences_->recordSignal(user->getId(), *listing, PreferenceSignal::Comparison);
+                    listings.push_back(std::move(listing));
                 }
             }
-            oss << "]}";
+            std::ostringstream oss;
+            oss << "{\"id\":" << comparisonId << ",\"listingIds\":" << idsStr
+                << ",\"listings\":" << serializeListings(listings, false) << "}";
             return oss.str();
         }
     }
@@ -2421,6 +3117,62 @@ std::string ApiServer::handleGetComparison(int comparisonId, const std::string&
     return "{\"error\":\"Comparison not found\"}";
 }
 
+// Схожі оголошення: kNN за числовими ознаками та типом палива/КПП/кузова
+std::string ApiServer::handleGetSimilarListings(int listingId, size_t limit) {
+    auto listing = listingRepository_->findById(listingId);
+    if (!listing) {
+        return "{\"error\":\"Listing not found\"}";
+    }
+    
+    std::vector<int> ids;
+    for (const auto& match : featureIndex_->findSimilar(*listing, limit)) {
+        ids.push_back(match.listingId);
+    }
+    auto similar = listingRepository_->findByIds(ids);
+    return serializeListings(similar, false);
+}
+
+// Історія цін оголошення
+std::string ApiServer::handleGetPriceHistory(int listingId) {
+    auto listing = listingRepository_->findById(listingId);
+    if (!listing) {
+        return "{\"error\":\"Listing not found\"}";
+    }
+    
+    auto db = listingRepository_->getDb();
+    const char* sql = "SELECT price, currency, changed_at FROM price_history WHERE listing_id = ? ORDER BY changed_at";
+    sqlite3_stmt* stmt;
+    std::stringstream json;
+    json << "[";
+    
+    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, listingId);
+        bool first = true;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            double price = sqlite3_column_double(stmt, 0);
+            const char* code = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            time_t changedAt = static_cast<time_t>(sqlite3_column_int64(stmt, 2));
+            Currency currency = parseCurrency(code ? code : "UAH");
+            
+            // Курс на день зміни ціни - O(1) з кешу історії курсів
+            if (!first) json << ",";
+            first = false;
+            json << std::fixed << std::setprecision(2)
+                 << "{\"price\":" << price
+                 << ",\"currency\":\"" << currencyCode(currency) << "\""
+                 << ",\"changedAt\":" << static_cast<long long>(changedAt)
+                 << ",\"priceUAH\":" << currencyService_->convertAt(price, currency, Currency::UAH, changedAt)
+                 << ",\"priceUSD\":" << currencyService_->convertAt(price, currency, Currency::USD, changedAt)
+                 << ",\"priceEUR\":" << currencyService_->convertAt(price, currency, Currency::EUR, changedAt)
+                 << "}";
+        }
+        sqlite3_finalize(stmt);
+    }
+    
+    json << "]";
+    return json.str();
+}
+
 // Історія переглядів
 std::string ApiServer::handleGetViewHistory(const std::string& authToken) {
     if (authToken.empty()) {
@@ -2435,30 +3187,23 @@ std::string ApiServer::handleGetViewHistory(const std::string& authToken) {
     auto db = listingRepository_->getDb();
     const char* sql = "SELECT listing_id, viewed_at FROM listing_views WHERE user_id = ? ORDER BY viewed_at DESC LIMIT 50";
     sqlite3_stmt* stmt;
-    std::ostringstream oss;
-    oss << "[";
-    bool first = true;
+    std::vector<std::unique_ptr<Listing>> listings;
     
     if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_int(stmt, 1, user->getId());
         
         while (sqlite3_step(stmt) == SQLITE_ROW) {
-            if (!first) oss << ",";
-            first = false;
-            
             int listingId = sqlite3_column_int(stmt, 0);
-            int viewedAt = sqlite3_column_int(stmt, 1);
             
             auto listing = listingRepository_->findById(listingId);
             if (listing) {
-                oss << listing->toJson();
+                listings.push_back(std::move(listing));
             }
         }
         sqlite3_finalize(stmt);
     }
     
-    oss << "]";
-    return oss.str();
+    return serializeListings(listings, false);
 }
 
 std::string ApiServer::handleAddViewHistory(int listingId, const std::string& authToken) {
@@ -2488,8 +3233,16 @@ std::string ApiServer::handleAddViewHistory(int listingId, const std::string& au
         sqlite3_step(stmt);
         sqlite3_finalize(stmt);
         
-        // Оновлюємо view_count в listings
+        // Оновлюємо view_count в listings (і в готовому JSON сторінки)
         listingRepository_->incrementViewCount(listingId);
+        listingJson_->recordView(listingId);
+        
+        if (userId > 0) {
+            auto listing = listingRepository_->findById(listingId);
+            if (listing) {
+                userPreferences_->recordSignal(userId, *listing, PreferenceSignal::View);
+            }
+        }
     }
     
     return "{\"success\":true}";
@@ -2508,60 +3261,52 @@ std::string ApiServer::handleGetRecommendations(const std::string& authToken, in
     
     std::vector<std::unique_ptr<Listing>> recommendations;
     
+    const size_t limit = 5;
+    
     if (listingId > 0) {
-        // Схожі оголошення на основі поточного
-        auto listing = listingRepository_->findById(listingId);
-        if (listing) {
-            // Знаходимо оголошення з тією ж маркою/моделлю
-            recommendations = listingRepository_->searchAndFilter(
-                "", listing->getBrandId(), listing->getModelId(), 0, 0,
-                "", "", "", "created_at", "DESC", 5, 0
-            );
-            // Видаляємо поточне оголошення
-            recommendations.erase(
-                std::remove_if(recommendations.begin(), recommendations.end(),
-                    [listingId](const std::unique_ptr<Listing>& l) { return l->getId() == listingId; }),
-                recommendations.end()
-            );
+        // "Також переглядали": top-K сусідів з моделі спільних переглядів, одним запитом
+        std::vector<int> neighborIds;
+        for (const auto& neighbor : coViewModel_->getNeighbors(listingId, CoViewModel::kTopK)) {
+            neighborIds.push_back(neighbor.listingId);
+        }
+        for (auto& candidate : listingRepository_->findByIds(neighborIds)) {
+            if (recommendations.size() >= limit) break;
+            if (candidate->getStatus() == "active") {
+                recommendations.push_back(std::move(candidate));
+            }
         }
-    } else {
-        // Персональні рекомендації на основі історії переглядів
-        auto db = listingRepository_->getDb();
-        const char* sql = "SELECT listing_id FROM listing_views WHERE user_id = ? ORDER BY viewed_at DESC LIMIT 5";
-        sqlite3_stmt* stmt;
-        std::vector<int> viewedBrandIds;
         
-        if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, user->getId());
-            
-            while (sqlite3_step(stmt) == SQLITE_ROW) {
-                int viewedListingId = sqlite3_column_int(stmt, 0);
-                auto viewedListing = listingRepository_->findById(viewedListingId);
-                if (viewedListing) {
-                    viewedBrandIds.push_back(viewedListing->getBrandId());
+        // Мало історії переглядів - доповнюємо оголошеннями тієї ж марки/моделі
+        if (recommendations.size() < limit) {
+            auto listing = listingRepository_->findById(listingId);
+            if (listing) {
+                auto sameModel = listingRepository_->searchAndFilter(
+                    "", listing->getBrandId(), listing->getModelId(), 0, 0,
+                    "", "", "", "created_at", "DESC", static_cast<int>(limit * 2), 0
+                );
+                for (auto& candidate : sameModel) {
+                    if (recommendations.size() >= limit) break;
+                    int candidateId = candidate->getId();
+                    bool taken = candidateId == listingId ||
+                        std::any_of(recommendations.begin(), recommendations.end(),
+                            [candidateId](const std::unique_ptr<Listing>& l) { return l->getId() == candidateId; });
+                    if (!taken) {
+                        recommendations.push_back(std::move(candidate));
+                    }
                 }
             }
-            sqlite3_finalize(stmt);
         }
-        
-        if (!viewedBrandIds.empty()) {
-            // Знаходимо оголошення з популярними марками
-            int popularBrandId = viewedBrandIds[0];
-            recommendations = listingRepository_->searchAndFilter(
-                "", popularBrandId, 0, 0, 0,
-                "", "", "", "view_count", "DESC", 5, 0
-            );
+    } else {
+        // Персональні рекомендації: профіль вподобань з усієї історії користувача,
+        // кандидати оцінюються за один прохід по індексу ознак
+        std::vector<int> ids;
+        for (const auto& scored : userPreferences_->recommend(user->getId(), limit)) {
+            ids.push_back(scored.listingId);
         }
+        recommendations = listingRepository_->findByIds(ids);
     }
     
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < recommendations.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << recommendations[i]->toJson();
-    }
-    oss << "]";
-    return oss.str();
+    return serializeListings(recommendations, false);
 }
 
 void ApiServer::normalizeStoredText() {
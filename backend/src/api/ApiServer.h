@@ -3,13 +3,28 @@
 #include "../repositories/UserRepository.h"
 #include "../repositories/ListingRepository.h"
 #include "../repositories/BrandRepository.h"
+#include "../repositories/MessageRepository.h"
 #include "../middleware/AuthMiddleware.h"
 #include "../services/ModerationService.h"
 #include "../services/CurrencyService.h"
 #include "../services/StatisticsService.h"
+#include "../services/PlatformCounters.h"
+#include "../services/ModerationQueue.h"
+#include "../services/DuplicateIndex.h"
+#include "../services/CoViewModel.h"
+#include "../services/FeatureIndex.h"
+#include "../services/UserPreferenceService.h"
+#include "../services/EventHub.h"
+#include "../services/UnreadCounters.h"
+#include "../services/RegionDirectory.h"
+#include "../services/ListingFacetIndex.h"
+#include "../services/SearchCountCache.h"
+#include "../services/SearchResultCache.h"
+#include "../services/ListingJsonCache.h"
 #include "httplib.h"
 #include <string>
 #include <memory>
+#include <map>
 
 // Клас ApiServer - інкапсуляція HTTP сервера та REST API
 class ApiServer {
@@ -18,11 +33,29 @@ private:
     std::shared_ptr<ListingRepository> listingRepository_;
     std::shared_ptr<BrandRepository> brandRepository_;
     std::shared_ptr<ModelRepository> modelRepository_;
+    std::shared_ptr<MessageRepository> messageRepository_;
     std::shared_ptr<AuthMiddleware> authMiddleware_;
     std::shared_ptr<ModerationService> moderationService_;
     CurrencyService* currencyService_; // Singleton, не shared_ptr
     std::shared_ptr<StatisticsService> statisticsService_;
+    std::shared_ptr<PlatformCounters> platformCounters_;
+    std::shared_ptr<ModerationQueue> moderationQueue_;
+    std::shared_ptr<DuplicateIndex> duplicateIndex_;
+    std::shared_ptr<CoViewModel> coViewModel_;
+    std::shared_ptr<FeatureIndex> featureIndex_;
+    std::shared_ptr<UserPreferenceService> userPreferences_;
+    std::shared_ptr<EventHub> eventHub_;
+    std::shared_ptr<UnreadCounters> unreadCounters_;
+    std::shared_ptr<RegionDirectory> regionDirectory_;
+    std::shared_ptr<ListingFacetIndex> facetIndex_;
+    std::shared_ptr<SearchCountCache> searchCounts_;
+    std::shared_ptr<SearchResultCache> searchResults_;
+    std::shared_ptr<ListingJsonCache> listingJson_;
     int port_;
+    // Потоки HTTP сервера; кожен потік подій (SSE / long-poll) займає один з них,
+    // тому потоків подій не більше kMaxEventStreams - решта лишається для REST
+    static const size_t kHttpThreads = 64;
+    static const size_t kMaxEventStreams = 48;
     void* server_; // httplib::Server*
 
 public:
@@ -30,6 +63,7 @@ public:
               std::shared_ptr<ListingRepository> listingRepo,
               std::shared_ptr<BrandRepository> brandRepo,
               std::shared_ptr<ModelRepository> modelRepo,
+              std::shared_ptr<MessageRepository> messageRepo,
               std::shared_ptr<AuthMiddleware> auth,
               int port = 8080);
     ~ApiServer();
@@ -41,12 +75,13 @@ private:
     // Обробники HTTP запитів
     std::string handleGetListings(const std::string& query);
     std::string handleGetMyListings(const std::string& authToken);
-    std::string handleGetListing(int id, const std::string& authToken);
+    std::string handleGetListing(int id);
     std::string handleCreateListing(const std::string& body, const std::string& authToken);
     std::string handleUpdateListing(int id, const std::string& body, const std::string& authToken);
     std::string handleDeleteListing(int id, const std::string& authToken);
     
     std::string handleGetBrands();
+    std::string handleGetRegions();
     std::string handleGetModels(int brandId);
     std::string handleRequestBrand(const std::string& body, const std::string& authToken);
     std::string handleRequestModel(const std::string& body, const std::string& authToken);
@@ -61,7 +96,12 @@ private:
     std::string handleGetSellerStats(const std::string& authToken);
     std::string handleCreatePurchaseRequest(int listingId, const std::string& body, const std::string& authToken);
     std::string handleMarkAsSold(int listingId, const std::string& authToken);
-    std::string handleGetListingsFiltered(const std::string& query);
+    // Сторінка пошуку; total - загальна кількість збігів, totalIsEstimate - чи це оцінка
+    std::string handleGetListingsFiltered(const std::string& query, size_t* total = nullptr,
+                                          bool* totalIsEstimate = nullptr);
+    // Загальна кількість для SQL-пошуку: точна з індексу, з неповної сторінки або з кешу підрахунків,
+    // інакше - оцінка (estimated = true) і фоновий підрахунок
+    size_t searchTotal(const ListingFilter& filter, int offset, int perPage, size_t pageRows, bool& estimated);
     std::string handleAddToFavorites(int listingId, const std::string& authToken);
     std::string handleRemoveFromFavorites(int listingId, const std::string& authToken);
     std::string handleGetFavorites(const std::string& authToken);
@@ -69,18 +109,31 @@ private:
     std::string handleGetComments(int listingId);
     std::string handleGetNotifications(const std::string& authToken);
     std::string handleMarkNotificationRead(int notificationId, const std::string& authToken);
+    std::string handleMarkAllNotificationsRead(const std::string& authToken);
+    // Бейджі непрочитаного з пам'яті, без вибірки рядків
+    std::string handleGetUnreadCounts(const std::string& authToken);
     
     // Повідомлення
     std::string handleSendMessage(const std::string& body, const std::string& authToken);
-    std::string handleGetMessages(const std::string& authToken, int otherUserId = 0);
+    // Переписка з otherUserId - сторінками за курсорами; курсори наступних сторінок - в olderCursor/newerCursor
+    std::string handleGetMessages(const std::string& authToken, int otherUserId = 0,
+                                  const std::string& before = "", const std::string& after = "", int limit = 0,
+                                  std::string* olderCursor = nullptr, std::string* newerCursor = nullptr);
     std::string handleMarkMessageRead(int messageId, const std::string& authToken);
+    // otherUserId = 0 - усі розмови, інакше лише переписка з otherUserId
+    std::string handleMarkAllMessagesRead(int otherUserId, const std::string& authToken);
     
     // Адмін панель
     std::string handleGetPendingListings(const std::string& authToken);
+    std::string handleGetDuplicateListings(const std::string& authToken);
     std::string handleModerateListing(int listingId, const std::string& body, const std::string& authToken);
     std::string handleGetAllUsers(const std::string& authToken);
     std::string handleBanUser(int userId, const std::string& body, const std::string& authToken);
     std::string handleGetPlatformStats(const std::string& authToken);
+    std::string handleGetEventStats(const std::string& authToken);
+    std::string handleGetCacheStats(const std::string& authToken);
+    std::string handleReloadModerationDictionary(const std::string& authToken);
+    std::string handleRebuildRecommendations(const std::string& authToken);
     
     // Порівняння оголошень
     std::string handleCompareListings(const std::string& body, const std::string& authToken);
@@ -88,6 +141,8 @@ private:
     
     // Історія переглядів
     std::string handleGetViewHistory(const std::string& authToken);
+    std::string handleGetPriceHistory(int listingId);
+    std::string handleGetSimilarListings(int listingId, size_t limit);
     std::string handleAddViewHistory(int listingId, const std::string& authToken);
     
     // Рекомендації
@@ -96,6 +151,13 @@ private:
     // Завантаження фото
     std::string handleUploadPhoto(int listingId, const httplib::Request& req, const std::string& authToken);
     
+    // Серіалізація сторінки оголошень (пакетна конвертація цін, продавці - один раз на сторінку)
+    std::string serializeListings(const std::vector<std::unique_ptr<Listing>>& listings, bool withSeller);
+    // Те саме для карток (списки: пошук, обране, мої оголошення)
+    std::string serializeSummaries(const std::vector<ListingSummary>& summaries, bool withSeller);
+    // Додає "seller" до JSON об'єкта; sellers - кеш продавців у межах сторінки
+    void appendSeller(std::string& json, int sellerId, std::map<int, std::unique_ptr<User>>& sellers);
+    
     // Валідація
     bool validateListingJson(const std::string& json, std::string& error);
     std::string extractAuthToken(const std::string& header);
@@ -10,6 +10,10 @@ Database::Database(const std::string& dbPath) : db_(nullptr), dbPath_(dbPath) {
     } else {
         // Встановлюємо UTF-8 кодування для SQLite
         sqlite3_exec(db_, "PRAGMA encoding = 'UTF-8';", nullptr, nullptr, nullptr);
+        // Кілька з'єднань (HTTP та фонові воркери): WAL дозволяє читати під час запису,
+        // а busy_timeout - чекати на блокування замість SQLITE_BUSY
+        sqlite3_exec(db_, "PRAGMA journal_mode = WAL;", nullptr, nullptr, nullptr);
+        sqlite3_busy_timeout(db_, 5000);
     }
 }
 
@@ -98,11 +102,39 @@ bool Database::initializeSchema() {
             body_type TEXT,
             doors_count INTEGER,
             engine_power INTEGER,
+            simhash INTEGER,
+            price_uah REAL,
+            region_id INTEGER,
             FOREIGN KEY (seller_id) REFERENCES users(id),
             FOREIGN KEY (brand_id) REFERENCES brands(id),
             FOREIGN KEY (model_id) REFERENCES models(id)
         );
         
+        -- Довідник регіонів; aliases - нормалізовані написання (RegionDirectory::normalizeKey)
+        CREATE TABLE IF NOT EXISTS regions (
+            id INTEGER PRIMARY KEY,
+            name TEXT NOT NULL UNIQUE
+        );
+        
+        CREATE TABLE IF NOT EXISTS region_aliases (
+            alias TEXT PRIMARY KEY,
+            region_id INTEGER NOT NULL,
+            FOREIGN KEY (region_id) REFERENCES regions(id)
+        );
+        
+        -- Можливі дублікати, знайдені за SimHash опису
+        CREATE TABLE IF NOT EXISTS duplicate_flags (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            listing_id INTEGER NOT NULL,
+            duplicate_of_id INTEGER NOT NULL,
+            distance INTEGER NOT NULL,
+            same_seller INTEGER DEFAULT 0,
+            created_at INTEGER,
+            FOREIGN KEY (listing_id) REFERENCES listings(id),
+            FOREIGN KEY (duplicate_of_id) REFERENCES listings(id),
+            UNIQUE(listing_id, duplicate_of_id)
+        );
+        
         CREATE TABLE IF NOT EXISTS favorites (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             user_id INTEGER NOT NULL,
@@ -134,6 +166,10 @@ bool Database::initializeSchema() {
             FOREIGN KEY (user_id) REFERENCES users(id)
         );
         
+        -- Сповіщення користувача та звірка лічильників непрочитаного
+        CREATE INDEX IF NOT EXISTS idx_notifications_user ON notifications(user_id, created_at);
+        CREATE INDEX IF NOT EXISTS idx_notifications_unread ON notifications(user_id) WHERE is_read = 0;
+        
         CREATE TABLE IF NOT EXISTS listing_comparisons (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             user_id INTEGER NOT NULL,
@@ -151,6 +187,14 @@ bool Database::initializeSchema() {
             FOREIGN KEY (listing_id) REFERENCES listings(id)
         );
         
+        -- Історія курсів: day - номер дня від 1970-01-01 (UTC), rate - курс до UAH
+        CREATE TABLE IF NOT EXISTS exchange_rates (
+            day INTEGER NOT NULL,
+            ccy TEXT NOT NULL,
+            rate REAL NOT NULL,
+            PRIMARY KEY (day, ccy)
+        );
+        
         CREATE TABLE IF NOT EXISTS purchase_requests (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             listing_id INTEGER NOT NULL,
@@ -172,6 +216,9 @@ bool Database::initializeSchema() {
             FOREIGN KEY (listing_id) REFERENCES listings(id)
         );
         
+        -- Історія користувача (профіль вподобань) читається за user_id
+        CREATE INDEX IF NOT EXISTS idx_listing_views_user ON listing_views(user_id, viewed_at);
+        
         CREATE TABLE IF NOT EXISTS brand_requests (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             user_id INTEGER NOT NULL,
@@ -200,11 +247,33 @@ bool Database::initializeSchema() {
             message_text TEXT NOT NULL,
             is_read INTEGER DEFAULT 0,
             created_at INTEGER,
+            status TEXT DEFAULT 'active',
             FOREIGN KEY (sender_id) REFERENCES users(id),
             FOREIGN KEY (receiver_id) REFERENCES users(id),
             FOREIGN KEY (listing_id) REFERENCES listings(id)
         );
         
+        -- Переписка пари користувачів незалежно від напрямку, впорядкована для курсорів
+        CREATE INDEX IF NOT EXISTS idx_messages_pair
+            ON messages(MIN(sender_id, receiver_id), MAX(sender_id, receiver_id), created_at, id);
+        -- Непрочитані отримувача: звірка лічильників та "прочитати все"
+        CREATE INDEX IF NOT EXISTS idx_messages_unread ON messages(receiver_id, sender_id) WHERE is_read = 0;
+        
+        -- Підсумок розмови двох користувачів (user_a < user_b) для inbox
+        CREATE TABLE IF NOT EXISTS conversations (
+            user_a INTEGER NOT NULL,
+            user_b INTEGER NOT NULL,
+            last_message_id INTEGER NOT NULL,
+            last_at INTEGER,
+            unread_a INTEGER DEFAULT 0,
+            unread_b INTEGER DEFAULT 0,
+            PRIMARY KEY (user_a, user_b),
+            FOREIGN KEY (user_a) REFERENCES users(id),
+            FOREIGN KEY (user_b) REFERENCES users(id),
+            FOREIGN KEY (last_message_id) REFERENCES messages(id)
+        );
+        CREATE INDEX IF NOT EXISTS idx_conversations_user_b ON conversations(user_b);
+        
         CREATE TABLE IF NOT EXISTS seller_reviews (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             seller_id INTEGER NOT NULL,
@@ -219,6 +288,43 @@ bool Database::initializeSchema() {
             UNIQUE(seller_id, reviewer_id, listing_id)
         );
     )";
-    return execute(sql);
+    if (!execute(sql)) {
+        return false;
+    }
+    
+    // Колонки, додані після першого релізу
+    if (!ensureColumn("messages", "status", "TEXT DEFAULT 'active'") ||
+        !ensureColumn("listings", "simhash", "INTEGER") ||
+        !ensureColumn("listings", "price_uah", "REAL") ||
+        !ensureColumn("listings", "region_id", "INTEGER REFERENCES regions(id)")) {
+        return false;
+    }
+    
+    // Індекси по колонкам, що можуть бути щойно додані:
+    // ціна в гривнях для фільтрів і сортування між валютами, регіон - рівність по id
+    return execute("CREATE INDEX IF NOT EXISTS idx_listings_status_price_uah ON listings(status, price_uah)") &&
+           execute("CREATE INDEX IF NOT EXISTS idx_listings_region_status_price ON listings(region_id, status, price_uah)");
+}
+
+bool Database::ensureColumn(const std::string& table, const std::string& column, const std::string& definition) {
+    if (!db_) return false;
+    
+    std::string pragma = "PRAGMA table_info(" + table + ")";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_, pragma.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    bool exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (name && column == name) {
+            exists = true;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+    
+    if (exists) return true;
+    return execute("ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition);
 }
 
@@ -19,8 +19,12 @@ public:
     
     bool execute(const std::string& sql);
     sqlite3* getHandle() { return db_; }
+    const std::string& getPath() const { return dbPath_; }
     
     bool initializeSchema();
+    
+    // Додає колонку до існуючої таблиці, якщо її ще немає (міграція старих БД)
+    bool ensureColumn(const std::string& table, const std::string& column, const std::string& definition);
 };
 
 
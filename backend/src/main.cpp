@@ -3,6 +3,7 @@
 #include "repositories/UserRepository.h"
 #include "repositories/ListingRepository.h"
 #include "repositories/BrandRepository.h"
+#include "repositories/MessageRepository.h"
 #include "middleware/AuthMiddleware.h"
 #include "api/ApiServer.h"
 #include <iostream>
@@ -27,12 +28,13 @@ int main() {
     auto listingRepo = std::make_shared<ListingRepository>(sharedDb);
     auto brandRepo = std::make_shared<BrandRepository>(sharedDb);
     auto modelRepo = std::make_shared<ModelRepository>(sharedDb);
+    auto messageRepo = std::make_shared<MessageRepository>(sharedDb);
     
     // Створення middleware
     auto authMiddleware = std::make_shared<AuthMiddleware>(userRepo);
     
     // Створення API сервера
-    ApiServer server(userRepo, listingRepo, brandRepo, modelRepo, authMiddleware, 8080);
+    ApiServer server(userRepo, listingRepo, brandRepo, modelRepo, messageRepo, authMiddleware, 8080);
     
     std::cout << "AutoRia API Server" << std::endl;
     std::cout << "API available at http://localhost:8080/api" << std::endl;
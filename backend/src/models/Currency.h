@@ -0,0 +1,49 @@
+// FILE: backend/src/models/Currency.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Підтримувані валюти (значення - індекс у таблицях курсів)
+enum class Currency : uint8_t {
+    UAH = 0,
+    USD = 1,
+    EUR = 2
+};
+
+constexpr size_t kCurrencyCount = 3;
+
+// Розбір коду валюти з запиту: регістр не важливий ("usd" - USD).
+// false - невідомий код (клієнт має отримати помилку, а не тихо гривню)
+inline bool tryParseCurrency(const std::string& code, Currency& currency) {
+    std::string upper = code;
+    for (char& c : upper) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    if (upper == "UAH") currency = Currency::UAH;
+    else if (upper == "USD") currency = Currency::USD;
+    else if (upper == "EUR") currency = Currency::EUR;
+    else return false;
+    return true;
+}
+
+// Розбір збереженого (канонічного) коду валюти; невідомий код трактується як UAH
+inline Currency parseCurrency(const std::string& code) {
+    if (code == "USD") return Currency::USD;
+    if (code == "EUR") return Currency::EUR;
+    return Currency::UAH;
+}
+
+inline const char* currencyCode(Currency currency) {
+    switch (currency) {
+        case Currency::USD: return "USD";
+        case Currency::EUR: return "EUR";
+        default: return "UAH";
+    }
+}
+
+// Код валюти як рядок зі статичної таблиці (для геттерів, що повертають const&)
+inline const std::string& currencyName(Currency currency) {
+    static const std::string kNames[kCurrencyCount] = {"UAH", "USD", "EUR"};
+    return kNames[static_cast<size_t>(currency)];
+}
@@ -1,112 +1,145 @@
 // FILE: backend/src/models/Listing.cpp
 #include "Listing.h"
 #include "../services/CurrencyService.h"
+#include "../utils/JsonEscape.h"
 #include <sstream>
 #include <cmath>
 #include <iomanip>
+#include <utility>
 
-// Функція для екранування JSON рядків
-static std::string escapeJson(const std::string& str) {
-    std::ostringstream oss;
-    for (char c : str) {
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') 
-                        << static_cast<int>(static_cast<unsigned char>(c));
-                } else {
-                    oss << c;
-                }
-                break;
-        }
-    }
-    return oss.str();
-}
+const ListingText Listing::kEmptyText;
 
 Listing::Listing(int id, int sellerId, int brandId, int modelId, int year,
                  double price, const std::string& currency, double exchangeRate,
                  const std::string& description, const std::string& region, int mileage)
     : id_(id), sellerId_(sellerId), brandId_(brandId), modelId_(modelId),
-      year_(year), price_(price), currency_(currency), exchangeRate_(exchangeRate),
-      description_(description), region_(region), mileage_(mileage),
-      status_("draft"), editCount_(0), viewCount_(0), photos_("[]"),
-      fuelType_(""), transmission_(""), color_(""), engineVolume_(0.0),
-      bodyType_(""), doorsCount_(0), enginePower_(0) {
+      year_(year), mileage_(mileage), regionId_(0), price_(price), exchangeRate_(exchangeRate),
+      currency_(parseCurrency(currency)), status_(ListingStatus::Draft), dirtyFields_(0),
+      editCount_(0), viewCount_(0), doorsCount_(0), enginePower_(0), engineVolume_(0.0),
+      simHash_(0), region_(region) {
     time(&createdAt_);
     updatedAt_ = createdAt_;
     lastModerationDate_ = 0;
+    if (!description.empty()) {
+        mutableText().description = description;
+    }
 }
 
-double Listing::getPriceInUSD() const {
-    if (currency_ == "USD") return price_;
-    
-    // Спочатку конвертуємо в UAH, потім в USD
-    double priceInUAH = getPriceInUAH();
-    
-    // Отримуємо актуальний курс USD/UAH
-    CurrencyService* currencyService = CurrencyService::getInstance();
-    currencyService->updateRates();
-    auto rates = currencyService->getCurrentRates();
-    
-    // UAH -> USD
-    return priceInUAH / rates.usdToUah;
+Listing::Listing(ListingState state)
+    : id_(state.id), sellerId_(state.sellerId), brandId_(state.brandId), modelId_(state.modelId),
+      year_(state.year), mileage_(state.mileage), regionId_(state.regionId), price_(state.price), exchangeRate_(state.exchangeRate),
+      currency_(state.currency), status_(parseListingStatus(state.status)), dirtyFields_(0),
+      editCount_(state.editCount), viewCount_(state.viewCount),
+      doorsCount_(state.doorsCount), enginePower_(state.enginePower), engineVolume_(state.engineVolume),
+      createdAt_(state.createdAt), updatedAt_(state.updatedAt),
+      lastModerationDate_(state.lastModerationDate), simHash_(state.simHash),
+      region_(std::move(state.region)), fuelType_(state.fuelType, fuelTypes()),
+      transmission_(state.transmission, transmissions()), color_(std::move(state.color)),
+      bodyType_(state.bodyType, bodyTypes()) {
+    if (!state.description.empty() || state.photos != kEmptyText.photos) {
+        text_ = std::make_shared<ListingText>();
+        text_->description = std::move(state.description);
+        text_->photos = std::move(state.photos);
+    }
 }
 
-double Listing::getPriceInEUR() const {
-    if (currency_ == "EUR") return price_;
-    
-    // Спочатку конвертуємо в UAH, потім в EUR
-    double priceInUAH = getPriceInUAH();
-    
-    // Використовуємо збережений курс EUR/UAH, якщо він є
-    // Інакше використовуємо актуальний курс
-    CurrencyService* currencyService = CurrencyService::getInstance();
-    currencyService->updateRates();
-    auto rates = currencyService->getCurrentRates();
-    
-    // Якщо валюта була EUR, exchangeRate_ містить EUR/UAH
-    // Якщо валюта була USD, exchangeRate_ містить USD/UAH, потрібно конвертувати через UAH
-    double eurToUahRate = (currency_ == "EUR" && exchangeRate_ > 0) ? 
-                          exchangeRate_ : rates.eurToUah;
-    
-    // UAH -> EUR
-    return priceInUAH / eurToUahRate;
+const InternedString::Vocabulary& Listing::fuelTypes() {
+    static const InternedString::Vocabulary vocabulary{"petrol", "diesel", "electric", "hybrid"};
+    return vocabulary;
 }
 
-double Listing::getPriceInUAH() const {
-    if (currency_ == "UAH") return price_;
-    
-    // Завжди використовуємо збережений exchangeRate_, якщо він встановлений
-    // exchangeRate_ зберігає курс основної валюти до UAH на момент створення оголошення
-    // Перевіряємо, чи exchangeRate_ встановлено (більше 0) та чи валюта не UAH
-    if (exchangeRate_ > 0 && currency_ != "UAH") {
-        return price_ * exchangeRate_;
+const InternedString::Vocabulary& Listing::transmissions() {
+    static const InternedString::Vocabulary vocabulary{"manual", "automatic", "robot"};
+    return vocabulary;
+}
+
+const InternedString::Vocabulary& Listing::bodyTypes() {
+    static const InternedString::Vocabulary vocabulary{"sedan", "hatchback", "suv", "coupe", "wagon", "van"};
+    return vocabulary;
+}
+
+ListingText& Listing::mutableText() {
+    if (!text_) {
+        text_ = std::make_shared<ListingText>();
+    } else if (text_.use_count() > 1) {
+        text_ = std::make_shared<ListingText>(*text_);
     }
-    
-    // Якщо exchangeRate_ не встановлено, використовуємо актуальний курс
-    CurrencyService* currencyService = CurrencyService::getInstance();
-    currencyService->updateRates();
-    auto rates = currencyService->getCurrentRates();
-    
-    if (currency_ == "USD") {
-        return price_ * rates.usdToUah;
+    return *text_;
+}
+
+void Listing::setDescription(const std::string& description) {
+    if (getDescription() != description) {
+        rememberOriginal();
+        mutableText().description = description;
+        dirtyFields_ |= ListingField::Description;
     }
-    
-    if (currency_ == "EUR") {
-        return price_ * rates.eurToUah;
+}
+
+void Listing::setPhotos(const std::string& photos) {
+    if (getPhotos() != photos) {
+        rememberOriginal();
+        mutableText().photos = photos;
+        dirtyFields_ |= ListingField::Photos;
+    }
+}
+
+void Listing::convertPrice(const RateSnapshot& rates, double& priceUSD, double& priceEUR, double& priceUAH) const {
+    // exchangeRate_ зберігає курс основної валюти до UAH на момент створення оголошення;
+    // якщо він не встановлений - використовується актуальний курс зі знімка
+    CurrencyService::convertBatch(rates, 1, &price_, &currency_, &exchangeRate_,
+                                  &priceUSD, &priceEUR, &priceUAH);
+}
+
+Listing::PagePrices Listing::convertPage(const std::vector<std::unique_ptr<Listing>>& listings) {
+    size_t count = listings.size();
+    std::vector<double> prices(count);
+    std::vector<Currency> currencies(count);
+    std::vector<double> exchangeRates(count);
+    for (size_t i = 0; i < count; ++i) {
+        prices[i] = listings[i]->price_;
+        currencies[i] = listings[i]->currency_;
+        exchangeRates[i] = listings[i]->exchangeRate_;
     }
     
-    return price_;
+    PagePrices result;
+    result.usd.resize(count);
+    result.eur.resize(count);
+    result.uah.resize(count);
+    CurrencyService::convertBatch(*CurrencyService::getInstance()->getSnapshot(), count,
+                                  prices.data(), currencies.data(), exchangeRates.data(),
+                                  result.usd.data(), result.eur.data(), result.uah.data());
+    return result;
+}
+
+double Listing::getPriceInUSD() const {
+    double usd, eur, uah;
+    convertPrice(*CurrencyService::getInstance()->getSnapshot(), usd, eur, uah);
+    return usd;
+}
+
+double Listing::getPriceInEUR() const {
+    double usd, eur, uah;
+    convertPrice(*CurrencyService::getInstance()->getSnapshot(), usd, eur, uah);
+    return eur;
+}
+
+double Listing::getPriceInUAH() const {
+    double usd, eur, uah;
+    convertPrice(*CurrencyService::getInstance()->getSnapshot(), usd, eur, uah);
+    return uah;
 }
 
 std::string Listing::toJson() const {
+    // Один знімок курсів на всю серіалізацію
+    double priceUSD, priceEUR, priceUAH;
+    convertPrice(*CurrencyService::getInstance()->getSnapshot(), priceUSD, priceEUR, priceUAH);
+    return toJson(priceUSD, priceEUR, priceUAH);
+}
+
+std::string Listing::toJson(double priceUSD, double priceEUR, double priceUAH) const {
+    const std::string& currency = currencyName(currency_);
+    const std::string& description = getDescription();
+    const std::string& photos = getPhotos();
     std::ostringstream oss;
     // Додаємо photos до JSON
     oss << std::fixed;
@@ -117,34 +150,34 @@ std::string Listing::toJson() const {
         << ",\"modelId\":" << modelId_
         << ",\"year\":" << year_
         << ",\"price\":" << price_
-        << ",\"currency\":\"" << escapeJson(currency_) << "\""
+        << ",\"currency\":\"" << currency << "\""
         << ",\"exchangeRate\":" << exchangeRate_
-        << ",\"priceUSD\":" << std::fixed << std::setprecision(2) << getPriceInUSD()
-        << ",\"priceEUR\":" << std::fixed << std::setprecision(2) << getPriceInEUR()
-        << ",\"priceUAH\":" << std::fixed << std::setprecision(2) << getPriceInUAH()
+        << ",\"priceUSD\":" << std::fixed << std::setprecision(2) << priceUSD
+        << ",\"priceEUR\":" << std::fixed << std::setprecision(2) << priceEUR
+        << ",\"priceUAH\":" << std::fixed << std::setprecision(2) << priceUAH
         << ",\"debug_price\":" << price_
-        << ",\"debug_currency\":\"" << currency_ << "\""
+        << ",\"debug_currency\":\"" << currency << "\""
         << ",\"debug_exchangeRate\":" << exchangeRate_
         << ",\"debug_calc\":" << (exchangeRate_ > 0 ? price_ * exchangeRate_ : 0.0)
-        << ",\"description\":\"" << escapeJson(description_) << "\""
+        << ",\"description\":\"" << escapeJson(description) << "\""
         << ",\"region\":\"" << escapeJson(region_) << "\""
         << ",\"mileage\":" << mileage_
-        << ",\"status\":\"" << escapeJson(status_) << "\""
+        << ",\"status\":\"" << listingStatusName(status_) << "\""
         << ",\"editCount\":" << editCount_
         << ",\"viewCount\":" << viewCount_;
     
     // Обробка photos - перевіряємо, чи це валідний JSON
-    if (photos_.empty() || photos_ == "[]") {
+    if (photos.empty() || photos == "[]") {
         oss << ",\"photos\":[]";
     } else {
-        // Перевіряємо, чи photos_ є валідним JSON масивом
+        // Перевіряємо, чи photos є валідним JSON масивом
         bool isValidJsonArray = false;
-        if (photos_.length() >= 2 && photos_[0] == '[' && photos_[photos_.length() - 1] == ']') {
+        if (photos.length() >= 2 && photos[0] == '[' && photos[photos.length() - 1] == ']') {
             // Спроба перевірити, чи це валідний JSON (проста перевірка)
             isValidJsonArray = true;
             // Перевіряємо, чи немає невалідних символів
-            for (size_t i = 1; i < photos_.length() - 1; ++i) {
-                unsigned char c = static_cast<unsigned char>(photos_[i]);
+            for (size_t i = 1; i < photos.length() - 1; ++i) {
+                unsigned char c = static_cast<unsigned char>(photos[i]);
                 if (c < 0x20 && c != '\n' && c != '\r' && c != '\t') {
                     isValidJsonArray = false;
                     break;
@@ -153,7 +186,7 @@ std::string Listing::toJson() const {
         }
         
         if (isValidJsonArray) {
-            oss << ",\"photos\":" << photos_;
+            oss << ",\"photos\":" << photos;
         } else {
             // Якщо невалідний JSON, повертаємо порожній масив
             oss << ",\"photos\":[]";
@@ -161,11 +194,11 @@ std::string Listing::toJson() const {
     }
     
     // Додаткові характеристики
-    if (!fuelType_.empty()) oss << ",\"fuelType\":\"" << escapeJson(fuelType_) << "\"";
-    if (!transmission_.empty()) oss << ",\"transmission\":\"" << escapeJson(transmission_) << "\"";
+    if (!fuelType_.empty()) oss << ",\"fuelType\":\"" << escapeJson(fuelType_.str()) << "\"";
+    if (!transmission_.empty()) oss << ",\"transmission\":\"" << escapeJson(transmission_.str()) << "\"";
     if (!color_.empty()) oss << ",\"color\":\"" << escapeJson(color_) << "\"";
     if (engineVolume_ > 0) oss << ",\"engineVolume\":" << engineVolume_;
-    if (!bodyType_.empty()) oss << ",\"bodyType\":\"" << escapeJson(bodyType_) << "\"";
+    if (!bodyType_.empty()) oss << ",\"bodyType\":\"" << escapeJson(bodyType_.str()) << "\"";
     if (doorsCount_ > 0) oss << ",\"doorsCount\":" << doorsCount_;
     if (enginePower_ > 0) oss << ",\"enginePower\":" << enginePower_;
     
@@ -1,9 +1,88 @@
 // FILE: backend/src/models/Listing.h
 #pragma once
+#include "Currency.h"
+#include "ListingStatus.h"
+#include "../utils/InternedString.h"
 #include <string>
+#include <cstdint>
 #include <ctime>
+#include <memory>
+#include <vector>
 
-// Клас Listing - інкапсуляція оголошення про продаж авто
+struct RateSnapshot;
+
+// Повний стан оголошення (рядок listings) - для відновлення з БД одним конструктором
+struct ListingState {
+    int id = 0;
+    int sellerId = 0;
+    int brandId = 0;
+    int modelId = 0;
+    int year = 0;
+    double price = 0.0;
+    Currency currency = Currency::UAH;
+    double exchangeRate = 0.0;
+    std::string description;
+    std::string region;
+    int regionId = 0; // regions.id, 0 - регіон поза довідником
+    int mileage = 0;
+    std::string status = "draft";
+    int editCount = 0;
+    int viewCount = 0;
+    time_t createdAt = 0;
+    time_t updatedAt = 0;
+    time_t lastModerationDate = 0;
+    std::string photos = "[]";
+    std::string fuelType;
+    std::string transmission;
+    std::string color;
+    double engineVolume = 0.0;
+    std::string bodyType;
+    int doorsCount = 0;
+    int enginePower = 0;
+    uint64_t simHash = 0;
+};
+
+// Колонки listings, змінені сеттерами після завантаження (бітова маска).
+// ListingRepository::updateFields записує лише їх, спостерігачі - пропускають незмінене.
+namespace ListingField {
+enum Mask : uint32_t {
+    BrandId            = 1u << 0,
+    ModelId            = 1u << 1,
+    Year               = 1u << 2,
+    Price              = 1u << 3,
+    Currency           = 1u << 4,
+    ExchangeRate       = 1u << 5,
+    Description        = 1u << 6,
+    Region             = 1u << 7,
+    Mileage            = 1u << 8,
+    Status             = 1u << 9,
+    EditCount          = 1u << 10,
+    ViewCount          = 1u << 11,
+    LastModerationDate = 1u << 12,
+    Photos             = 1u << 13,
+    FuelType           = 1u << 14,
+    Transmission       = 1u << 15,
+    Color              = 1u << 16,
+    EngineVolume       = 1u << 17,
+    BodyType           = 1u << 18,
+    DoorsCount         = 1u << 19,
+    EnginePower        = 1u << 20,
+    SimHash            = 1u << 21,
+    RegionId           = 1u << 22,
+    All                = (1u << 23) - 1
+};
+}
+
+// Рідко потрібний довгий текст оголошення (картки та індекси його не читають)
+struct ListingText {
+    std::string description;
+    std::string photos = "[]"; // JSON array of photo URLs/paths
+};
+
+// Клас Listing - інкапсуляція оголошення про продаж авто.
+// Гарячі числові поля та інтерновані короткі значення лежать в об'єкті,
+// опис і фото - в окремому блоці, що створюється лише для непорожнього тексту
+// і спільний між копіями до першої зміни.
 class Listing {
 private:
     int id_;
@@ -11,69 +90,108 @@ private:
     int brandId_;
     int modelId_;
     int year_;
+    int mileage_;
+    int regionId_; // regions.id, 0 - регіон поза довідником
     double price_;
-    std::string currency_; // "USD", "EUR", "UAH"
     double exchangeRate_; // Курс на момент створення
-    std::string description_;
-    std::string region_; // Регіон продажу
-    int mileage_;
-    std::string status_; // "draft", "pending", "active", "rejected", "inactive"
+    Currency currency_; // USD, EUR, UAH (рядок - через currencyName)
+    ListingStatus status_;
+    uint32_t dirtyFields_; // ListingField::Mask
     int editCount_; // Кількість редагувань
+    int viewCount_;
+    int doorsCount_;
+    int enginePower_; // в к.с.
+    double engineVolume_; // в літрах
     time_t createdAt_;
     time_t updatedAt_;
-    int viewCount_;
     time_t lastModerationDate_;
-    std::string photos_; // JSON array of photo URLs/paths
-    std::string fuelType_; // "petrol", "diesel", "electric", "hybrid"
-    std::string transmission_; // "manual", "automatic", "robot"
+    uint64_t simHash_; // SimHash опису для пошуку дублікатів (0 - немає)
+    std::string region_; // Регіон продажу (вільний текст)
+    InternedString fuelType_; // fuelTypes(): "petrol", "diesel", "electric", "hybrid"
+    InternedString transmission_; // transmissions(): "manual", "automatic", "robot"
     std::string color_;
-    double engineVolume_; // в літрах
-    std::string bodyType_; // "sedan", "hatchback", "suv", "coupe", etc.
-    int doorsCount_;
-    int enginePower_; // в к.с.
+    InternedString bodyType_; // bodyTypes(): "sedan", "hatchback", "suv", "coupe", etc.
+    std::shared_ptr<ListingText> text_; // nullptr - порожній опис і "[]"; копії ділять блок до зміни
+    std::shared_ptr<const Listing> original_; // Стан до першої зміни сеттером; nullptr - змін не було
+    static const ListingText kEmptyText;
 
 public:
     Listing(int id, int sellerId, int brandId, int modelId, int year,
             double price, const std::string& currency, double exchangeRate,
             const std::string& description, const std::string& region, int mileage);
+    // Відновлення збереженого оголошення з усіма лічильниками та датами
+    explicit Listing(ListingState state);
     
-    // Геттери
+    // Геттери (рядки - посилання на поля або статичні таблиці, без копіювання)
     int getId() const { return id_; }
     int getSellerId() const { return sellerId_; }
     int getBrandId() const { return brandId_; }
     int getModelId() const { return modelId_; }
     int getYear() const { return year_; }
     double getPrice() const { return price_; }
-    std::string getCurrency() const { return currency_; }
+    const std::string& getCurrency() const { return currencyName(currency_); }
+    Currency getCurrencyCode() const { return currency_; }
     double getExchangeRate() const { return exchangeRate_; }
-    std::string getStatus() const { return status_; }
+    const std::string& getStatus() const { return listingStatusName(status_); }
+    ListingStatus getStatusCode() const { return status_; }
     int getEditCount() const { return editCount_; }
     int getViewCount() const { return viewCount_; }
-    std::string getRegion() const { return region_; }
-    std::string getDescription() const { return description_; }
+    time_t getCreatedAt() const { return createdAt_; }
+    time_t getUpdatedAt() const { return updatedAt_; }
+    time_t getLastModerationDate() const { return lastModerationDate_; }
+    const std::string& getRegion() const { return region_; }
+    int getRegionId() const { return regionId_; }
+    const std::string& getDescription() const { return text().description; }
     int getMileage() const { return mileage_; }
-    std::string getPhotos() const { return photos_; }
-    std::string getFuelType() const { return fuelType_; }
-    std::string getTransmission() const { return transmission_; }
-    std::string getColor() const { return color_; }
+    const std::string& getPhotos() const { return text().photos; }
+    const std::string& getFuelType() const { return fuelType_.str(); }
+    const std::string& getTransmission() const { return transmission_.str(); }
+    const std::string& getColor() const { return color_; }
     double getEngineVolume() const { return engineVolume_; }
-    std::string getBodyType() const { return bodyType_; }
+    const std::string& getBodyType() const { return bodyType_.str(); }
     int getDoorsCount() const { return doorsCount_; }
     int getEnginePower() const { return enginePower_; }
+    uint64_t getSimHash() const { return simHash_; }
+    
+    // Словники полів з фіксованим набором значень (варіанти форми оголошення);
+    // інші значення зберігаються як звичайні рядки
+    static const InternedString::Vocabulary& fuelTypes();
+    static const InternedString::Vocabulary& transmissions();
+    static const InternedString::Vocabulary& bodyTypes();
+    
+    // Сеттери (позначають колонку зміненою, лише якщо значення інше)
+    void setBrandId(int brandId) { assign(brandId_, brandId, ListingField::BrandId); }
+    void setModelId(int modelId) { assign(modelId_, modelId, ListingField::ModelId); }
+    void setYear(int year) { assign(year_, year, ListingField::Year); }
+    void setPrice(double price) { assign(price_, price, ListingField::Price); }
+    void setCurrency(const std::string& currency) { assign(currency_, parseCurrency(currency), ListingField::Currency); }
+    void setExchangeRate(double rate) { assign(exchangeRate_, rate, ListingField::ExchangeRate); }
+    void setDescription(const std::string& description);
+    void setRegion(const std::string& region) { assign(region_, region, ListingField::Region); }
+    void setRegionId(int regionId) { assign(regionId_, regionId, ListingField::RegionId); }
+    void setMileage(int mileage) { assign(mileage_, mileage, ListingField::Mileage); }
+    void setStatus(ListingStatus status) { assign(status_, status, ListingField::Status); }
+    void setStatus(const std::string& status) { setStatus(parseListingStatus(status)); }
+    void setPhotos(const std::string& photos);
+    void setFuelType(const std::string& fuelType) { assign(fuelType_, InternedString(fuelType, fuelTypes()), ListingField::FuelType); }
+    void setTransmission(const std::string& transmission) { assign(transmission_, InternedString(transmission, transmissions()), ListingField::Transmission); }
+    void setColor(const std::string& color) { assign(color_, color, ListingField::Color); }
+    void setEngineVolume(double volume) { assign(engineVolume_, volume, ListingField::EngineVolume); }
+    void setBodyType(const std::string& bodyType) { assign(bodyType_, InternedString(bodyType, bodyTypes()), ListingField::BodyType); }
+    void setDoorsCount(int count) { assign(doorsCount_, count, ListingField::DoorsCount); }
+    void setEnginePower(int power) { assign(enginePower_, power, ListingField::EnginePower); }
+    void setSimHash(uint64_t simHash) { assign(simHash_, simHash, ListingField::SimHash); }
+    void setEditCount(int count) { assign(editCount_, count, ListingField::EditCount); }
+    void setViewCount(int count) { assign(viewCount_, count, ListingField::ViewCount); }
+    void setLastModerationDate(time_t date) { assign(lastModerationDate_, date, ListingField::LastModerationDate); }
     
-    // Сеттери
-    void setStatus(const std::string& status) { status_ = status; }
-    void setPhotos(const std::string& photos) { photos_ = photos; }
-    void setFuelType(const std::string& fuelType) { fuelType_ = fuelType; }
-    void setTransmission(const std::string& transmission) { transmission_ = transmission; }
-    void setColor(const std::string& color) { color_ = color; }
-    void setEngineVolume(double volume) { engineVolume_ = volume; }
-    void setBodyType(const std::string& bodyType) { bodyType_ = bodyType; }
-    void setDoorsCount(int count) { doorsCount_ = count; }
-    void setEnginePower(int power) { enginePower_ = power; }
-    void incrementEditCount() { editCount_++; }
-    void incrementViewCount() { viewCount_++; }
-    void setLastModerationDate(time_t date) { lastModerationDate_ = date; }
+    // Змінені колонки з моменту завантаження / останнього запису
+    uint32_t getDirtyFields() const { return dirtyFields_; }
+    void markDirty(uint32_t fields) { dirtyFields_ |= fields; }
+    void clearDirtyFields() { dirtyFields_ = 0; original_.reset(); }
+    // Стан до першої зміни сеттером з моменту завантаження / останнього запису
+    // (знімок "до" для спостерігачів без повторного читання з БД); nullptr - змін не було
+    const Listing* getOriginal() const { return original_.get(); }
     
     // Перевірка можливості редагування
     bool canEdit() const { return editCount_ < 3; }
@@ -83,8 +201,39 @@ public:
     double getPriceInEUR() const;
     double getPriceInUAH() const;
     
+    // Пакетна конвертація цін сторінки оголошень (один знімок курсів на сторінку)
+    struct PagePrices {
+        std::vector<double> usd;
+        std::vector<double> eur;
+        std::vector<double> uah;
+    };
+    static PagePrices convertPage(const std::vector<std::unique_ptr<Listing>>& listings);
+    
     // Серіалізація
     std::string toJson() const;
+    std::string toJson(double priceUSD, double priceEUR, double priceUAH) const; // З готовими цінами
     std::string toJsonWithStats() const; // Зі статистикою для преміум
+    
+private:
+    template <typename T>
+    void assign(T& field, const T& value, uint32_t mask) {
+        if (field != value) {
+            rememberOriginal();
+            field = value;
+            dirtyFields_ |= mask;
+        }
+    }
+    
+    // Знімок перед першою зміною; копія дешева - текст спільний, словникові поля - вказівники
+    void rememberOriginal() {
+        if (dirtyFields_ == 0 && !original_) original_ = std::make_shared<const Listing>(*this);
+    }
+    
+    const ListingText& text() const { return text_ ? *text_ : kEmptyText; }
+    // Власний блок тексту для зміни (копія, якщо блок спільний або ще не створений)
+    ListingText& mutableText();
+    
+    // Ціна в усіх валютах за одним знімком курсів
+    void convertPrice(const RateSnapshot& rates, double& priceUSD, double& priceEUR, double& priceUAH) const;
 };
 
@@ -0,0 +1,28 @@
+// FILE: backend/src/models/ListingFilter.h
+#pragma once
+#include <string>
+#include <vector>
+
+// Фільтр пошуку оголошень. Списки - "будь-яке зі значень" (порожній - без обмеження),
+// межі діапазонів включні, 0 - межа не задана. Ціна - у гривнях (по price_uah).
+struct ListingFilter {
+    std::string searchQuery;
+    std::vector<int> brandIds;
+    std::vector<int> modelIds;
+    std::string region;  // Текст регіону, якщо regionId не визначено довідником
+    int regionId = 0;
+    std::vector<std::string> fuelTypes;
+    std::vector<std::string> transmissions;
+    std::vector<std::string> bodyTypes;
+    std::vector<std::string> colors;
+    double minPriceUah = 0;
+    double maxPriceUah = 0;
+    int minYear = 0;
+    int maxYear = 0;
+    int minMileage = 0;
+    int maxMileage = 0;
+    double minEngineVolume = 0;
+    double maxEngineVolume = 0;
+    int minEnginePower = 0;
+    int maxEnginePower = 0;
+};
@@ -0,0 +1,34 @@
+// FILE: backend/src/models/ListingStatus.h
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Статуси оголошення (порядок збігається з PlatformCounters::kStatusNames)
+enum class ListingStatus : uint8_t {
+    Draft = 0,
+    Pending = 1,
+    Active = 2,
+    Rejected = 3,
+    Inactive = 4,
+    Sold = 5,
+    Other = 6
+};
+
+// Розбір статусу; невідоме значення трактується як Other
+inline ListingStatus parseListingStatus(const std::string& status) {
+    if (status == "active") return ListingStatus::Active;
+    if (status == "pending") return ListingStatus::Pending;
+    if (status == "draft") return ListingStatus::Draft;
+    if (status == "rejected") return ListingStatus::Rejected;
+    if (status == "inactive") return ListingStatus::Inactive;
+    if (status == "sold") return ListingStatus::Sold;
+    return ListingStatus::Other;
+}
+
+// Назва статусу зі статичної таблиці (без алокацій на виклик)
+inline const std::string& listingStatusName(ListingStatus status) {
+    static const std::string kNames[] = {
+        "draft", "pending", "active", "rejected", "inactive", "sold", "other"
+    };
+    return kNames[static_cast<size_t>(status)];
+}
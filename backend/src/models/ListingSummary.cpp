@@ -0,0 +1,55 @@
+// FILE: backend/src/models/ListingSummary.cpp
+#include "ListingSummary.h"
+#include "../services/CurrencyService.h"
+#include "../utils/JsonEscape.h"
+#include <iomanip>
+#include <sstream>
+
+std::string ListingSummary::toJson(double priceUSD, double priceEUR, double priceUAH) const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "{\"id\":" << id
+        << ",\"sellerId\":" << sellerId
+        << ",\"brandId\":" << brandId
+        << ",\"modelId\":" << modelId
+        << ",\"year\":" << year
+        << ",\"price\":" << price
+        << ",\"currency\":\"" << currencyCode(currency) << "\""
+        << ",\"exchangeRate\":" << exchangeRate
+        << ",\"priceUSD\":" << priceUSD
+        << ",\"priceEUR\":" << priceEUR
+        << ",\"priceUAH\":" << priceUAH
+        << ",\"region\":\"" << escapeJson(region) << "\""
+        << ",\"mileage\":" << mileage
+        << ",\"status\":\"" << listingStatusName(status) << "\""
+        << ",\"editCount\":" << editCount
+        << ",\"viewCount\":" << viewCount;
+    if (photo.empty()) {
+        oss << ",\"photos\":[]";
+    } else {
+        oss << ",\"photos\":[\"" << escapeJson(photo) << "\"]";
+    }
+    oss << "}";
+    return oss.str();
+}
+
+Listing::PagePrices ListingSummary::convertPage(const std::vector<ListingSummary>& summaries) {
+    size_t count = summaries.size();
+    std::vector<double> prices(count);
+    std::vector<Currency> currencies(count);
+    std::vector<double> exchangeRates(count);
+    for (size_t i = 0; i < count; ++i) {
+        prices[i] = summaries[i].price;
+        currencies[i] = summaries[i].currency;
+        exchangeRates[i] = summaries[i].exchangeRate;
+    }
+    
+    Listing::PagePrices result;
+    result.usd.resize(count);
+    result.eur.resize(count);
+    result.uah.resize(count);
+    CurrencyService::convertBatch(*CurrencyService::getInstance()->getSnapshot(), count,
+                                  prices.data(), currencies.data(), exchangeRates.data(),
+                                  result.usd.data(), result.eur.data(), result.uah.data());
+    return result;
+}
@@ -0,0 +1,30 @@
+// FILE: backend/src/models/ListingSummary.h
+#pragma once
+#include "Listing.h"
+#include <string>
+#include <vector>
+
+// Картка оголошення для списків (пошук, обране, мої оголошення): лише поля картки,
+// без опису та повного масиву фото - їх віддає детальний ендпоінт (Listing)
+struct ListingSummary {
+    int id = 0;
+    int sellerId = 0;
+    int brandId = 0;
+    int modelId = 0;
+    int year = 0;
+    double price = 0.0;
+    Currency currency = Currency::UAH;
+    double exchangeRate = 0.0;
+    int mileage = 0;
+    std::string region;
+    std::string photo; // Перше фото (порожньо - немає)
+    ListingStatus status = ListingStatus::Draft;
+    int editCount = 0;
+    int viewCount = 0;
+    
+    // Ті самі ключі, що й у Listing::toJson; photos - масив з одним (першим) фото
+    std::string toJson(double priceUSD, double priceEUR, double priceUAH) const;
+    
+    // Пакетна конвертація цін сторінки (один знімок курсів на сторінку)
+    static Listing::PagePrices convertPage(const std::vector<ListingSummary>& summaries);
+};
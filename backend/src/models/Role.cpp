@@ -91,6 +91,8 @@ std::shared_ptr<Role> RoleFactory::createAdministratorRole() {
     role->addPermission(std::make_shared<Permission>("manage_models", "models", "manage"));
     role->addPermission(std::make_shared<Permission>("manage_all_users", "users", "manage_all"));
     role->addPermission(std::make_shared<Permission>("view_statistics", "system", "statistics"));
+    role->addPermission(std::make_shared<Permission>("manage_moderation", "moderation", "manage"));
+    role->addPermission(std::make_shared<Permission>("manage_recommendations", "recommendations", "manage"));
     return role;
 }
 
@@ -1,34 +1,10 @@
 // FILE: backend/src/models/User.cpp
 #include "User.h"
+#include "../utils/JsonEscape.h"
 #include <sstream>
 #include <ctime>
 #include <iomanip>
 
-// Функція для екранування JSON рядків (повторюється з Listing.cpp, можна винести в окремий файл)
-static std::string escapeJson(const std::string& str) {
-    std::ostringstream oss;
-    for (char c : str) {
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') 
-                        << static_cast<int>(static_cast<unsigned char>(c));
-                } else {
-                    oss << c;
-                }
-                break;
-        }
-    }
-    return oss.str();
-}
-
 User::User(int id, const std::string& email, const std::string& passwordHash,
            const std::string& firstName, const std::string& lastName,
            const std::string& phone, const std::string& accountType)
@@ -1,16 +1,50 @@
 // FILE: backend/src/repositories/ListingRepository.cpp
 #include "ListingRepository.h"
+#include "../services/CurrencyService.h"
+#include "../utils/SimHash.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <unordered_map>
+
+// Явний перелік колонок у порядку, який читає createListingFromRow
+// (SELECT * залежить від порядку колонок, доданих міграціями)
+static const std::string kSelectListings =
+    "SELECT l.id, l.seller_id, l.brand_id, l.model_id, l.year, l.price, l.currency, l.exchange_rate, "
+    "l.description, l.region, l.mileage, l.status, l.edit_count, l.view_count, l.created_at, l.updated_at, "
+    "l.last_moderation_date, l.photos, l.fuel_type, l.transmission, l.color, l.engine_volume, l.body_type, "
+    "l.doors_count, l.engine_power, l.simhash, l.region_id FROM listings l";
+
+// Колонки картки (ListingSummary): без description та повного photos.
+// Перше фото - з JSON масиву; невалідний photos дає NULL замість помилки запиту.
+static const std::string kSelectSummaries =
+    "SELECT l.id, l.seller_id, l.brand_id, l.model_id, l.year, l.price, l.currency, l.exchange_rate, "
+    "l.mileage, l.region, l.status, l.edit_count, l.view_count, "
+    "CASE WHEN json_valid(l.photos) THEN json_extract(l.photos, '$[0]') END FROM listings l";
+
+// 0 (регіон поза довідником) зберігається як NULL
+static void bindRegionId(sqlite3_stmt* stmt, int index, int regionId) {
+    if (regionId > 0) {
+        sqlite3_bind_int(stmt, index, regionId);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+// Текст колонки (NULL -> порожній рядок). Рядок обрізається на першому нульовому байті;
+// без sqlite3_column_bytes - кожен виклик sqlite3_column_* бере м'ютекс з'єднання.
+static std::string columnText(sqlite3_stmt* stmt, int column) {
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return text ? std::string(text) : std::string();
+}
 
 ListingRepository::ListingRepository(std::shared_ptr<Database> db) : db_(db) {}
 
 std::unique_ptr<Listing> ListingRepository::findById(int id) {
-    const char* sql = "SELECT * FROM listings WHERE id = ?";
+    const std::string sql = kSelectListings + " WHERE l.id = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(db_->getHandle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_int(stmt, 1, id);
         
         if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -25,10 +59,10 @@ std::unique_ptr<Listing> ListingRepository::findById(int id) {
 
 std::vector<std::unique_ptr<Listing>> ListingRepository::findBySellerId(int sellerId) {
     std::vector<std::unique_ptr<Listing>> listings;
-    const char* sql = "SELECT * FROM listings WHERE seller_id = ?";
+    const std::string sql = kSelectListings + " WHERE l.seller_id = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(db_->getHandle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_int(stmt, 1, sellerId);
         
         while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -44,10 +78,10 @@ std::vector<std::unique_ptr<Listing>> ListingRepository::findBySellerId(int sell
 
 std::vector<std::unique_ptr<Listing>> ListingRepository::findActive() {
     std::vector<std::unique_ptr<Listing>> listings;
-    const char* sql = "SELECT * FROM listings WHERE status = 'active' ORDER BY created_at DESC";
+    const std::string sql = kSelectListings + " WHERE l.status = 'active' ORDER BY l.created_at DESC";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(db_->getHandle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             auto listing = createListingFromRow(stmt);
             if (listing) {
@@ -63,8 +97,12 @@ bool ListingRepository::create(std::unique_ptr<Listing> listing) {
     const char* sql = R"(INSERT INTO listings (seller_id, brand_id, model_id, year, price, 
                 currency, exchange_rate, description, region, mileage, status, edit_count, 
                 view_count, photos, fuel_type, transmission, color, engine_volume, body_type, 
-                doors_count, engine_power, created_at, updated_at) 
-                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?))";
+                doors_count, engine_power, created_at, updated_at, simhash, price_uah, region_id) 
+                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?))";
+    
+    // Відбиток опису та канонічний регіон зберігаються разом з оголошенням
+    listing->setSimHash(simhash::fingerprint(listing->getDescription()));
+    normalizeRegion(*listing);
     
     sqlite3_stmt* stmt;
     if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
@@ -103,19 +141,43 @@ bool ListingRepository::create(std::unique_ptr<Listing> listing) {
         time_t now = time(nullptr);
         sqlite3_bind_int(stmt, 22, now);
         sqlite3_bind_int(stmt, 23, now);
+        if (listing->getSimHash() != 0) {
+            sqlite3_bind_int64(stmt, 24, static_cast<sqlite3_int64>(listing->getSimHash()));
+        } else {
+            sqlite3_bind_null(stmt, 24);
+        }
+        sqlite3_bind_double(stmt, 25, listing->getPriceInUAH());
+        bindRegionId(stmt, 26, listing->getRegionId());
         
         int rc = sqlite3_step(stmt);
+        int newId = static_cast<int>(sqlite3_last_insert_rowid(db_->getHandle()));
         sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
+        if (rc != SQLITE_DONE) {
+            return false;
+        }
+        if (!observers_.empty()) {
+            auto created = findById(newId);
+            notifyObservers(nullptr, created.get());
+        }
+        return true;
     }
     return false;
 }
 
 bool ListingRepository::update(std::unique_ptr<Listing> listing) {
+    // Попередній стан потрібен спостерігачам (зміна статусу, індекси)
+    std::unique_ptr<Listing> before;
+    if (!observers_.empty()) {
+        before = findById(listing->getId());
+    }
+    
     const char* sql = R"(UPDATE listings SET brand_id=?, model_id=?, year=?, price=?, 
                 currency=?, exchange_rate=?, description=?, region=?, mileage=?, 
                 status=?, edit_count=?, photos=?, fuel_type=?, transmission=?, color=?, 
-                engine_volume=?, body_type=?, doors_count=?, engine_power=?, updated_at=? WHERE id=?)";
+                engine_volume=?, body_type=?, doors_count=?, engine_power=?, updated_at=?, simhash=?, price_uah=?, region_id=? WHERE id=?)";
+    
+    listing->setSimHash(simhash::fingerprint(listing->getDescription()));
+    normalizeRegion(*listing);
     
     sqlite3_stmt* stmt;
     if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
@@ -151,16 +213,147 @@ bool ListingRepository::update(std::unique_ptr<Listing> listing) {
         
         time_t now = time(nullptr);
         sqlite3_bind_int(stmt, 20, now);
-        sqlite3_bind_int(stmt, 21, listing->getId());
+        if (listing->getSimHash() != 0) {
+            sqlite3_bind_int64(stmt, 21, static_cast<sqlite3_int64>(listing->getSimHash()));
+        } else {
+            sqlite3_bind_null(stmt, 21);
+        }
+        sqlite3_bind_double(stmt, 22, listing->getPriceInUAH());
+        bindRegionId(stmt, 23, listing->getRegionId());
+        sqlite3_bind_int(stmt, 24, listing->getId());
         
         int rc = sqlite3_step(stmt);
         sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
+        if (rc != SQLITE_DONE) {
+            return false;
+        }
+        if (before) {
+            // Повний перезапис - для спостерігачів змінилось усе
+            listing->markDirty(ListingField::All);
+            notifyObservers(before.get(), listing.get());
+        }
+        return true;
     }
     return false;
 }
 
+// Колонки в порядку бітів ListingField::Mask
+static const char* const kListingFieldColumns[] = {
+    "brand_id", "model_id", "year", "price", "currency", "exchange_rate", "description", "region",
+    "mileage", "status", "edit_count", "view_count", "last_moderation_date", "photos", "fuel_type",
+    "transmission", "color", "engine_volume", "body_type", "doors_count", "engine_power", "simhash",
+    "region_id"
+};
+
+std::vector<std::string> ListingRepository::fieldNames(uint32_t fields) {
+    std::vector<std::string> names;
+    for (size_t bit = 0; bit < sizeof(kListingFieldColumns) / sizeof(kListingFieldColumns[0]); ++bit) {
+        if (fields & (1u << bit)) {
+            names.push_back(kListingFieldColumns[bit]);
+        }
+    }
+    return names;
+}
+
+// Поля, від яких залежить збережена price_uah
+static const uint32_t kPriceFields = ListingField::Price | ListingField::Currency | ListingField::ExchangeRate;
+
+static void bindText(sqlite3_stmt* stmt, int index, const std::string& value) {
+    sqlite3_bind_text(stmt, index, value.c_str(), static_cast<int>(value.length()), SQLITE_TRANSIENT);
+}
+
+bool ListingRepository::updateFields(Listing& listing) {
+    if (listing.getDirtyFields() & ListingField::Description) {
+        listing.setSimHash(simhash::fingerprint(listing.getDescription()));
+    }
+    if (listing.getDirtyFields() & ListingField::Region) {
+        normalizeRegion(listing);
+    }
+    uint32_t dirty = listing.getDirtyFields();
+    if (dirty == 0) return true;
+    
+    // Знімок "до" - з самого оголошення; з БД лише якщо поля позначено без сеттерів
+    const Listing* before = listing.getOriginal();
+    std::unique_ptr<Listing> loaded;
+    if (!before && !observers_.empty()) {
+        loaded = findById(listing.getId());
+        before = loaded.get();
+    }
+    
+    std::ostringstream sql;
+    sql << "UPDATE listings SET ";
+    for (const std::string& column : fieldNames(dirty)) {
+        sql << column << " = ?, ";
+    }
+    const bool priceChanged = (dirty & kPriceFields) != 0;
+    if (priceChanged) {
+        sql << "price_uah = ?, ";
+    }
+    sql << "updated_at = ? WHERE id = ?";
+    
+    sqlite3_stmt* stmt;
+    const std::string sqlStr = sql.str();
+    if (sqlite3_prepare_v2(db_->getHandle(), sqlStr.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    
+    // Біндимо в тому ж порядку бітів, що й колонки
+    int index = 1;
+    if (dirty & ListingField::BrandId) sqlite3_bind_int(stmt, index++, listing.getBrandId());
+    if (dirty & ListingField::ModelId) sqlite3_bind_int(stmt, index++, listing.getModelId());
+    if (dirty & ListingField::Year) sqlite3_bind_int(stmt, index++, listing.getYear());
+    if (dirty & ListingField::Price) sqlite3_bind_double(stmt, index++, listing.getPrice());
+    if (dirty & ListingField::Currency) bindText(stmt, index++, listing.getCurrency());
+    if (dirty & ListingField::ExchangeRate) sqlite3_bind_double(stmt, index++, listing.getExchangeRate());
+    if (dirty & ListingField::Description) bindText(stmt, index++, listing.getDescription());
+    if (dirty & ListingField::Region) bindText(stmt, index++, listing.getRegion());
+    if (dirty & ListingField::Mileage) sqlite3_bind_int(stmt, index++, listing.getMileage());
+    if (dirty & ListingField::Status) bindText(stmt, index++, listing.getStatus());
+    if (dirty & ListingField::EditCount) sqlite3_bind_int(stmt, index++, listing.getEditCount());
+    if (dirty & ListingField::ViewCount) sqlite3_bind_int(stmt, index++, listing.getViewCount());
+    if (dirty & ListingField::LastModerationDate) {
+        sqlite3_bind_int64(stmt, index++, static_cast<sqlite3_int64>(listing.getLastModerationDate()));
+    }
+    if (dirty & ListingField::Photos) bindText(stmt, index++, listing.getPhotos());
+    if (dirty & ListingField::FuelType) bindText(stmt, index++, listing.getFuelType());
+    if (dirty & ListingField::Transmission) bindText(stmt, index++, listing.getTransmission());
+    if (dirty & ListingField::Color) bindText(stmt, index++, listing.getColor());
+    if (dirty & ListingField::EngineVolume) sqlite3_bind_double(stmt, index++, listing.getEngineVolume());
+    if (dirty & ListingField::BodyType) bindText(stmt, index++, listing.getBodyType());
+    if (dirty & ListingField::DoorsCount) sqlite3_bind_int(stmt, index++, listing.getDoorsCount());
+    if (dirty & ListingField::EnginePower) sqlite3_bind_int(stmt, index++, listing.getEnginePower());
+    if (dirty & ListingField::SimHash) {
+        if (listing.getSimHash() != 0) {
+            sqlite3_bind_int64(stmt, index++, static_cast<sqlite3_int64>(listing.getSimHash()));
+        } else {
+            sqlite3_bind_null(stmt, index++);
+        }
+    }
+    if (dirty & ListingField::RegionId) bindRegionId(stmt, index++, listing.getRegionId());
+    if (priceChanged) {
+        sqlite3_bind_double(stmt, index++, listing.getPriceInUAH());
+    }
+    sqlite3_bind_int64(stmt, index++, static_cast<sqlite3_int64>(time(nullptr)));
+    sqlite3_bind_int(stmt, index++, listing.getId());
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        return false;
+    }
+    if (before && !observers_.empty()) {
+        notifyObservers(before, &listing);
+    }
+    listing.clearDirtyFields();
+    return true;
+}
+
 bool ListingRepository::deleteListing(int id) {
+    std::unique_ptr<Listing> before;
+    if (!observers_.empty()) {
+        before = findById(id);
+    }
+    
     const char* sql = "DELETE FROM listings WHERE id = ?";
     sqlite3_stmt* stmt;
     
@@ -168,17 +361,23 @@ bool ListingRepository::deleteListing(int id) {
         sqlite3_bind_int(stmt, 1, id);
         int rc = sqlite3_step(stmt);
         sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
+        if (rc != SQLITE_DONE) {
+            return false;
+        }
+        if (before) {
+            notifyObservers(before.get(), nullptr);
+        }
+        return true;
     }
     return false;
 }
 
 std::vector<std::unique_ptr<Listing>> ListingRepository::findByStatus(const std::string& status) {
     std::vector<std::unique_ptr<Listing>> listings;
-    const char* sql = "SELECT * FROM listings WHERE status = ?";
+    const std::string sql = kSelectListings + " WHERE l.status = ?";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(db_->getHandle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, status.c_str(), -1, SQLITE_TRANSIENT);
         
         while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -192,6 +391,75 @@ std::vector<std::unique_ptr<Listing>> ListingRepository::findByStatus(const std:
     return listings;
 }
 
+std::vector<std::unique_ptr<Listing>> ListingRepository::findByIds(const std::vector<int>& ids) {
+    std::vector<std::unique_ptr<Listing>> listings;
+    if (ids.empty()) return listings;
+    
+    std::ostringstream sql;
+    sql << kSelectListings << " WHERE l.id IN (";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        sql << (i > 0 ? ",?" : "?");
+    }
+    sql << ")";
+    
+    std::unordered_map<int, std::unique_ptr<Listing>> byId;
+    sqlite3_stmt* stmt;
+    const std::string sqlStr = sql.str();
+    if (sqlite3_prepare_v2(db_->getHandle(), sqlStr.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            sqlite3_bind_int(stmt, static_cast<int>(i + 1), ids[i]);
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto listing = createListingFromRow(stmt);
+            if (listing) {
+                int id = listing->getId();
+                byId[id] = std::move(listing);
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+    
+    for (int id : ids) {
+        auto it = byId.find(id);
+        if (it != byId.end() && it->second) {
+            listings.push_back(std::move(it->second));
+        }
+    }
+    return listings;
+}
+
+void ListingRepository::setRegionDirectory(std::shared_ptr<RegionDirectory> regions) {
+    regions_ = regions;
+}
+
+void ListingRepository::normalizeRegion(Listing& listing) {
+    if (!regions_) return;
+    int regionId = regions_->resolve(listing.getRegion());
+    listing.setRegionId(regionId);
+    if (regionId > 0) {
+        listing.setRegion(regions_->name(regionId));
+    }
+}
+
+bool ListingRepository::backfillPriceUah() {
+    // Та сама формула, що й CurrencyService::convertBatch: збережений курс для USD/EUR,
+    // інакше - актуальний курс зі знімка; UAH та невідомі коди - 1:1
+    auto rates = CurrencyService::getInstance()->getSnapshot();
+    const char* sql = "UPDATE listings SET price_uah = price * CASE "
+                      "WHEN currency IN ('USD', 'EUR') AND exchange_rate > 0 THEN exchange_rate "
+                      "WHEN currency = 'USD' THEN ? WHEN currency = 'EUR' THEN ? ELSE 1 END "
+                      "WHERE price_uah IS NULL";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_double(stmt, 1, rates->toUah[static_cast<size_t>(Currency::USD)]);
+    sqlite3_bind_double(stmt, 2, rates->toUah[static_cast<size_t>(Currency::EUR)]);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
 bool ListingRepository::incrementViewCount(int listingId) {
     const char* sql = "UPDATE listings SET view_count = view_count + 1 WHERE id = ?";
     sqlite3_stmt* stmt;
@@ -205,143 +473,96 @@ bool ListingRepository::incrementViewCount(int listingId) {
     return false;
 }
 
-std::unique_ptr<Listing> ListingRepository::createListingFromRow(sqlite3_stmt* stmt) {
-    int id = sqlite3_column_int(stmt, 0);
-    int sellerId = sqlite3_column_int(stmt, 1);
-    int brandId = sqlite3_column_int(stmt, 2);
-    int modelId = sqlite3_column_int(stmt, 3);
-    int year = sqlite3_column_int(stmt, 4);
-    double price = sqlite3_column_double(stmt, 5);
-    // Читаємо currency з правильним обробкою UTF-8
-    const unsigned char* currencyText = sqlite3_column_text(stmt, 6);
-    std::string currency;
-    if (currencyText) {
-        currency = reinterpret_cast<const char*>(currencyText);
-    } else {
-        currency = "";
-    }
-    double exchangeRate = sqlite3_column_double(stmt, 7);
-    // Безпечне читання description з перевіркою на NULL
-    const unsigned char* descText = sqlite3_column_text(stmt, 8);
-    std::string description;
-    if (descText) {
-        // SQLite повертає UTF-8 рядок, який правильно закінчується на \0
-        description = reinterpret_cast<const char*>(descText);
-        // Видаляємо тільки нульові байти всередині рядка (якщо такі є)
-        description.erase(std::remove(description.begin(), description.end(), '\0'), description.end());
-    } else {
-        description = "";
-    }
-    
-    // Читаємо region з бази даних
-    const unsigned char* regionText = sqlite3_column_text(stmt, 9);
-    std::string region;
-    if (regionText) {
-        // SQLite повертає UTF-8 рядок, який правильно закінчується на \0
-        region = reinterpret_cast<const char*>(regionText);
-        // Видаляємо тільки нульові байти всередині рядка (якщо такі є)
-        region.erase(std::remove(region.begin(), region.end(), '\0'), region.end());
-    } else {
-        region = "";
+bool ListingRepository::updateStatus(int listingId, const std::string& status, time_t moderationDate) {
+    std::unique_ptr<Listing> before;
+    if (!observers_.empty()) {
+        before = findById(listingId);
     }
     
-    int mileage = sqlite3_column_int(stmt, 10);
-    
-    auto listing = std::make_unique<Listing>(id, sellerId, brandId, modelId, year,
-                                             price, currency, exchangeRate,
-                                             description, region, mileage);
-    
-    // Читаємо status з правильним обробкою UTF-8
-    const unsigned char* statusText = sqlite3_column_text(stmt, 11);
-    std::string status;
-    if (statusText) {
-        status = reinterpret_cast<const char*>(statusText);
-    } else {
-        status = "";
-    }
-    listing->setStatus(status);
-    
-    int editCount = sqlite3_column_int(stmt, 12);
-    for (int i = 0; i < editCount; i++) {
-        listing->incrementEditCount();
-    }
-    
-    int viewCount = sqlite3_column_int(stmt, 13);
-    for (int i = 0; i < viewCount; i++) {
-        listing->incrementViewCount();
-    }
-    
-    // Читаємо photos та додаткові поля
-    int colCount = sqlite3_column_count(stmt);
-    if (colCount > 17) {
-        const unsigned char* photosText = sqlite3_column_text(stmt, 17);
-        if (photosText) {
-            std::string photosStr = reinterpret_cast<const char*>(photosText);
-            // Перевіряємо, чи це валідний JSON масив
-            if (photosStr.length() >= 2 && photosStr[0] == '[' && photosStr[photosStr.length() - 1] == ']') {
-                listing->setPhotos(photosStr);
-            } else {
-                // Якщо невалідний JSON, встановлюємо порожній масив
-                listing->setPhotos("[]");
-            }
-        } else {
-            listing->setPhotos("[]");
-        }
-    } else {
-        listing->setPhotos("[]");
-    }
+    const char* sql = "UPDATE listings SET status = ?, last_moderation_date = ? WHERE id = ?";
+    sqlite3_stmt* stmt;
     
-    // Додаткові характеристики (якщо є)
-    if (colCount > 18) {
-        const unsigned char* fuelTypeText = sqlite3_column_text(stmt, 18);
-        if (fuelTypeText) {
-            std::string fuelType = reinterpret_cast<const char*>(fuelTypeText);
-            if (!fuelType.empty()) {
-                listing->setFuelType(fuelType);
-            }
-        }
-    }
-    if (colCount > 19) {
-        const unsigned char* transmissionText = sqlite3_column_text(stmt, 19);
-        if (transmissionText) {
-            std::string transmission = reinterpret_cast<const char*>(transmissionText);
-            if (!transmission.empty()) {
-                listing->setTransmission(transmission);
-            }
-        }
-    }
-    if (colCount > 20) {
-        const unsigned char* colorText = sqlite3_column_text(stmt, 20);
-        if (colorText) {
-            std::string color = reinterpret_cast<const char*>(colorText);
-            if (!color.empty()) {
-                listing->setColor(color);
-            }
+    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, status.c_str(), static_cast<int>(status.length()), SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, moderationDate);
+        sqlite3_bind_int(stmt, 3, listingId);
+        int rc = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) {
+            return false;
         }
-    }
-    if (colCount > 21) {
-        double engineVolume = sqlite3_column_double(stmt, 21);
-        if (engineVolume > 0) listing->setEngineVolume(engineVolume);
-    }
-    if (colCount > 22) {
-        const unsigned char* bodyTypeText = sqlite3_column_text(stmt, 22);
-        if (bodyTypeText) {
-            std::string bodyType = reinterpret_cast<const char*>(bodyTypeText);
-            if (!bodyType.empty()) {
-                listing->setBodyType(bodyType);
-            }
+        if (before) {
+            Listing after(*before);
+            after.setStatus(status);
+            after.setLastModerationDate(moderationDate);
+            notifyObservers(before.get(), &after);
         }
+        return true;
     }
-    if (colCount > 23) {
-        int doorsCount = sqlite3_column_int(stmt, 23);
-        if (doorsCount > 0) listing->setDoorsCount(doorsCount);
+    return false;
+}
+
+void ListingRepository::addObserver(std::shared_ptr<IListingObserver> observer) {
+    if (observer) {
+        observers_.push_back(std::move(observer));
     }
-    if (colCount > 24) {
-        int enginePower = sqlite3_column_int(stmt, 24);
-        if (enginePower > 0) listing->setEnginePower(enginePower);
+}
+
+void ListingRepository::publishStatusChange(int listingId, const std::string& previousStatus) {
+    if (observers_.empty()) return;
+    
+    auto after = findById(listingId);
+    if (!after || after->getStatus() == previousStatus) return;
+    Listing before(*after);
+    before.setStatus(previousStatus);
+    notifyObservers(&before, after.get());
+}
+
+void ListingRepository::notifyObservers(const Listing* before, const Listing* after) {
+    if (!before && !after) return;
+    for (const auto& observer : observers_) {
+        observer->onListingChanged(before, after);
     }
-    
-    return listing;
+}
+
+std::unique_ptr<Listing> ListingRepository::createListingFromRow(sqlite3_stmt* stmt) {
+    // Індекси - позиції в kSelectListings
+    ListingState state;
+    state.id = sqlite3_column_int(stmt, 0);
+    state.sellerId = sqlite3_column_int(stmt, 1);
+    state.brandId = sqlite3_column_int(stmt, 2);
+    state.modelId = sqlite3_column_int(stmt, 3);
+    state.year = sqlite3_column_int(stmt, 4);
+    state.price = sqlite3_column_double(stmt, 5);
+    state.currency = parseCurrency(columnText(stmt, 6));
+    state.exchangeRate = sqlite3_column_double(stmt, 7);
+    state.description = columnText(stmt, 8);
+    state.region = columnText(stmt, 9);
+    state.mileage = sqlite3_column_int(stmt, 10);
+    state.status = columnText(stmt, 11);
+    state.editCount = sqlite3_column_int(stmt, 12);
+    state.viewCount = sqlite3_column_int(stmt, 13);
+    state.createdAt = static_cast<time_t>(sqlite3_column_int64(stmt, 14));
+    state.updatedAt = static_cast<time_t>(sqlite3_column_int64(stmt, 15));
+    state.lastModerationDate = static_cast<time_t>(sqlite3_column_int64(stmt, 16));
+    
+    // Лише валідний JSON масив, інакше - порожній
+    state.photos = columnText(stmt, 17);
+    if (state.photos.length() < 2 || state.photos.front() != '[' || state.photos.back() != ']') {
+        state.photos = "[]";
+    }
+    
+    state.fuelType = columnText(stmt, 18);
+    state.transmission = columnText(stmt, 19);
+    state.color = columnText(stmt, 20);
+    state.engineVolume = std::max(0.0, sqlite3_column_double(stmt, 21));
+    state.bodyType = columnText(stmt, 22);
+    state.doorsCount = std::max(0, sqlite3_column_int(stmt, 23));
+    state.enginePower = std::max(0, sqlite3_column_int(stmt, 24));
+    state.simHash = static_cast<uint64_t>(sqlite3_column_int64(stmt, 25)); // NULL -> 0
+    state.regionId = sqlite3_column_int(stmt, 26); // NULL -> 0
+    
+    return std::make_unique<Listing>(std::move(state));
 }
 
 std::vector<std::unique_ptr<Listing>> ListingRepository::searchAndFilter(
@@ -358,121 +579,288 @@ std::vector<std::unique_ptr<Listing>> ListingRepository::searchAndFilter(
     int limit,
     int offset
 ) {
+    ListingFilter filter;
+    filter.searchQuery = searchQuery;
+    if (brandId > 0) filter.brandIds.push_back(brandId);
+    if (modelId > 0) filter.modelIds.push_back(modelId);
+    filter.minPriceUah = minPrice;
+    filter.maxPriceUah = maxPrice;
+    filter.region = region;
+    if (!fuelType.empty()) filter.fuelTypes.push_back(fuelType);
+    if (!transmission.empty()) filter.transmissions.push_back(transmission);
+    
     std::vector<std::unique_ptr<Listing>> listings;
+    sqlite3_stmt* stmt = prepareSearch(db_->getHandle(), kSelectListings, filter, sortBy, sortOrder, limit, offset);
+    if (!stmt) return listings;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        auto listing = createListingFromRow(stmt);
+        if (listing) {
+            listings.push_back(std::move(listing));
+        }
+    }
+    sqlite3_finalize(stmt);
+    return listings;
+}
+
+std::vector<ListingSummary> ListingRepository::searchSummaries(
+    const ListingFilter& filter,
+    const std::string& sortBy,
+    const std::string& sortOrder,
+    int limit,
+    int offset
+) {
+    std::vector<ListingSummary> summaries;
+    sqlite3_stmt* stmt = prepareSearch(db_->getHandle(), kSelectSummaries, filter, sortBy, sortOrder, limit, offset);
+    if (!stmt) return summaries;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        summaries.push_back(createSummaryFromRow(stmt));
+    }
+    sqlite3_finalize(stmt);
+    return summaries;
+}
+
+std::vector<int> ListingRepository::searchIds(
+    const ListingFilter& filter,
+    const std::string& sortBy,
+    const std::string& sortOrder,
+    int limit,
+    int offset
+) {
+    std::vector<int> ids;
+    sqlite3_stmt* stmt = prepareSearch(db_->getHandle(), "SELECT l.id FROM listings l", filter, sortBy, sortOrder,
+                                       limit, offset);
+    if (!stmt) return ids;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        ids.push_back(sqlite3_column_int(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    return ids;
+}
+
+long long ListingRepository::countSearch(Database& db, const ListingFilter& filter) {
+    sqlite3_stmt* stmt = prepareSearch(db.getHandle(), "SELECT COUNT(*) FROM listings l", filter, "", "", -1, 0);
+    if (!stmt) return -1;
+    long long count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+std::vector<ListingSummary> ListingRepository::findActiveSummaries() {
+    return querySummaries(kSelectSummaries + " WHERE l.status = 'active' ORDER BY l.created_at DESC", 0);
+}
+
+std::vector<ListingSummary> ListingRepository::findSummariesBySellerId(int sellerId) {
+    return querySummaries(kSelectSummaries + " WHERE l.seller_id = ?", sellerId);
+}
+
+std::vector<ListingSummary> ListingRepository::findSummariesByIds(const std::vector<int>& ids) {
+    std::vector<ListingSummary> summaries;
+    if (ids.empty()) return summaries;
     
-    // Побудова динамічного SQL запиту
     std::ostringstream sql;
-    sql << "SELECT l.* FROM listings l WHERE l.status = 'active'";
-    
-    std::vector<std::string> conditions;
-    std::vector<std::string> bindValues;
-    
-    if (!searchQuery.empty()) {
-        conditions.push_back("(l.description LIKE ? OR l.region LIKE ?)");
-        bindValues.push_back("%" + searchQuery + "%");
-        bindValues.push_back("%" + searchQuery + "%");
+    sql << kSelectSummaries << " WHERE l.id IN (";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        sql << (i > 0 ? ",?" : "?");
     }
+    sql << ")";
     
-    if (brandId > 0) {
-        conditions.push_back("l.brand_id = ?");
-        bindValues.push_back(std::to_string(brandId));
+    std::unordered_map<int, size_t> byId;
+    std::vector<ListingSummary> rows;
+    sqlite3_stmt* stmt;
+    const std::string sqlStr = sql.str();
+    if (sqlite3_prepare_v2(db_->getHandle(), sqlStr.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            sqlite3_bind_int(stmt, static_cast<int>(i + 1), ids[i]);
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            rows.push_back(createSummaryFromRow(stmt));
+            byId[rows.back().id] = rows.size() - 1;
+        }
     }
+    sqlite3_finalize(stmt);
     
-    if (modelId > 0) {
-        conditions.push_back("l.model_id = ?");
-        bindValues.push_back(std::to_string(modelId));
+    summaries.reserve(rows.size());
+    for (int id : ids) {
+        auto it = byId.find(id);
+        if (it != byId.end()) {
+            summaries.push_back(std::move(rows[it->second]));
+            byId.erase(it);
+        }
     }
-    
-    if (minPrice > 0) {
-        conditions.push_back("l.price >= ?");
-        bindValues.push_back(std::to_string(minPrice));
+    return summaries;
+}
+
+std::vector<ListingSummary> ListingRepository::querySummaries(const std::string& sql, int param) {
+    std::vector<ListingSummary> summaries;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_->getHandle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_bind_parameter_count(stmt) > 0) {
+            sqlite3_bind_int(stmt, 1, param);
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            summaries.push_back(createSummaryFromRow(stmt));
+        }
     }
+    sqlite3_finalize(stmt);
+    return summaries;
+}
+
+ListingSummary ListingRepository::createSummaryFromRow(sqlite3_stmt* stmt) {
+    // Індекси - позиції в kSelectSummaries
+    ListingSummary summary;
+    summary.id = sqlite3_column_int(stmt, 0);
+    summary.sellerId = sqlite3_column_int(stmt, 1);
+    summary.brandId = sqlite3_column_int(stmt, 2);
+    summary.modelId = sqlite3_column_int(stmt, 3);
+    summary.year = sqlite3_column_int(stmt, 4);
+    summary.price = sqlite3_column_double(stmt, 5);
+    summary.currency = parseCurrency(columnText(stmt, 6));
+    summary.exchangeRate = sqlite3_column_double(stmt, 7);
+    summary.mileage = sqlite3_column_int(stmt, 8);
+    summary.region = columnText(stmt, 9);
+    summary.status = parseListingStatus(columnText(stmt, 10));
+    summary.editCount = sqlite3_column_int(stmt, 11);
+    summary.viewCount = sqlite3_column_int(stmt, 12);
+    summary.photo = columnText(stmt, 13);
+    return summary;
+}
+
+sqlite3_stmt* ListingRepository::prepareSearch(
+    sqlite3* handle,
+    const std::string& select,
+    const ListingFilter& filter,
+    const std::string& sortBy,
+    const std::string& sortOrder,
+    int limit,
+    int offset
+) {
+    // Побудова динамічного SQL запиту
+    std::ostringstream sql;
+    sql << select << " WHERE l.status = 'active'";
+    
+    // Значення для bind у порядку появи "?"
+    struct BindValue {
+        int type; // SQLITE_TEXT, SQLITE_INTEGER або SQLITE_FLOAT
+        std::string text;
+        double number;
+    };
+    std::vector<std::string> conditions;
+    std::vector<BindValue> bindValues;
+    auto bindText = [&bindValues](const std::string& value) { bindValues.push_back({SQLITE_TEXT, value, 0}); };
+    auto bindInt = [&bindValues](int value) { bindValues.push_back({SQLITE_INTEGER, "", static_cast<double>(value)}); };
+    auto bindNumber = [&bindValues](double value) { bindValues.push_back({SQLITE_FLOAT, "", value}); };
+    
+    // Список значень - "column IN (?, ?, ...)"
+    auto addIn = [&](const std::string& column, size_t count) {
+        std::string condition = column + " IN (";
+        for (size_t i = 0; i < count; ++i) {
+            condition += i > 0 ? ",?" : "?";
+        }
+        conditions.push_back(condition + ")");
+    };
+    auto addIntIn = [&](const std::string& column, const std::vector<int>& values) {
+        if (values.empty()) return;
+        addIn(column, values.size());
+        for (int value : values) bindInt(value);
+    };
+    auto addTextIn = [&](const std::string& column, const std::vector<std::string>& values) {
+        if (values.empty()) return;
+        addIn(column, values.size());
+        for (const auto& value : values) bindText(value);
+    };
+    // Включні межі; 0 - межа не задана
+    auto addRange = [&](const std::string& column, double min, double max) {
+        if (min > 0) {
+            conditions.push_back(column + " >= ?");
+            bindNumber(min);
+        }
+        if (max > 0) {
+            conditions.push_back(column + " <= ?");
+            bindNumber(max);
+        }
+    };
     
-    if (maxPrice > 0) {
-        conditions.push_back("l.price <= ?");
-        bindValues.push_back(std::to_string(maxPrice));
+    if (!filter.searchQuery.empty()) {
+        conditions.push_back("(l.description LIKE ? OR l.region LIKE ?)");
+        bindText("%" + filter.searchQuery + "%");
+        bindText("%" + filter.searchQuery + "%");
     }
     
-    if (!region.empty()) {
-        conditions.push_back("l.region LIKE ?");
-        bindValues.push_back("%" + region + "%");
-    }
+    addIntIn("l.brand_id", filter.brandIds);
+    addIntIn("l.model_id", filter.modelIds);
     
-    if (!fuelType.empty()) {
-        conditions.push_back("l.fuel_type = ?");
-        bindValues.push_back(fuelType);
-    }
+    // Межі ціни - у гривнях, по збереженій price_uah (індекс status, price_uah)
+    addRange("l.price_uah", filter.minPriceUah, filter.maxPriceUah);
     
-    if (!transmission.empty()) {
-        conditions.push_back("l.transmission = ?");
-        bindValues.push_back(transmission);
+    // Регіон з довідника - рівність по region_id (індекс region_id, status, price_uah);
+    // написання поза довідником шукаємо в тексті, як раніше
+    int regionId = filter.regionId;
+    if (regionId == 0 && !filter.region.empty() && regions_) {
+        regionId = regions_->resolve(filter.region);
     }
+    if (regionId > 0) {
+        conditions.push_back("l.region_id = ?");
+        bindInt(regionId);
+    } else if (!filter.region.empty()) {
+        conditions.push_back("l.region LIKE ?");
+        bindText("%" + filter.region + "%");
+    }
+    
+    addTextIn("l.fuel_type", filter.fuelTypes);
+    addTextIn("l.transmission", filter.transmissions);
+    addTextIn("l.body_type", filter.bodyTypes);
+    addTextIn("l.color", filter.colors);
+    addRange("l.year", filter.minYear, filter.maxYear);
+    addRange("l.mileage", filter.minMileage, filter.maxMileage);
+    addRange("l.engine_volume", filter.minEngineVolume, filter.maxEngineVolume);
+    addRange("l.engine_power", filter.minEnginePower, filter.maxEnginePower);
     
     // Додаємо умови до SQL
     for (const auto& condition : conditions) {
         sql << " AND " << condition;
     }
     
-    // Валідація sortBy для безпеки
-    std::string validSortBy = sortBy;
-    if (sortBy != "price" && sortBy != "created_at" && sortBy != "mileage" && sortBy != "view_count" && sortBy != "year") {
-        validSortBy = "created_at";
-    }
-    
-    // Валідація sortOrder
-    std::string validSortOrder = (sortOrder == "ASC" || sortOrder == "asc") ? "ASC" : "DESC";
-    
-    sql << " ORDER BY l." << validSortBy << " " << validSortOrder;
-    sql << " LIMIT ? OFFSET ?";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_->getHandle(), sql.str().c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-        int bindIndex = 1;
-        
-        // Біндимо значення для пошуку
-        if (!searchQuery.empty()) {
-            std::string searchPattern1 = "%" + searchQuery + "%";
-            std::string searchPattern2 = "%" + searchQuery + "%";
-            sqlite3_bind_text(stmt, bindIndex++, searchPattern1.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, bindIndex++, searchPattern2.c_str(), -1, SQLITE_TRANSIENT);
+    // Підрахунок (limit < 0) - без сортування і сторінки
+    if (limit >= 0) {
+        // Валідація sortBy для безпеки
+        std::string validSortBy = sortBy;
+        if (sortBy != "price" && sortBy != "created_at" && sortBy != "mileage" && sortBy != "view_count" && sortBy != "year") {
+            validSortBy = "created_at";
         }
         
-        // Біндимо інші параметри
-        if (brandId > 0) {
-            sqlite3_bind_int(stmt, bindIndex++, brandId);
-        }
-        if (modelId > 0) {
-            sqlite3_bind_int(stmt, bindIndex++, modelId);
-        }
-        if (minPrice > 0) {
-            sqlite3_bind_double(stmt, bindIndex++, minPrice);
-        }
-        if (maxPrice > 0) {
-            sqlite3_bind_double(stmt, bindIndex++, maxPrice);
-        }
-        if (!region.empty()) {
-            std::string regionPattern = "%" + region + "%";
-            sqlite3_bind_text(stmt, bindIndex++, regionPattern.c_str(), -1, SQLITE_TRANSIENT);
-        }
-        if (!fuelType.empty()) {
-            sqlite3_bind_text(stmt, bindIndex++, fuelType.c_str(), -1, SQLITE_TRANSIENT);
-        }
-        if (!transmission.empty()) {
-            sqlite3_bind_text(stmt, bindIndex++, transmission.c_str(), -1, SQLITE_TRANSIENT);
+        // Валідація sortOrder
+        std::string validSortOrder = (sortOrder == "ASC" || sortOrder == "asc") ? "ASC" : "DESC";
+        
+        // Ціни в різних валютах порівнюються в гривнях
+        if (validSortBy == "price") {
+            validSortBy = "price_uah";
         }
         
-        // Біндимо limit та offset
+        sql << " ORDER BY l." << validSortBy << " " << validSortOrder;
+        sql << " LIMIT ? OFFSET ?";
+    }
+    
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, sql.str().c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    int bindIndex = 1;
+    for (const auto& value : bindValues) {
+        if (value.type == SQLITE_TEXT) {
+            sqlite3_bind_text(stmt, bindIndex++, value.text.c_str(), -1, SQLITE_TRANSIENT);
+        } else if (value.type == SQLITE_INTEGER) {
+            sqlite3_bind_int(stmt, bindIndex++, static_cast<int>(value.number));
+        } else {
+            sqlite3_bind_double(stmt, bindIndex++, value.number);
+        }
+    }
+    
+    // Біндимо limit та offset
+    if (limit >= 0) {
         sqlite3_bind_int(stmt, bindIndex++, limit);
         sqlite3_bind_int(stmt, bindIndex++, offset);
-        
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            auto listing = createListingFromRow(stmt);
-            if (listing) {
-                listings.push_back(std::move(listing));
-            }
-        }
     }
-    sqlite3_finalize(stmt);
-    return listings;
+    return stmt;
 }
 
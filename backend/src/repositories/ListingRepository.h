@@ -1,10 +1,21 @@
 // FILE: backend/src/repositories/ListingRepository.h
 #pragma once
 #include "../models/Listing.h"
+#include "../models/ListingSummary.h"
+#include "../models/ListingFilter.h"
 #include "../database/Database.h"
+#include "../services/RegionDirectory.h"
 #include <memory>
 #include <vector>
 
+// Інтерфейс спостерігача за змінами оголошень (лічильники, індекси, кеші)
+class IListingObserver {
+public:
+    virtual ~IListingObserver() = default;
+    // before == nullptr - створення, after == nullptr - видалення
+    virtual void onListingChanged(const Listing* before, const Listing* after) = 0;
+};
+
 // Інтерфейс для репозиторію оголошень
 class IListingRepository {
 public:
@@ -21,6 +32,8 @@ public:
 class ListingRepository : public IListingRepository {
 private:
     std::shared_ptr<Database> db_;
+    std::vector<std::shared_ptr<IListingObserver>> observers_;
+    std::shared_ptr<RegionDirectory> regions_; // nullptr - регіон зберігається як є
 
 public:
     ListingRepository(std::shared_ptr<Database> db);
@@ -35,9 +48,36 @@ public:
     
     // Додаткові методи
     std::vector<std::unique_ptr<Listing>> findByStatus(const std::string& status);
+    // Пакетне завантаження одним запитом; порядок результату - як у ids
+    std::vector<std::unique_ptr<Listing>> findByIds(const std::vector<int>& ids);
+    // Картки для списків (вузька вибірка колонок, без опису)
+    std::vector<ListingSummary> findActiveSummaries();
+    std::vector<ListingSummary> findSummariesBySellerId(int sellerId);
+    // Порядок результату - як у ids
+    std::vector<ListingSummary> findSummariesByIds(const std::vector<int>& ids);
+    
+    // Частковий запис: лише колонки з listing.getDirtyFields() (+ updated_at), після успіху маска скидається.
+    // Змінений опис перераховує simhash. Без змін - нічого не пише.
+    bool updateFields(Listing& listing);
+    // Назви колонок для маски ListingField (для відповідей API та логів)
+    static std::vector<std::string> fieldNames(uint32_t fields);
+    // Довідник для нормалізації регіону при записі та фільтра по region_id
+    void setRegionDirectory(std::shared_ptr<RegionDirectory> regions);
+    std::shared_ptr<RegionDirectory> getRegionDirectory() const { return regions_; }
+    
+    // Заповнює price_uah для оголошень, створених до появи колонки
+    bool backfillPriceUah();
     bool incrementViewCount(int listingId);
+    bool updateStatus(int listingId, const std::string& status, time_t moderationDate);
     
-    // Пошук та сортування
+    // Спостерігачі викликаються після успішного запису
+    void addObserver(std::shared_ptr<IListingObserver> observer);
+    
+    // Сповіщення про зміну статусу, записану в обхід репозиторію
+    // (напр. воркером модерації через власне з'єднання)
+    void publishStatusChange(int listingId, const std::string& previousStatus);
+    
+    // Пошук та сортування; minPrice/maxPrice - у гривнях, sortBy "price" - за ціною в гривнях
     std::vector<std::unique_ptr<Listing>> searchAndFilter(
         const std::string& searchQuery = "",
         int brandId = 0,
@@ -52,8 +92,37 @@ public:
         int limit = 100,
         int offset = 0
     );
+    // Пошук карток за повним фільтром (списки значень, діапазони); сортування - як у searchAndFilter
+    std::vector<ListingSummary> searchSummaries(
+        const ListingFilter& filter,
+        const std::string& sortBy = "created_at",
+        const std::string& sortOrder = "DESC",
+        int limit = 100,
+        int offset = 0
+    );
+    // Лише id у порядку сортування (для кешу видачі)
+    std::vector<int> searchIds(
+        const ListingFilter& filter,
+        const std::string& sortBy = "created_at",
+        const std::string& sortOrder = "DESC",
+        int limit = 100,
+        int offset = 0
+    );
+    // Кількість оголошень під фільтром через передане з'єднання (-1 - помилка).
+    // Повний прохід - лише для фонових потоків з власним з'єднанням
+    long long countSearch(Database& db, const ListingFilter& filter);
     
 private:
     std::unique_ptr<Listing> createListingFromRow(sqlite3_stmt* stmt);
+    ListingSummary createSummaryFromRow(sqlite3_stmt* stmt);
+    // Запит карток з одним (необов'язковим) int параметром
+    std::vector<ListingSummary> querySummaries(const std::string& sql, int param);
+    // Підготовлений і прив'язаний запит пошуку (nullptr - помилка); select - SELECT ... FROM listings l,
+    // limit < 0 - без ORDER BY / LIMIT (підрахунок)
+    sqlite3_stmt* prepareSearch(sqlite3* handle, const std::string& select, const ListingFilter& filter,
+                                const std::string& sortBy, const std::string& sortOrder, int limit, int offset);
+    void notifyObservers(const Listing* before, const Listing* after);
+    // Канонічна назва та region_id з довідника (невідомий регіон - як є, id 0)
+    void normalizeRegion(Listing& listing);
 };
 
@@ -0,0 +1,262 @@
+// FILE: backend/src/repositories/MessageRepository.cpp
+#include "MessageRepository.h"
+#include <algorithm>
+#include <iostream>
+
+bool MessageCursor::parse(const std::string& value, MessageCursor& cursor) {
+    size_t colon = value.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == value.size()) return false;
+    try {
+        size_t used = 0;
+        cursor.createdAt = std::stoll(value.substr(0, colon), &used);
+        if (used != colon) return false;
+        std::string id = value.substr(colon + 1);
+        cursor.id = std::stoi(id, &used);
+        return used == id.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+std::string MessageCursor::toString() const {
+    return std::to_string(createdAt) + ":" + std::to_string(id);
+}
+
+MessageRepository::MessageRepository(std::shared_ptr<Database> db) : db_(db) {}
+
+MessagePage MessageRepository::findThread(int userId, int otherUserId, const MessageCursor* before,
+                                          const MessageCursor* after, int limit) {
+    MessagePage page = {{}, false, false};
+    limit = std::max(1, std::min(limit, static_cast<int>(kMaxPageSize)));
+    
+    // Пара учасників - по індексу idx_messages_pair, далі діапазон по (created_at, id).
+    // after читається за зростанням, решта - від найновіших; limit + 1 - ознака наступної сторінки.
+    std::string sql =
+        "SELECT id, sender_id, receiver_id, listing_id, message_text, is_read, created_at FROM messages "
+        "WHERE MIN(sender_id, receiver_id) = ?1 AND MAX(sender_id, receiver_id) = ?2 "
+        "AND (sender_id = ?3 OR status = 'active')";
+    if (after) {
+        sql += " AND (created_at, id) > (?4, ?5) ORDER BY created_at ASC, id ASC LIMIT ?6";
+    } else if (before) {
+        sql += " AND (created_at, id) < (?4, ?5) ORDER BY created_at DESC, id DESC LIMIT ?6";
+    } else {
+        sql += " ORDER BY created_at DESC, id DESC LIMIT ?6";
+    }
+    sqlite3_stmt* stmt;
+    
+    if (sqlite3_prepare_v2(db_->getHandle(), sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load messages: " << sqlite3_errmsg(db_->getHandle()) << std::endl;
+        return page;
+    }
+    sqlite3_bind_int(stmt, 1, std::min(userId, otherUserId));
+    sqlite3_bind_int(stmt, 2, std::max(userId, otherUserId));
+    sqlite3_bind_int(stmt, 3, userId);
+    const MessageCursor* cursor = after ? after : before;
+    if (cursor) {
+        sqlite3_bind_int64(stmt, 4, cursor->createdAt);
+        sqlite3_bind_int(stmt, 5, cursor->id);
+    }
+    sqlite3_bind_int(stmt, 6, limit + 1);
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (static_cast<int>(page.messages.size()) == limit) {
+            (after ? page.hasNewer : page.hasOlder) = true;
+            break;
+        }
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+        Message message;
+        message.id = sqlite3_column_int(stmt, 0);
+        message.senderId = sqlite3_column_int(stmt, 1);
+        message.receiverId = sqlite3_column_int(stmt, 2);
+        message.listingId = sqlite3_column_int(stmt, 3);
+        message.text = text ? text : "";
+        message.isRead = sqlite3_column_int(stmt, 5) != 0;
+        message.createdAt = static_cast<time_t>(sqlite3_column_int64(stmt, 6));
+        page.messages.push_back(std::move(message));
+    }
+    sqlite3_finalize(stmt);
+    
+    if (after) {
+        // Курсор after вказує на вже отримане повідомлення - старіші існують
+        page.hasOlder = true;
+    } else {
+        std::reverse(page.messages.begin(), page.messages.end());
+    }
+    return page;
+}
+
+std::vector<ConversationSummary> MessageRepository::findConversations(int userId) {
+    std::vector<ConversationSummary> conversations;
+    // Дві гілки по індексах (user_a, ...) та (user_b, ...); розмова з собою - лише раз
+    const char* sql =
+        "SELECT c.other_id, u.first_name, u.last_name, c.last_message_id, m.sender_id, "
+        "substr(m.message_text, 1, ?2), c.last_at, c.unread FROM ("
+        "  SELECT user_b AS other_id, last_message_id, last_at, unread_a AS unread "
+        "  FROM conversations WHERE user_a = ?1"
+        "  UNION ALL "
+        "  SELECT user_a, last_message_id, last_at, unread_b "
+        "  FROM conversations WHERE user_b = ?1 AND user_a != user_b"
+        ") c JOIN users u ON u.id = c.other_id "
+        "LEFT JOIN messages m ON m.id = c.last_message_id "
+        "ORDER BY c.last_at DESC, c.last_message_id DESC";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load conversations: " << sqlite3_errmsg(db_->getHandle()) << std::endl;
+        return conversations;
+    }
+    sqlite3_bind_int(stmt, 1, userId);
+    sqlite3_bind_int(stmt, 2, kPreviewChars);
+
+    auto text = [stmt](int column) {
+        const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+        return std::string(value ? value : "");
+    };
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        ConversationSummary summary;
+        summary.otherUserId = sqlite3_column_int(stmt, 0);
+        summary.firstName = text(1);
+        summary.lastName = text(2);
+        summary.lastMessageId = sqlite3_column_int(stmt, 3);
+        summary.lastSenderId = sqlite3_column_int(stmt, 4);
+        summary.lastMessagePreview = text(5);
+        summary.lastAt = static_cast<time_t>(sqlite3_column_int64(stmt, 6));
+        summary.unreadCount = sqlite3_column_int(stmt, 7);
+        conversations.push_back(summary);
+    }
+    sqlite3_finalize(stmt);
+    return conversations;
+}
+
+namespace {
+
+// Лічильник непрочитаних receiverId у розмовах з otherUserId (0 - у всіх розмовах)
+// перераховується з messages в одному UPDATE: оператор виконується під блокуванням
+// запису, тож паралельні прочитання та доставка воркером не дають розбіжності
+bool recountUnread(sqlite3* handle, int receiverId, int otherUserId) {
+    const char* sql =
+        "UPDATE conversations SET "
+        "unread_a = CASE WHEN user_a = ?1 THEN "
+        "  (SELECT COUNT(*) FROM messages WHERE receiver_id = ?1 AND sender_id = conversations.user_b "
+        "   AND is_read = 0 AND status = 'active') ELSE unread_a END, "
+        "unread_b = CASE WHEN user_b = ?1 THEN "
+        "  (SELECT COUNT(*) FROM messages WHERE receiver_id = ?1 AND sender_id = conversations.user_a "
+        "   AND is_read = 0 AND status = 'active') ELSE unread_b END "
+        "WHERE (user_a = ?1 OR user_b = ?1) AND user_a != user_b "
+        "  AND (?2 = 0 OR (user_a, user_b) = (MIN(?1, ?2), MAX(?1, ?2)))";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, receiverId);
+    sqlite3_bind_int(stmt, 2, otherUserId);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+} // namespace
+
+bool MessageRepository::markRead(int messageId, int receiverId, bool& counted) {
+    counted = false;
+    sqlite3* handle = db_->getHandle();
+    // Змінений рядок повертає сам UPDATE - без sqlite3_changes на спільному з'єднанні
+    const char* sql = "UPDATE messages SET is_read = 1 "
+                      "WHERE id = ? AND receiver_id = ? AND is_read = 0 AND status = 'active' "
+                      "RETURNING sender_id";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, messageId);
+    sqlite3_bind_int(stmt, 2, receiverId);
+    int senderId = 0;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        senderId = sqlite3_column_int(stmt, 0);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) return false;
+    // Вже прочитане (або чуже) - лічильник не змінюється;
+    // переписка з самим собою непрочитаних не рахує
+    if (senderId == 0 || senderId == receiverId) return true;
+
+    counted = true;
+    return recountUnread(handle, receiverId, senderId);
+}
+
+bool MessageRepository::markAllRead(int receiverId, int otherUserId, int& marked) {
+    marked = 0;
+    sqlite3* handle = db_->getHandle();
+    const char* sql = "UPDATE messages SET is_read = 1 "
+                      "WHERE receiver_id = ?1 AND is_read = 0 AND status = 'active' AND (?2 = 0 OR sender_id = ?2) "
+                      "RETURNING id";
+    sqlite3_stmt* stmt;
+    
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, receiverId);
+    sqlite3_bind_int(stmt, 2, otherUserId);
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        ++marked;
+    }
+    sqlite3_finalize(stmt);
+    
+    if (rc != SQLITE_DONE) return false;
+    if (marked == 0) return true;
+    
+    return recountUnread(handle, receiverId, otherUserId);
+}
+
+bool MessageRepository::recordDelivery(sqlite3* handle, int messageId) {
+    // Останнім лишається новіше повідомлення; непрочитане - у отримувача
+    const char* sql =
+        "INSERT INTO conversations (user_a, user_b, last_message_id, last_at, unread_a, unread_b) "
+        "SELECT MIN(sender_id, receiver_id), MAX(sender_id, receiver_id), id, created_at, "
+        "       CASE WHEN receiver_id < sender_id AND is_read = 0 THEN 1 ELSE 0 END, "
+        "       CASE WHEN receiver_id > sender_id AND is_read = 0 THEN 1 ELSE 0 END "
+        "FROM messages WHERE id = ? AND status = 'active' "
+        "ON CONFLICT(user_a, user_b) DO UPDATE SET "
+        "  last_message_id = CASE WHEN excluded.last_at >= last_at THEN excluded.last_message_id ELSE last_message_id END, "
+        "  last_at = MAX(last_at, excluded.last_at), "
+        "  unread_a = unread_a + excluded.unread_a, "
+        "  unread_b = unread_b + excluded.unread_b";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to update conversation: " << sqlite3_errmsg(handle) << std::endl;
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, messageId);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool MessageRepository::backfillConversations() {
+    sqlite3* handle = db_->getHandle();
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, "SELECT EXISTS (SELECT 1 FROM conversations)", -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    bool filled = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) != 0;
+    sqlite3_finalize(stmt);
+    if (filled) return true;
+
+    // id - з рядка з найбільшим created_at у групі (семантика bare column у SQLite з MAX)
+    return db_->execute(
+        "INSERT INTO conversations (user_a, user_b, last_message_id, last_at, unread_a, unread_b) "
+        "SELECT user_a, user_b, id, MAX(created_at), "
+        "       SUM(CASE WHEN is_read = 0 AND receiver_id = user_a AND user_a != user_b THEN 1 ELSE 0 END), "
+        "       SUM(CASE WHEN is_read = 0 AND receiver_id = user_b AND user_a != user_b THEN 1 ELSE 0 END) "
+        "FROM (SELECT id, receiver_id, is_read, created_at, "
+        "             MIN(sender_id, receiver_id) AS user_a, MAX(sender_id, receiver_id) AS user_b "
+        "      FROM messages WHERE status = 'active') "
+        "GROUP BY user_a, user_b");
+}
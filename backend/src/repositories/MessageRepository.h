@@ -0,0 +1,90 @@
+// FILE: backend/src/repositories/MessageRepository.h
+#pragma once
+#include "../database/Database.h"
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Повідомлення переписки
+struct Message {
+    int id;
+    int senderId;
+    int receiverId;
+    int listingId; // 0 - без прив'язки до оголошення
+    std::string text;
+    bool isRead;
+    time_t createdAt;
+};
+
+// Позиція в переписці: ключ сортування (created_at, id), у запиті - "createdAt:id"
+struct MessageCursor {
+    int64_t createdAt = 0;
+    int id = 0;
+    
+    static bool parse(const std::string& value, MessageCursor& cursor);
+    std::string toString() const;
+};
+
+// Сторінка переписки в хронологічному порядку
+struct MessagePage {
+    std::vector<Message> messages;
+    bool hasOlder; // Є старіші за першу
+    bool hasNewer; // Є новіші за останню (лише для запиту з after)
+};
+
+// Рядок списку розмов (inbox) з точки зору одного користувача
+struct ConversationSummary {
+    int otherUserId;
+    std::string firstName;
+    std::string lastName;
+    int lastMessageId;
+    int lastSenderId;
+    std::string lastMessagePreview; // Перші kPreviewChars символів
+    time_t lastAt;
+    int unreadCount;
+};
+
+// Репозиторій повідомлень та підсумкової таблиці розмов.
+// conversations(user_a < user_b) містить останнє доставлене повідомлення та
+// лічильники непрочитаних для кожної сторони; оновлюється при доставці
+// (схвалення модерацією) та прочитанні, тож inbox - один індексований запит.
+class MessageRepository {
+public:
+    static const int kPreviewChars = 120;
+    static const int kDefaultPageSize = 50;
+    static const int kMaxPageSize = 100;
+
+private:
+    std::shared_ptr<Database> db_;
+
+public:
+    MessageRepository(std::shared_ptr<Database> db);
+    std::shared_ptr<Database> getDb() const { return db_; }
+
+    // Розмови користувача, новіші першими
+    std::vector<ConversationSummary> findConversations(int userId);
+
+    // Сторінка переписки userId з otherUserId (повідомлення на модерації бачить лише відправник).
+    // Без курсорів - найновіші limit; before - старіші за курсор; after - новіші за курсор.
+    MessagePage findThread(int userId, int otherUserId, const MessageCursor* before,
+                           const MessageCursor* after, int limit);
+
+    // Позначає доставлене повідомлення прочитаним отримувачем та перераховує лічильник розмови.
+    // counted - саме цей виклик змінив непрочитане повідомлення, що враховувалось у лічильниках
+    // (не самому собі); визначається рядком, повернутим UPDATE, а не sqlite3_changes.
+    bool markRead(int messageId, int receiverId, bool& counted);
+    
+    // Позначає прочитаними всі доставлені повідомлення отримувача (otherUserId = 0)
+    // або лише від otherUserId; перераховує лічильники відповідних розмов.
+    // marked - кількість рядків, змінених саме цим викликом (RETURNING)
+    bool markAllRead(int receiverId, int otherUserId, int& marked);
+
+    // Заповнення conversations з messages, якщо таблиця порожня (перший запуск після міграції)
+    bool backfillConversations();
+
+    // Оновлення розмови доставленим (status = 'active') повідомленням.
+    // Приймає з'єднання, щоб виконуватись у транзакції воркера модерації.
+    static bool recordDelivery(sqlite3* handle, int messageId);
+};
@@ -82,13 +82,26 @@ bool UserRepository::create(std::unique_ptr<User> user) {
         sqlite3_bind_int(stmt, 11, now);
         
         int rc = sqlite3_step(stmt);
+        int newId = static_cast<int>(sqlite3_last_insert_rowid(db_->getHandle()));
         sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
+        if (rc != SQLITE_DONE) {
+            return false;
+        }
+        if (!observers_.empty()) {
+            auto created = findById(newId);
+            notifyObservers(nullptr, created.get());
+        }
+        return true;
     }
     return false;
 }
 
 bool UserRepository::update(std::unique_ptr<User> user) {
+    std::unique_ptr<User> before;
+    if (!observers_.empty()) {
+        before = findById(user->getId());
+    }
+    
     const char* sql = R"(UPDATE users SET email=?, first_name=?, last_name=?, 
                 account_type=?, is_active=?, updated_at=? WHERE id=?)";
     
@@ -118,12 +131,23 @@ bool UserRepository::update(std::unique_ptr<User> user) {
         
         int rc = sqlite3_step(stmt);
         sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
+        if (rc != SQLITE_DONE) {
+            return false;
+        }
+        if (before) {
+            notifyObservers(before.get(), user.get());
+        }
+        return true;
     }
     return false;
 }
 
 bool UserRepository::deleteUser(int id) {
+    std::unique_ptr<User> before;
+    if (!observers_.empty()) {
+        before = findById(id);
+    }
+    
     const char* sql = "DELETE FROM users WHERE id = ?";
     sqlite3_stmt* stmt;
     
@@ -131,7 +155,13 @@ bool UserRepository::deleteUser(int id) {
         sqlite3_bind_int(stmt, 1, id);
         int rc = sqlite3_step(stmt);
         sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
+        if (rc != SQLITE_DONE) {
+            return false;
+        }
+        if (before) {
+            notifyObservers(before.get(), nullptr);
+        }
+        return true;
     }
     return false;
 }
@@ -179,6 +209,19 @@ bool UserRepository::unbanUser(int id) {
     return false;
 }
 
+void UserRepository::addObserver(std::shared_ptr<IUserObserver> observer) {
+    if (observer) {
+        observers_.push_back(std::move(observer));
+    }
+}
+
+void UserRepository::notifyObservers(const User* before, const User* after) {
+    if (!before && !after) return;
+    for (const auto& observer : observers_) {
+        observer->onUserChanged(before, after);
+    }
+}
+
 std::unique_ptr<User> UserRepository::createUserFromRow(sqlite3_stmt* stmt) {
     int id = sqlite3_column_int(stmt, 0);
     std::string email = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
@@ -6,6 +6,14 @@
 #include <vector>
 #include <string>
 
+// Інтерфейс спостерігача за змінами користувачів
+class IUserObserver {
+public:
+    virtual ~IUserObserver() = default;
+    // before == nullptr - створення, after == nullptr - видалення
+    virtual void onUserChanged(const User* before, const User* after) = 0;
+};
+
 // Інтерфейс для репозиторію користувачів
 class IUserRepository {
 public:
@@ -21,6 +29,7 @@ public:
 class UserRepository : public IUserRepository {
 private:
     std::shared_ptr<Database> db_;
+    std::vector<std::shared_ptr<IUserObserver>> observers_;
 
 public:
     UserRepository(std::shared_ptr<Database> db);
@@ -37,7 +46,11 @@ public:
     bool banUser(int id);
     bool unbanUser(int id);
     
+    // Спостерігачі викликаються після успішного запису
+    void addObserver(std::shared_ptr<IUserObserver> observer);
+    
 private:
     std::unique_ptr<User> createUserFromRow(sqlite3_stmt* stmt);
+    void notifyObservers(const User* before, const User* after);
 };
 
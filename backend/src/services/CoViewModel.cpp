@@ -0,0 +1,243 @@
+// FILE: backend/src/services/CoViewModel.cpp
+#include "CoViewModel.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+const int64_t kSessionGapSeconds = 30 * 60;
+const float kViewWeight = 1.0f;
+const float kFavoriteWeight = 2.0f; // Спільне додавання в обране - сильніший сигнал
+
+struct Session {
+    float weight;
+    std::vector<int> items; // Унікальні оголошення сесії
+};
+
+void addItem(Session& session, int listingId) {
+    if (session.items.size() >= CoViewModel::kMaxSessionItems) return;
+    if (std::find(session.items.begin(), session.items.end(), listingId) == session.items.end()) {
+        session.items.push_back(listingId);
+    }
+}
+
+uint64_t pairKey(int a, int b) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+}
+
+} // namespace
+
+const size_t CoViewModel::kTopK;
+
+CoViewModel::CoViewModel(std::shared_ptr<Database> db)
+    : db_(db), table_(std::make_shared<CoViewTable>()), lastReport_() {
+}
+
+CoViewModel::~CoViewModel() {
+    stopPeriodicRebuild();
+}
+
+CoViewBuildReport CoViewModel::rebuild() {
+    std::lock_guard<std::mutex> lock(buildMutex_);
+    auto started = std::chrono::steady_clock::now();
+    CoViewBuildReport report = {};
+    sqlite3* handle = db_->getHandle();
+    
+    // 1. Сесії: перегляди користувача з перервою <= 30 хв, обране користувача - одна сесія
+    std::vector<Session> sessions;
+    int maxListingId = 0;
+    sqlite3_stmt* stmt;
+    const char* viewsSql = "SELECT user_id, listing_id, viewed_at FROM listing_views "
+                           "WHERE user_id IS NOT NULL ORDER BY user_id, viewed_at";
+    if (sqlite3_prepare_v2(handle, viewsSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load views for co-view model: " << sqlite3_errmsg(handle) << std::endl;
+        report.success = false;
+        return report;
+    }
+    int currentUser = -1;
+    int64_t lastViewedAt = 0;
+    Session session = {kViewWeight, {}};
+    auto closeSession = [&sessions](Session& s) {
+        if (s.items.size() >= 2) {
+            sessions.push_back(std::move(s));
+        }
+        s.items.clear();
+    };
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int userId = sqlite3_column_int(stmt, 0);
+        int listingId = sqlite3_column_int(stmt, 1);
+        int64_t viewedAt = sqlite3_column_int64(stmt, 2);
+        if (userId != currentUser || viewedAt - lastViewedAt > kSessionGapSeconds) {
+            closeSession(session);
+            session.weight = kViewWeight;
+            currentUser = userId;
+        }
+        lastViewedAt = viewedAt;
+        addItem(session, listingId);
+        maxListingId = std::max(maxListingId, listingId);
+        ++report.events;
+    }
+    closeSession(session);
+    sqlite3_finalize(stmt);
+    
+    if (sqlite3_prepare_v2(handle, "SELECT user_id, listing_id FROM favorites ORDER BY user_id",
+                           -1, &stmt, nullptr) == SQLITE_OK) {
+        currentUser = -1;
+        session.weight = kFavoriteWeight;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int userId = sqlite3_column_int(stmt, 0);
+            int listingId = sqlite3_column_int(stmt, 1);
+            if (userId != currentUser) {
+                closeSession(session);
+                session.weight = kFavoriteWeight;
+                currentUser = userId;
+            }
+            addItem(session, listingId);
+            maxListingId = std::max(maxListingId, listingId);
+            ++report.events;
+        }
+        closeSession(session);
+        sqlite3_finalize(stmt);
+    }
+    report.sessions = sessions.size();
+    
+    // Вага оголошення - сума ваг сесій, де воно є (знаменник косинусної схожості)
+    std::vector<float> itemWeight(static_cast<size_t>(maxListingId) + 1, 0.0f);
+    for (const auto& s : sessions) {
+        for (int id : s.items) {
+            itemWeight[id] += s.weight;
+        }
+    }
+    
+    // 2. Паралельний підрахунок пар. Кожен потік обробляє свою частину сесій і розкладає
+    // пари (a, b) по шардах за a, щоб злиття теж ішло паралельно без блокувань.
+    unsigned threadCount = std::max(1u, std::min(8u, std::thread::hardware_concurrency()));
+    report.threads = threadCount;
+    using PairMap = std::unordered_map<uint64_t, float>;
+    std::vector<std::vector<PairMap>> partial(threadCount, std::vector<PairMap>(threadCount));
+    {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threadCount; ++t) {
+            workers.emplace_back([&, t] {
+                auto& shards = partial[t];
+                for (size_t i = t; i < sessions.size(); i += threadCount) {
+                    const auto& items = sessions[i].items;
+                    for (int a : items) {
+                        auto& shard = shards[static_cast<unsigned>(a) % threadCount];
+                        for (int b : items) {
+                            if (a != b) {
+                                shard[pairKey(a, b)] += sessions[i].weight;
+                            }
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+    
+    // 3. Злиття шардів та відбір top-K для кожного оголошення шарду
+    std::vector<std::vector<std::pair<int, std::vector<CoViewNeighbor>>>> rows(threadCount);
+    std::vector<size_t> pairCounts(threadCount, 0);
+    {
+        std::vector<std::thread> workers;
+        for (unsigned s = 0; s < threadCount; ++s) {
+            workers.emplace_back([&, s] {
+                PairMap merged = std::move(partial[0][s]);
+                for (unsigned t = 1; t < threadCount; ++t) {
+                    for (const auto& entry : partial[t][s]) {
+                        merged[entry.first] += entry.second;
+                    }
+                    PairMap().swap(partial[t][s]);
+                }
+                pairCounts[s] = merged.size();
+                
+                std::unordered_map<int, std::vector<CoViewNeighbor>> bySource;
+                for (const auto& entry : merged) {
+                    int a = static_cast<int>(entry.first >> 32);
+                    int b = static_cast<int>(static_cast<uint32_t>(entry.first));
+                    float score = entry.second / std::sqrt(itemWeight[a] * itemWeight[b]);
+                    bySource[a].push_back({b, score});
+                }
+                auto byScore = [](const CoViewNeighbor& x, const CoViewNeighbor& y) {
+                    return x.score != y.score ? x.score > y.score : x.listingId < y.listingId;
+                };
+                for (auto& source : bySource) {
+                    auto& list = source.second;
+                    size_t keep = std::min(kTopK, list.size());
+                    std::partial_sort(list.begin(), list.begin() + keep, list.end(), byScore);
+                    list.resize(keep);
+                    rows[s].emplace_back(source.first, std::move(list));
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+    
+    // 4. CSR таблиця, індексована id оголошення
+    auto table = std::make_shared<CoViewTable>();
+    table->offsets.assign(static_cast<size_t>(maxListingId) + 2, 0);
+    for (const auto& shardRows : rows) {
+        for (const auto& row : shardRows) {
+            table->offsets[row.first + 1] = static_cast<uint32_t>(row.second.size());
+            ++report.listings;
+        }
+    }
+    for (size_t i = 1; i < table->offsets.size(); ++i) {
+        table->offsets[i] += table->offsets[i - 1];
+    }
+    table->neighbors.resize(table->offsets.back());
+    for (const auto& shardRows : rows) {
+        for (const auto& row : shardRows) {
+            std::copy(row.second.begin(), row.second.end(), table->neighbors.begin() + table->offsets[row.first]);
+        }
+    }
+    for (size_t count : pairCounts) {
+        report.pairs += count;
+    }
+    report.pairs /= 2; // Кожна пара врахована в обох напрямках
+    report.neighbors = table->neighbors.size();
+    
+    std::atomic_store_explicit(&table_, std::shared_ptr<const CoViewTable>(std::move(table)),
+                               std::memory_order_release);
+    
+    report.success = true;
+    report.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    report.builtAt = time(nullptr);
+    lastReport_ = report;
+    return report;
+}
+
+CoViewBuildReport CoViewModel::getLastReport() {
+    std::lock_guard<std::mutex> lock(buildMutex_);
+    return lastReport_;
+}
+
+void CoViewModel::startPeriodicRebuild(std::chrono::seconds interval) {
+    if (rebuildTask_) return;
+    rebuildTask_ = std::make_unique<PeriodicTask>(interval, [this] { rebuild(); });
+    rebuildTask_->start(true); // Перша побудова - одразу, у фоновому потоці
+}
+
+void CoViewModel::stopPeriodicRebuild() {
+    if (rebuildTask_) {
+        rebuildTask_->stop();
+        rebuildTask_.reset();
+    }
+}
+
+std::vector<CoViewNeighbor> CoViewModel::getNeighbors(int listingId, size_t limit) const {
+    auto table = getTable();
+    std::vector<CoViewNeighbor> result;
+    if (listingId < 0 || static_cast<size_t>(listingId) + 1 >= table->offsets.size()) {
+        return result;
+    }
+    uint32_t begin = table->offsets[listingId];
+    uint32_t end = std::min(table->offsets[listingId + 1], begin + static_cast<uint32_t>(limit));
+    result.assign(table->neighbors.begin() + begin, table->neighbors.begin() + end);
+    return result;
+}
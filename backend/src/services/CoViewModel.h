@@ -0,0 +1,72 @@
+// FILE: backend/src/services/CoViewModel.h
+#pragma once
+#include "../database/Database.h"
+#include "../utils/PeriodicTask.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Сусід оголошення в моделі спільних переглядів
+struct CoViewNeighbor {
+    int listingId;
+    float score; // Косинусна схожість за спільними сесіями
+};
+
+// Незмінна таблиця top-K сусідів у форматі CSR: сусіди оголошення id -
+// neighbors[offsets[id] .. offsets[id + 1]). Публікується атомарно (RCU).
+struct CoViewTable {
+    std::vector<uint32_t> offsets; // Розмір maxListingId + 2
+    std::vector<CoViewNeighbor> neighbors;
+};
+
+// Звіт про побудову моделі
+struct CoViewBuildReport {
+    bool success;
+    size_t sessions;
+    size_t events;
+    size_t pairs;      // Унікальні пари оголошень
+    size_t listings;   // Оголошення, що мають сусідів
+    size_t neighbors;  // Всього записів у таблиці
+    unsigned threads;
+    double buildMs;
+    time_t builtAt;
+};
+
+// Клас CoViewModel - рекомендації "також переглядали" (item-to-item).
+// Сесії користувачів з listing_views (перерва > 30 хв - нова сесія) та набори
+// обраного з favorites дають зважені пари спільних переглядів. Пари рахуються
+// паралельно по потоках, для кожного оголошення зберігається top-K сусідів.
+class CoViewModel {
+public:
+    static const size_t kTopK = 20;
+    static const size_t kMaxSessionItems = 50; // Довші сесії (боти, парсери) обрізаються
+
+private:
+    std::shared_ptr<Database> db_;
+    std::shared_ptr<const CoViewTable> table_; // Доступ лише через atomic_load/atomic_store
+    CoViewBuildReport lastReport_;
+    std::mutex buildMutex_; // Серіалізує побудови та доступ до lastReport_
+    std::unique_ptr<PeriodicTask> rebuildTask_;
+
+public:
+    explicit CoViewModel(std::shared_ptr<Database> db);
+    ~CoViewModel();
+    
+    // Повна перебудова моделі; попередня таблиця обслуговує запити до заміни
+    CoViewBuildReport rebuild();
+    CoViewBuildReport getLastReport();
+    
+    // Побудова у фоновому потоці: перша - одразу, далі - з інтервалом
+    void startPeriodicRebuild(std::chrono::seconds interval);
+    void stopPeriodicRebuild();
+    
+    // До limit сусідів за спаданням схожості - O(K)
+    std::vector<CoViewNeighbor> getNeighbors(int listingId, size_t limit) const;
+
+private:
+    std::shared_ptr<const CoViewTable> getTable() const {
+        return std::atomic_load_explicit(&table_, std::memory_order_acquire);
+    }
+};
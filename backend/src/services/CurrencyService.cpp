@@ -2,69 +2,281 @@
 #include "CurrencyService.h"
 #include <ctime>
 #include <cmath>
+#include <iostream>
 
-CurrencyService* CurrencyService::instance_ = nullptr;
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-CurrencyService::CurrencyService() {
-    updateRates();
+namespace {
+// Обмеження розміру щільної історії (~100 років), захист від битих дат у таблиці
+const int64_t kMaxHistoryDays = 36600;
+}
+
+CurrencyService::CurrencyService()
+    : history_(std::make_shared<RateHistory>()), nextVersion_(1), publishedVersion_(0),
+      provider_(std::make_unique<StaticExchangeRateProvider>()) {
+    ExchangeRate rate{};
+    provider_->fetch(rate);
+    publish(rate);
+}
+
+CurrencyService::~CurrencyService() {
+    stopBackgroundRefresh();
 }
 
 CurrencyService* CurrencyService::getInstance() {
-    if (instance_ == nullptr) {
-        instance_ = new CurrencyService();
+    // Потокобезпечна ініціалізація локальної статичної змінної (C++11)
+    static CurrencyService instance;
+    return &instance;
+}
+
+void CurrencyService::publish(const ExchangeRate& rate) {
+    auto snapshot = std::make_shared<RateSnapshot>();
+    snapshot->version = nextVersion_++;
+    snapshot->rate = rate;
+    snapshot->toUah[static_cast<size_t>(Currency::UAH)] = 1.0;
+    snapshot->toUah[static_cast<size_t>(Currency::USD)] = rate.usdToUah;
+    snapshot->toUah[static_cast<size_t>(Currency::EUR)] = rate.eurToUah;
+    uint64_t version = snapshot->version;
+    std::atomic_store_explicit(&snapshot_, std::shared_ptr<const RateSnapshot>(std::move(snapshot)),
+                               std::memory_order_release);
+    // Після знімка: читач, що побачив нову версію, прочитає й новий знімок
+    publishedVersion_.store(version, std::memory_order_release);
+}
+
+void CurrencyService::setProvider(std::unique_ptr<IExchangeRateProvider> provider) {
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    if (provider) {
+        provider_ = std::move(provider);
     }
-    return instance_;
 }
 
-ExchangeRate CurrencyService::fetchRatesFromPrivatBank() {
-    // Моковані курси (в реальності тут буде HTTP запит до API ПриватБанку)
-    ExchangeRate rate;
-    rate.usdToUah = 37.5; // Приклад курсу
-    rate.eurToUah = 40.2;
-    rate.eurToUsd = rate.eurToUah / rate.usdToUah;
-    time(&rate.lastUpdate);
-    return rate;
+bool CurrencyService::attachDatabase(std::shared_ptr<Database> db) {
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    if (!db || !db->getHandle()) return false;
+    
+    sqlite3* handle = db->getHandle();
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT day, ccy, rate FROM exchange_rates "
+                      "WHERE day >= (SELECT MAX(day) FROM exchange_rates) - ? ORDER BY day";
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load exchange rates: " << sqlite3_errmsg(handle) << std::endl;
+        return false;
+    }
+    sqlite3_bind_int64(stmt, 1, kMaxHistoryDays - 1);
+    
+    // Пропуски між днями заповнюються попереднім курсом; валюти, яких ще не було
+    // в історії, на початку беруться з поточного знімка
+    auto current = getSnapshot();
+    auto history = std::make_shared<RateHistory>();
+    std::array<double, kCurrencyCount> carry;
+    for (size_t c = 0; c < kCurrencyCount; ++c) {
+        carry[c] = current->toUah[c];
+    }
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int64_t day = sqlite3_column_int64(stmt, 0);
+        const char* ccy = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        double rate = sqlite3_column_double(stmt, 2);
+        if (!ccy || rate <= 0) continue;
+        Currency currency = parseCurrency(ccy);
+        if (currency == Currency::UAH) continue;
+        
+        if (history->days.empty()) {
+            history->firstDay = day;
+        }
+        while (history->firstDay + static_cast<int64_t>(history->days.size()) <= day) {
+            history->days.push_back(carry);
+        }
+        history->days.back()[static_cast<size_t>(currency)] = rate;
+        carry = history->days.back();
+    }
+    sqlite3_finalize(stmt);
+    
+    db_ = db;
+    if (!history->days.empty()) {
+        // Після рестарту продовжуємо з останнього збереженого курсу, а не із заглушки
+        const auto& last = history->days.back();
+        ExchangeRate rate{};
+        rate.usdToUah = last[static_cast<size_t>(Currency::USD)];
+        rate.eurToUah = last[static_cast<size_t>(Currency::EUR)];
+        rate.eurToUsd = rate.eurToUah / rate.usdToUah;
+        rate.lastUpdate = static_cast<time_t>((history->firstDay + history->days.size() - 1) * 86400);
+        publish(rate);
+    }
+    std::atomic_store_explicit(&history_, std::shared_ptr<const RateHistory>(std::move(history)),
+                               std::memory_order_release);
+    return true;
 }
 
 bool CurrencyService::updateRates() {
-    // Оновлюємо курси раз на день
-    time_t now;
-    time(&now);
+    // Запит до джерела виконується у фоновому потоці; читачі refreshMutex_ не беруть
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    ExchangeRate rate{};
+    if (!provider_ || !provider_->fetch(rate) || rate.usdToUah <= 0 || rate.eurToUah <= 0) {
+        std::cerr << "Exchange rate provider "
+                  << (provider_ ? provider_->getName() : std::string("<none>"))
+                  << " failed, keeping previous rates" << std::endl;
+        return false;
+    }
     
-    if (currentRate_.lastUpdate == 0 || 
-        (now - currentRate_.lastUpdate) > 86400) { // 24 години
-        currentRate_ = fetchRatesFromPrivatBank();
-        return true;
+    publish(rate);
+    recordHistory(rate);
+    if (db_) {
+        persistRates(rate);
     }
-    return false;
+    return true;
 }
 
-double CurrencyService::convert(double amount, const std::string& from, const std::string& to) const {
-    if (from == to) return amount;
+void CurrencyService::recordHistory(const ExchangeRate& rate) {
+    auto current = getHistory();
+    int64_t day = dayOf(rate.lastUpdate);
+    std::array<double, kCurrencyCount> entry;
+    entry[static_cast<size_t>(Currency::UAH)] = 1.0;
+    entry[static_cast<size_t>(Currency::USD)] = rate.usdToUah;
+    entry[static_cast<size_t>(Currency::EUR)] = rate.eurToUah;
     
-    // Конвертуємо через UAH як базову валюту
-    double amountInUah;
-    
-    if (from == "UAH") {
-        amountInUah = amount;
-    } else if (from == "USD") {
-        amountInUah = amount * currentRate_.usdToUah;
-    } else if (from == "EUR") {
-        amountInUah = amount * currentRate_.eurToUah;
-    } else {
-        return amount; // Невідома валюта
+    auto history = std::make_shared<RateHistory>(*current);
+    if (history->days.empty()) {
+        history->firstDay = day;
+    } else if (day < history->firstDay) {
+        return; // Годинник пішов назад - історію не переписуємо
+    }
+    while (history->firstDay + static_cast<int64_t>(history->days.size()) <= day) {
+        history->days.push_back(history->days.empty() ? entry : history->days.back());
+    }
+    history->days[static_cast<size_t>(day - history->firstDay)] = entry;
+    std::atomic_store_explicit(&history_, std::shared_ptr<const RateHistory>(std::move(history)),
+                               std::memory_order_release);
+}
+
+bool CurrencyService::persistRates(const ExchangeRate& rate) {
+    sqlite3* handle = db_->getHandle();
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT OR REPLACE INTO exchange_rates (day, ccy, rate) VALUES (?, ?, ?)";
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to save exchange rates: " << sqlite3_errmsg(handle) << std::endl;
+        return false;
     }
     
-    if (to == "UAH") {
-        return amountInUah;
-    } else if (to == "USD") {
-        return amountInUah / currentRate_.usdToUah;
-    } else if (to == "EUR") {
-        return amountInUah / currentRate_.eurToUah;
+    const std::pair<Currency, double> rows[] = {
+        {Currency::USD, rate.usdToUah},
+        {Currency::EUR, rate.eurToUah},
+    };
+    bool ok = true;
+    for (const auto& row : rows) {
+        sqlite3_bind_int64(stmt, 1, dayOf(rate.lastUpdate));
+        sqlite3_bind_text(stmt, 2, currencyCode(row.first), -1, SQLITE_STATIC);
+        sqlite3_bind_double(stmt, 3, row.second);
+        ok = sqlite3_step(stmt) == SQLITE_DONE && ok;
+        sqlite3_reset(stmt);
     }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+double CurrencyService::getRateAt(Currency currency, time_t at) const {
+    if (currency == Currency::UAH) return 1.0;
     
-    return amount;
+    auto history = getHistory();
+    int64_t index = dayOf(at) - history->firstDay;
+    if (history->days.empty() || index >= static_cast<int64_t>(history->days.size())) {
+        return getSnapshot()->toUah[static_cast<size_t>(currency)];
+    }
+    if (index < 0) {
+        index = 0;
+    }
+    return history->days[static_cast<size_t>(index)][static_cast<size_t>(currency)];
 }
 
+double CurrencyService::convertAt(double amount, Currency from, Currency to, time_t at) const {
+    if (from == to) return amount;
+    return amount * getRateAt(from, at) / getRateAt(to, at);
+}
 
+void CurrencyService::startBackgroundRefresh(std::chrono::seconds interval) {
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    if (refreshTask_) return;
+    refreshTask_ = std::make_unique<PeriodicTask>(interval, [this] { updateRates(); });
+    refreshTask_->start(true);
+}
+
+void CurrencyService::stopBackgroundRefresh() {
+    std::unique_ptr<PeriodicTask> task;
+    {
+        std::lock_guard<std::mutex> lock(refreshMutex_);
+        task = std::move(refreshTask_);
+    }
+    if (task) {
+        task->stop();
+    }
+}
+
+double CurrencyService::convert(double amount, const std::string& from, const std::string& to) const {
+    if (from == to) return amount;
+    
+    auto isKnown = [](const std::string& code) {
+        return code == "UAH" || code == "USD" || code == "EUR";
+    };
+    if (!isKnown(from) || !isKnown(to)) {
+        return amount; // Невідома валюта
+    }
+    
+    // Конвертуємо через UAH як базову валюту
+    return convert(*getSnapshot(), amount, parseCurrency(from), parseCurrency(to));
+}
 
+void CurrencyService::convertBatch(const RateSnapshot& snapshot, size_t count,
+                                   const double* prices, const Currency* currencies, const double* exchangeRates,
+                                   double* priceUSD, double* priceEUR, double* priceUAH) {
+    const double usdRate = snapshot.toUah[static_cast<size_t>(Currency::USD)];
+    const double eurRate = snapshot.toUah[static_cast<size_t>(Currency::EUR)];
+    size_t i = 0;
+    
+#if defined(__SSE2__)
+    // Дві ціни за ітерацію; вибір курсу та валюти - масками, без розгалужень
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d usdCode = _mm_set1_pd(static_cast<double>(Currency::USD));
+    const __m128d eurCode = _mm_set1_pd(static_cast<double>(Currency::EUR));
+    const __m128d usdRateV = _mm_set1_pd(usdRate);
+    const __m128d eurRateV = _mm_set1_pd(eurRate);
+    
+    for (; i + 2 <= count; i += 2) {
+        __m128d price = _mm_loadu_pd(prices + i);
+        __m128d stored = _mm_loadu_pd(exchangeRates + i);
+        __m128d code = _mm_set_pd(static_cast<double>(currencies[i + 1]), static_cast<double>(currencies[i]));
+        
+        __m128d isUsd = _mm_cmpeq_pd(code, usdCode);
+        __m128d isEur = _mm_cmpeq_pd(code, eurCode);
+        __m128d isUah = _mm_cmpeq_pd(code, zero);
+        
+        // Курс зі знімка: USD/EUR з таблиці, UAH = 1
+        __m128d tableRate = _mm_or_pd(_mm_or_pd(_mm_and_pd(isUsd, usdRateV), _mm_and_pd(isEur, eurRateV)),
+                                      _mm_and_pd(isUah, one));
+        // Збережений курс має пріоритет для не-UAH оголошень
+        __m128d useStored = _mm_andnot_pd(isUah, _mm_cmpgt_pd(stored, zero));
+        __m128d rate = _mm_or_pd(_mm_and_pd(useStored, stored), _mm_andnot_pd(useStored, tableRate));
+        
+        __m128d uah = _mm_mul_pd(price, rate);
+        __m128d usd = _mm_or_pd(_mm_and_pd(isUsd, price), _mm_andnot_pd(isUsd, _mm_div_pd(uah, usdRateV)));
+        __m128d eur = _mm_or_pd(_mm_and_pd(isEur, price), _mm_andnot_pd(isEur, _mm_div_pd(uah, eurRateV)));
+        
+        _mm_storeu_pd(priceUAH + i, uah);
+        _mm_storeu_pd(priceUSD + i, usd);
+        _mm_storeu_pd(priceEUR + i, eur);
+    }
+#endif
+    
+    // Хвіст (або вся сторінка без SSE2)
+    for (; i < count; ++i) {
+        Currency currency = currencies[i];
+        double rate = (currency != Currency::UAH && exchangeRates[i] > 0)
+                    ? exchangeRates[i] : snapshot.toUah[static_cast<size_t>(currency)];
+        double uah = prices[i] * rate;
+        priceUAH[i] = uah;
+        priceUSD[i] = currency == Currency::USD ? prices[i] : uah / usdRate;
+        priceEUR[i] = currency == Currency::EUR ? prices[i] : uah / eurRate;
+    }
+}
@@ -1,40 +1,109 @@
 // FILE: backend/src/services/CurrencyService.h
 #pragma once
-#include <string>
+#include "../models/Currency.h"
+#include "../database/Database.h"
+#include "../utils/PeriodicTask.h"
+#include "ExchangeRateProvider.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Незмінний знімок курсів. Публікується заміною вказівника: читачі бачать
+// або старий, або новий знімок повністю.
+struct RateSnapshot {
+    uint64_t version;
+    ExchangeRate rate;
+    double toUah[kCurrencyCount]; // Курс валюти до UAH (UAH = 1)
+};
 
-// Структура для курсу валют
-struct ExchangeRate {
-    double usdToUah;
-    double eurToUah;
-    double eurToUsd;
-    time_t lastUpdate;
+// Історія курсів: щільний масив по днях (UTC) від firstDay, пропуски заповнені
+// попереднім відомим курсом. Пошук курсу на дату - індексація без пошуку.
+struct RateHistory {
+    int64_t firstDay = 0;
+    std::vector<std::array<double, kCurrencyCount>> days; // Курс до UAH на кожен день
 };
 
 // Клас CurrencyService - інкапсуляція роботи з валютами
 class CurrencyService {
 private:
-    ExchangeRate currentRate_;
-    static CurrencyService* instance_; // Singleton pattern
+    std::shared_ptr<const RateSnapshot> snapshot_; // Доступ лише через atomic_load/atomic_store
+    std::shared_ptr<const RateHistory> history_;   // Так само, через atomic_load/atomic_store
+    std::atomic<uint64_t> nextVersion_;
+    std::atomic<uint64_t> publishedVersion_; // Версія snapshot_; записується після нього
+    std::mutex refreshMutex_; // Серіалізує оновлення, читачі його не беруть
+    std::unique_ptr<PeriodicTask> refreshTask_;
+    std::unique_ptr<IExchangeRateProvider> provider_;
+    std::shared_ptr<Database> db_; // Сховище історії курсів (exchange_rates)
 
     CurrencyService();
 
 public:
+    ~CurrencyService();
+    
     static CurrencyService* getInstance();
     
-    // Оновлення курсів з ПриватБанку (мокована версія)
+    // Поточний знімок курсів. atomic_load для shared_ptr у libstdc++ бере м'ютекс з
+    // глобального пулу, тому кожен потік тримає копію останнього прочитаного знімка:
+    // звичайне читання - acquire-читання версії та копія shared_ptr (атомарний інкремент),
+    // atomic_load - лише перше читання в потоці після публікації нового знімка.
+    // Сервіс - синглтон, тож кеш потоку один на процес.
+    std::shared_ptr<const RateSnapshot> getSnapshot() const {
+        thread_local std::shared_ptr<const RateSnapshot> cached;
+        uint64_t version = publishedVersion_.load(std::memory_order_acquire);
+        if (!cached || cached->version != version) {
+            cached = std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+        }
+        return cached;
+    }
+    
+    // Заміна джерела курсів (за замовчуванням - StaticExchangeRateProvider)
+    void setProvider(std::unique_ptr<IExchangeRateProvider> provider);
+    
+    // Підключення таблиці exchange_rates: завантаження історії та останнього курсу
+    bool attachDatabase(std::shared_ptr<Database> db);
+    
+    // Отримання курсів з джерела, публікація знімка та запис в історію
     bool updateRates();
     
+    // Фонове оновлення курсів за таймером (перше - одразу, у фоновому потоці)
+    void startBackgroundRefresh(std::chrono::seconds interval);
+    void stopBackgroundRefresh();
+    
     // Отримання поточних курсів
-    ExchangeRate getCurrentRates() const { return currentRate_; }
+    ExchangeRate getCurrentRates() const { return getSnapshot()->rate; }
     
     // Конвертація між валютами
     double convert(double amount, const std::string& from, const std::string& to) const;
+    static double convert(const RateSnapshot& snapshot, double amount, Currency from, Currency to) {
+        return amount * snapshot.toUah[static_cast<size_t>(from)] / snapshot.toUah[static_cast<size_t>(to)];
+    }
+    
+    // Курс валюти до UAH на дату. Дати до початку історії - перший відомий курс,
+    // після кінця історії - поточний знімок.
+    double getRateAt(Currency currency, time_t at) const;
+    
+    // Конвертація за курсом на дату (для price_history та аналітики)
+    double convertAt(double amount, Currency from, Currency to, time_t at) const;
+    
+    // Пакетна конвертація сторінки цін (колонки price/currency/exchangeRate) за одним знімком.
+    // exchangeRate > 0 - збережений курс оголошення до UAH, інакше береться курс зі знімка.
+    static void convertBatch(const RateSnapshot& snapshot, size_t count,
+                             const double* prices, const Currency* currencies, const double* exchangeRates,
+                             double* priceUSD, double* priceEUR, double* priceUAH);
     
 private:
-    // Мокована функція для отримання курсів (в реальності буде HTTP запит до ПриватБанку)
-    ExchangeRate fetchRatesFromPrivatBank();
+    void publish(const ExchangeRate& rate);
+    bool persistRates(const ExchangeRate& rate);
+    void recordHistory(const ExchangeRate& rate);
+    
+    static int64_t dayOf(time_t t) { return static_cast<int64_t>(t) / 86400; }
+    std::shared_ptr<const RateHistory> getHistory() const {
+        return std::atomic_load_explicit(&history_, std::memory_order_acquire);
+    }
 };
-
-
-
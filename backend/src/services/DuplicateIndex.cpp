@@ -0,0 +1,180 @@
+// FILE: backend/src/services/DuplicateIndex.cpp
+#include "DuplicateIndex.h"
+#include "../utils/SimHash.h"
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+
+DuplicateIndex::DuplicateIndex(std::shared_ptr<Database> db) : db_(db) {
+}
+
+bool DuplicateIndex::load() {
+    sqlite3* handle = db_->getHandle();
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT id, seller_id, simhash, description FROM listings";
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load listing fingerprints: " << sqlite3_errmsg(handle) << std::endl;
+        return false;
+    }
+    
+    std::vector<std::pair<int, uint64_t>> missing;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    entries_.clear();
+    for (auto& bucket : buckets_) {
+        bucket.clear();
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        int sellerId = sqlite3_column_int(stmt, 1);
+        uint64_t simHash;
+        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) {
+            simHash = static_cast<uint64_t>(sqlite3_column_int64(stmt, 2));
+        } else {
+            const char* description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            simHash = simhash::fingerprint(description ? description : "");
+            if (simHash != 0) {
+                missing.emplace_back(id, simHash);
+            }
+        }
+        if (simHash != 0) {
+            insertLocked(id, simHash, sellerId);
+        }
+    }
+    sqlite3_finalize(stmt);
+    lock.unlock();
+    
+    // Відбитки для оголошень, створених до появи колонки simhash - однією транзакцією
+    if (missing.empty()) return true;
+    const bool began = db_->execute("BEGIN");
+    bool ok = began;
+    if (ok && sqlite3_prepare_v2(handle, "UPDATE listings SET simhash = ? WHERE id = ?",
+                                 -1, &stmt, nullptr) == SQLITE_OK) {
+        for (size_t i = 0; ok && i < missing.size(); ++i) {
+            sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(missing[i].second));
+            sqlite3_bind_int(stmt, 2, missing[i].first);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+    } else {
+        ok = false;
+    }
+    if (!ok || !db_->execute("COMMIT")) {
+        // Індекс уже в пам'яті; відбитки дорахуються при наступному запуску
+        std::cerr << "Failed to backfill listing fingerprints: " << sqlite3_errmsg(handle) << std::endl;
+        if (began) db_->execute("ROLLBACK");
+    }
+    return true;
+}
+
+void DuplicateIndex::insertLocked(int listingId, uint64_t simHash, int sellerId) {
+    Entry entry = {simHash, listingId, sellerId};
+    entries_[listingId] = entry;
+    for (int i = 0; i < kBands; ++i) {
+        buckets_[i][band(simHash, i)].push_back(entry);
+    }
+}
+
+void DuplicateIndex::removeLocked(int listingId) {
+    auto it = entries_.find(listingId);
+    if (it == entries_.end()) return;
+    for (int i = 0; i < kBands; ++i) {
+        auto bucket = buckets_[i].find(band(it->second.simHash, i));
+        if (bucket == buckets_[i].end()) continue;
+        auto& bucketEntries = bucket->second;
+        bucketEntries.erase(std::remove_if(bucketEntries.begin(), bucketEntries.end(),
+                                           [listingId](const Entry& e) { return e.listingId == listingId; }),
+                            bucketEntries.end());
+        if (bucketEntries.empty()) {
+            buckets_[i].erase(bucket);
+        }
+    }
+    entries_.erase(it);
+}
+
+std::vector<DuplicateMatch> DuplicateIndex::findDuplicates(int listingId) const {
+    uint64_t simHash = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(listingId);
+        if (it == entries_.end()) return {};
+        simHash = it->second.simHash;
+    }
+    return findSimilar(simHash, listingId);
+}
+
+std::vector<DuplicateMatch> DuplicateIndex::findSimilar(uint64_t simHash, int excludeId) const {
+    std::vector<DuplicateMatch> matches;
+    if (simHash == 0) return matches;
+    
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (int i = 0; i < kBands; ++i) {
+        auto bucket = buckets_[i].find(band(simHash, i));
+        if (bucket == buckets_[i].end()) continue;
+        for (const Entry& entry : bucket->second) {
+            if (entry.listingId == excludeId) continue;
+            int distance = simhash::distance(simHash, entry.simHash);
+            if (distance > kMaxDistance) continue;
+            // Кандидат може лежати в кількох кошиках - додаємо один раз
+            bool seen = std::any_of(matches.begin(), matches.end(),
+                                    [&entry](const DuplicateMatch& m) { return m.listingId == entry.listingId; });
+            if (!seen) {
+                matches.push_back({entry.listingId, entry.sellerId, distance});
+            }
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const DuplicateMatch& a, const DuplicateMatch& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.listingId < b.listingId;
+    });
+    return matches;
+}
+
+bool DuplicateIndex::flagDuplicates(int listingId, const std::vector<DuplicateMatch>& matches) {
+    if (matches.empty()) return true;
+    
+    int sellerId = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(listingId);
+        if (it != entries_.end()) sellerId = it->second.sellerId;
+    }
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT OR REPLACE INTO duplicate_flags "
+                      "(listing_id, duplicate_of_id, distance, same_seller, created_at) VALUES (?, ?, ?, ?, ?)";
+    if (sqlite3_prepare_v2(db_->getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    bool ok = true;
+    time_t now = time(nullptr);
+    for (const auto& match : matches) {
+        sqlite3_bind_int(stmt, 1, listingId);
+        sqlite3_bind_int(stmt, 2, match.listingId);
+        sqlite3_bind_int(stmt, 3, match.distance);
+        sqlite3_bind_int(stmt, 4, match.sellerId == sellerId ? 1 : 0);
+        sqlite3_bind_int64(stmt, 5, now);
+        ok = sqlite3_step(stmt) == SQLITE_DONE && ok;
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+size_t DuplicateIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void DuplicateIndex::onListingChanged(const Listing* before, const Listing* after) {
+    // Зміна статусу чи лічильників відбиток не змінює
+    if (before && after && before->getSimHash() == after->getSimHash()) return;
+    
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (before) {
+        removeLocked(before->getId());
+    }
+    if (after && after->getSimHash() != 0) {
+        insertLocked(after->getId(), after->getSimHash(), after->getSellerId());
+    }
+}
@@ -0,0 +1,64 @@
+// FILE: backend/src/services/DuplicateIndex.h
+#pragma once
+#include "../database/Database.h"
+#include "../repositories/ListingRepository.h"
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Кандидат у дублікати
+struct DuplicateMatch {
+    int listingId;
+    int sellerId;
+    int distance; // Відстань Хеммінга між відбитками
+};
+
+// Клас DuplicateIndex - індекс SimHash відбитків оголошень для пошуку майже однакових описів.
+// Відбиток ділиться на 8 смуг по 8 біт; за принципом Діріхле відбитки з відстанню <= 7
+// збігаються хоча б в одній смузі, тож кандидати - це вміст 8 кошиків, а не всі оголошення.
+// Індекс оновлюється як спостерігач ListingRepository.
+class DuplicateIndex : public IListingObserver {
+public:
+    static const int kBands = 8;
+    static const int kBandBits = 64 / kBands;
+    static const int kMaxDistance = kBands - 1;
+
+private:
+    struct Entry {
+        uint64_t simHash;
+        int listingId;
+        int sellerId;
+    };
+    
+    std::shared_ptr<Database> db_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<int, Entry> entries_;
+    // Кошики зберігають копію відбитка - перевірка кандидата без звернення до entries_
+    std::unordered_map<uint16_t, std::vector<Entry>> buckets_[kBands];
+
+public:
+    explicit DuplicateIndex(std::shared_ptr<Database> db);
+    
+    // Завантаження відбитків з БД; оголошенням без відбитка він обчислюється та зберігається
+    bool load();
+    
+    // Оголошення з відбитком на відстані <= kMaxDistance (крім самого оголошення)
+    std::vector<DuplicateMatch> findDuplicates(int listingId) const;
+    std::vector<DuplicateMatch> findSimilar(uint64_t simHash, int excludeId) const;
+    
+    // Запис знайдених збігів у duplicate_flags для модераторів
+    bool flagDuplicates(int listingId, const std::vector<DuplicateMatch>& matches);
+    
+    size_t size() const;
+    
+    void onListingChanged(const Listing* before, const Listing* after) override;
+
+private:
+    static uint16_t band(uint64_t simHash, int index) {
+        return static_cast<uint16_t>((simHash >> (index * kBandBits)) & ((1u << kBandBits) - 1));
+    }
+    void insertLocked(int listingId, uint64_t simHash, int sellerId);
+    void removeLocked(int listingId);
+};
@@ -0,0 +1,156 @@
+// FILE: backend/src/services/EventHub.cpp
+#include "EventHub.h"
+
+const int EventHub::kChannelGraceSeconds;
+
+EventHub::EventHub(size_t maxConnections)
+    : maxConnections_(maxConnections), connections_(0), stopping_(false), nextEventId_(1),
+      published_(0), delivered_(0), rejected_(0), deliveryMicrosTotal_(0), deliveryMicrosMax_(0) {
+}
+
+void EventHub::publish(int userId, const std::string& type, const std::string& jsonData) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) return;
+    auto it = channels_.find(userId);
+    // Користувач не підключений - стан прочитає через REST при наступному відкритті
+    if (it == channels_.end()) return;
+
+    Channel& channel = *it->second;
+    channel.events.push_back({nextEventId_++, type, jsonData, std::chrono::steady_clock::now()});
+    if (channel.events.size() > kBufferSize) {
+        channel.droppedUpTo = channel.events.front().id;
+        channel.events.pop_front();
+    }
+    published_.fetch_add(1, std::memory_order_relaxed);
+    channel.cv.notify_all();
+}
+
+bool EventHub::connect(int userId, uint64_t& currentEventId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || connections_ >= maxConnections_) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    sweepIdleLocked();
+
+    auto& channel = channels_[userId];
+    if (!channel) {
+        channel.reset(new Channel());
+    }
+    channel->subscribers++;
+    connections_++;
+    currentEventId = nextEventId_ - 1;
+    return true;
+}
+
+void EventHub::disconnect(int userId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = channels_.find(userId);
+    if (it == channels_.end() || it->second->subscribers == 0) return;
+    if (--it->second->subscribers == 0) {
+        it->second->idleSince = std::chrono::steady_clock::now();
+    }
+    connections_--;
+}
+
+void EventHub::sweepIdleLocked() {
+    auto deadline = std::chrono::steady_clock::now() - std::chrono::seconds(kChannelGraceSeconds);
+    for (auto it = channels_.begin(); it != channels_.end();) {
+        if (it->second->subscribers == 0 && it->second->idleSince < deadline) {
+            it = channels_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void EventHub::collectLocked(Channel& channel, uint64_t lastEventId, std::vector<HubEvent>& out) {
+    if (lastEventId < channel.droppedUpTo) {
+        // Частина подій витіснена з буфера - клієнт має перечитати стан
+        out.push_back({channel.droppedUpTo, "resync", "{}", std::chrono::steady_clock::now()});
+    }
+    for (const auto& event : channel.events) {
+        if (event.id > lastEventId) {
+            out.push_back(event);
+        }
+    }
+}
+
+std::vector<HubEvent> EventHub::waitForEvents(int userId, uint64_t lastEventId, std::chrono::milliseconds timeout) {
+    std::vector<HubEvent> events;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = channels_.find(userId);
+        if (it == channels_.end()) return events;
+        // Канал не видаляється, поки є підписники (а той, хто чекає, - підписник)
+        Channel& channel = *it->second;
+
+        collectLocked(channel, lastEventId, events);
+        if (events.empty() && !stopping_) {
+            channel.cv.wait_for(lock, timeout, [this, &channel, lastEventId] {
+                return stopping_ || (!channel.events.empty() && channel.events.back().id > lastEventId);
+            });
+            collectLocked(channel, lastEventId, events);
+        }
+    }
+    recordDelivery(events);
+    return events;
+}
+
+void EventHub::recordDelivery(const std::vector<HubEvent>& events) {
+    if (events.empty()) return;
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& event : events) {
+        uint64_t micros = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - event.publishedAt).count());
+        deliveryMicrosTotal_.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t max = deliveryMicrosMax_.load(std::memory_order_relaxed);
+        while (micros > max && !deliveryMicrosMax_.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+        }
+    }
+    delivered_.fetch_add(events.size(), std::memory_order_relaxed);
+}
+
+void EventHub::shutdown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (auto& entry : channels_) {
+        entry.second->cv.notify_all();
+    }
+}
+
+bool EventHub::isStopping() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stopping_;
+}
+
+EventHubStats EventHub::getStats() {
+    EventHubStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.connections = connections_;
+        stats.channels = channels_.size();
+    }
+    stats.maxConnections = maxConnections_;
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.delivered = delivered_.load(std::memory_order_relaxed);
+    stats.rejectedConnections = rejected_.load(std::memory_order_relaxed);
+    stats.avgDeliveryMs = stats.delivered > 0
+        ? deliveryMicrosTotal_.load(std::memory_order_relaxed) / 1000.0 / stats.delivered : 0.0;
+    stats.maxDeliveryMs = deliveryMicrosMax_.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+std::string EventHub::formatSse(const HubEvent& event) {
+    std::string out = "id: " + std::to_string(event.id) + "\nevent: " + event.type + "\ndata: ";
+    // Перенос рядка в data розбивається на кілька рядків data:
+    for (char c : event.data) {
+        if (c == '\n') {
+            out += "\ndata: ";
+        } else {
+            out += c;
+        }
+    }
+    out += "\n\n";
+    return out;
+}
@@ -0,0 +1,97 @@
+// FILE: backend/src/services/EventHub.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Подія для користувача (SSE: id / event / data)
+struct HubEvent {
+    uint64_t id;      // Глобально зростаючий; клієнт повертає його як Last-Event-ID
+    std::string type; // "message", "notification", "purchase_request", "resync"
+    std::string data; // JSON
+    std::chrono::steady_clock::time_point publishedAt;
+};
+
+// Стан хаба для моніторингу
+struct EventHubStats {
+    size_t connections;
+    size_t maxConnections;
+    size_t channels;
+    uint64_t published;
+    uint64_t delivered;
+    uint64_t rejectedConnections;
+    double avgDeliveryMs; // Від publish до передачі підписнику
+    double maxDeliveryMs;
+};
+
+// Клас EventHub - доставка подій користувачам у процесі (SSE / long-poll).
+// Кожен користувач має канал з кільцевим буфером останніх kBufferSize подій:
+// підписник, що перепідключився з Last-Event-ID, отримує пропущене з буфера,
+// а якщо частину вже витіснено - подію "resync" (дочитати стан через REST).
+// Кількість одночасних підключень обмежена: кожне тримає потік HTTP сервера.
+class EventHub {
+public:
+    static const size_t kBufferSize = 64;
+    static const int kChannelGraceSeconds = 120; // Канал без підписників живе стільки після відключення
+
+private:
+    struct Channel {
+        std::deque<HubEvent> events;
+        uint64_t droppedUpTo = 0; // Найбільший id витісненої з буфера події
+        size_t subscribers = 0;
+        std::chrono::steady_clock::time_point idleSince;
+        std::condition_variable cv;
+    };
+
+    const size_t maxConnections_;
+    std::mutex mutex_;
+    std::unordered_map<int, std::unique_ptr<Channel>> channels_;
+    size_t connections_;
+    bool stopping_;
+    uint64_t nextEventId_;
+
+    std::atomic<uint64_t> published_;
+    std::atomic<uint64_t> delivered_;
+    std::atomic<uint64_t> rejected_;
+    std::atomic<uint64_t> deliveryMicrosTotal_;
+    std::atomic<uint64_t> deliveryMicrosMax_;
+
+public:
+    explicit EventHub(size_t maxConnections);
+
+    EventHub(const EventHub&) = delete;
+    EventHub& operator=(const EventHub&) = delete;
+
+    // Подія потрапляє лише в канали користувачів, що підключались нещодавно
+    void publish(int userId, const std::string& type, const std::string& jsonData);
+
+    // Зайняти / звільнити місце підписника (false - ліміт підключень або зупинка).
+    // currentEventId - останній виданий id: з нього починає клієнт без Last-Event-ID.
+    bool connect(int userId, uint64_t& currentEventId);
+    void disconnect(int userId);
+
+    // Події з id > lastEventId; чекає до timeout, якщо нових немає.
+    // Порожній результат - таймаут (heartbeat) або зупинка хаба.
+    std::vector<HubEvent> waitForEvents(int userId, uint64_t lastEventId, std::chrono::milliseconds timeout);
+
+    // Будить усіх підписників і відхиляє нові підключення (перед зупинкою сервера)
+    void shutdown();
+    bool isStopping();
+
+    EventHubStats getStats();
+
+    // Форматування події для text/event-stream
+    static std::string formatSse(const HubEvent& event);
+
+private:
+    void collectLocked(Channel& channel, uint64_t lastEventId, std::vector<HubEvent>& out);
+    void recordDelivery(const std::vector<HubEvent>& events);
+    void sweepIdleLocked();
+};
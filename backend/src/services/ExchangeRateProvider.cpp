@@ -0,0 +1,50 @@
+// FILE: backend/src/services/ExchangeRateProvider.cpp
+#include "ExchangeRateProvider.h"
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+StaticExchangeRateProvider::StaticExchangeRateProvider(double usdToUah, double eurToUah)
+    : usdToUah_(usdToUah), eurToUah_(eurToUah) {
+}
+
+bool StaticExchangeRateProvider::fetch(ExchangeRate& rate) {
+    rate.usdToUah = usdToUah_;
+    rate.eurToUah = eurToUah_;
+    rate.eurToUsd = rate.eurToUah / rate.usdToUah;
+    time(&rate.lastUpdate);
+    return true;
+}
+
+FileExchangeRateProvider::FileExchangeRateProvider(const std::string& path) : path_(path) {
+}
+
+bool FileExchangeRateProvider::fetch(ExchangeRate& rate) {
+    std::ifstream file(path_);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string content = buffer.str();
+    
+    std::regex usdRegex("\"USD\"\\s*:\\s*([\\d.]+)");
+    std::regex eurRegex("\"EUR\"\\s*:\\s*([\\d.]+)");
+    std::smatch match;
+    double usd = 0.0, eur = 0.0;
+    try {
+        if (std::regex_search(content, match, usdRegex)) usd = std::stod(match[1]);
+        if (std::regex_search(content, match, eurRegex)) eur = std::stod(match[1]);
+    } catch (...) {
+        return false;
+    }
+    if (usd <= 0 || eur <= 0) {
+        return false;
+    }
+    
+    rate.usdToUah = usd;
+    rate.eurToUah = eur;
+    rate.eurToUsd = eur / usd;
+    time(&rate.lastUpdate);
+    return true;
+}
@@ -0,0 +1,48 @@
+// FILE: backend/src/services/ExchangeRateProvider.h
+#pragma once
+#include <ctime>
+#include <string>
+
+// Структура для курсу валют
+struct ExchangeRate {
+    double usdToUah;
+    double eurToUah;
+    double eurToUsd;
+    time_t lastUpdate;
+};
+
+// Інтерфейс джерела курсів валют
+class IExchangeRateProvider {
+public:
+    virtual ~IExchangeRateProvider() = default;
+    
+    // Отримання актуальних курсів; false - джерело недоступне
+    virtual bool fetch(ExchangeRate& rate) = 0;
+    virtual std::string getName() const = 0;
+};
+
+// Фіксовані курси (заглушка замість HTTP запиту до ПриватБанку)
+class StaticExchangeRateProvider : public IExchangeRateProvider {
+private:
+    double usdToUah_;
+    double eurToUah_;
+
+public:
+    StaticExchangeRateProvider(double usdToUah = 37.5, double eurToUah = 40.2);
+    
+    bool fetch(ExchangeRate& rate) override;
+    std::string getName() const override { return "static"; }
+};
+
+// Курси з локального JSON файлу, напр. {"USD": 37.5, "EUR": 40.2}.
+// Файл може оновлювати зовнішній cron або локальний проксі до API банку.
+class FileExchangeRateProvider : public IExchangeRateProvider {
+private:
+    std::string path_;
+
+public:
+    explicit FileExchangeRateProvider(const std::string& path);
+    
+    bool fetch(ExchangeRate& rate) override;
+    std::string getName() const override { return "file:" + path_; }
+};
@@ -0,0 +1,291 @@
+// FILE: backend/src/services/FeatureIndex.cpp
+#include "FeatureIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <queue>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Ваги ознак: квадрат ваги - внесок повної розбіжності в відстань
+const float kPriceWeight = 2.0f;
+const float kYearWeight = 1.5f;
+const float kMileageWeight = 1.0f;
+const float kVolumeWeight = 0.7f;
+const float kPowerWeight = 0.7f;
+const float kCategoryWeight = 0.5f;
+
+const char* const kFuelTypes[] = {"petrol", "diesel", "electric", "hybrid"};
+const char* const kTransmissions[] = {"manual", "automatic", "robot"};
+const char* const kBodyTypeNames[] = {"sedan", "hatchback", "suv", "coupe", "wagon", "van"};
+
+float clamp01(double value) {
+    return static_cast<float>(std::min(1.0, std::max(0.0, value)));
+}
+
+template <size_t N>
+size_t oneHot(const std::string& value, const char* const (&values)[N], float* out) {
+    for (size_t i = 0; i < N; ++i) {
+        out[i] = value == values[i] ? kCategoryWeight : 0.0f;
+    }
+    return N;
+}
+
+} // namespace
+
+void FeatureIndex::encode(const Features& f, int16_t* encoded) {
+    float out[kDims];
+    size_t d = 0;
+    // Ціна: 10 тис. .. 10 млн грн на лог. шкалі
+    out[d++] = kPriceWeight * clamp01((std::log10(std::max(1.0, f.priceUah)) - 4.0) / 3.0);
+    out[d++] = kYearWeight * clamp01((f.year - 1980) / 50.0);
+    out[d++] = kMileageWeight * clamp01(f.mileage / 500000.0);
+    // Не вказані об'єм/потужність - типові значення, щоб не штрафувати за пропуск
+    out[d++] = kVolumeWeight * clamp01((f.engineVolume > 0 ? f.engineVolume : 2.0) / 8.0);
+    out[d++] = kPowerWeight * clamp01((f.enginePower > 0 ? f.enginePower : 150) / 600.0);
+    d += oneHot(f.fuelType, kFuelTypes, out + d);
+    d += oneHot(f.transmission, kTransmissions, out + d);
+    d += oneHot(f.bodyType, kBodyTypeNames, out + d);
+    for (; d < kDims; ++d) {
+        out[d] = 0.0f;
+    }
+    // Усі ознаки в [0, 2]: різниця <= 2 * kScale, сума квадратів по 24 вимірах вміщається в int32
+    for (d = 0; d < kDims; ++d) {
+        encoded[d] = static_cast<int16_t>(std::lround(out[d] * kScale));
+    }
+}
+
+uint8_t FeatureIndex::priceBandOf(double priceUah) {
+    int band = static_cast<int>((std::log10(std::max(1.0, priceUah)) - 4.0) * 4.0);
+    return static_cast<uint8_t>(std::min(kPriceBands - 1, std::max(0, band)));
+}
+
+uint8_t FeatureIndex::bodyTypeCode(const std::string& bodyType) {
+    for (size_t i = 0; i < sizeof(kBodyTypeNames) / sizeof(kBodyTypeNames[0]); ++i) {
+        if (bodyType == kBodyTypeNames[i]) return static_cast<uint8_t>(i + 1);
+    }
+    return 0;
+}
+
+uint16_t FeatureIndex::findRegionCode(const std::string& region) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = regionCodes_.find(region);
+    return it != regionCodes_.end() ? it->second : 0;
+}
+
+uint16_t FeatureIndex::regionCodeLocked(const std::string& region) {
+    if (region.empty()) return 0;
+    auto it = regionCodes_.find(region);
+    if (it != regionCodes_.end()) return it->second;
+    if (regionCodes_.size() >= 0xFFFE) return 0;
+    uint16_t code = static_cast<uint16_t>(regionCodes_.size() + 1);
+    regionCodes_.emplace(region, code);
+    return code;
+}
+
+FeatureIndex::Features FeatureIndex::featuresOf(const Listing& listing) {
+    Features f;
+    double rate = listing.getCurrencyCode() != Currency::UAH && listing.getExchangeRate() > 0
+                ? listing.getExchangeRate() : 1.0;
+    f.priceUah = listing.getPrice() * rate;
+    f.year = listing.getYear();
+    f.mileage = listing.getMileage();
+    f.engineVolume = listing.getEngineVolume();
+    f.enginePower = listing.getEnginePower();
+    f.fuelType = listing.getFuelType();
+    f.transmission = listing.getTransmission();
+    f.bodyType = listing.getBodyType();
+    return f;
+}
+
+bool FeatureIndex::load(Database& db) {
+    const char* sql = "SELECT id, price, currency, exchange_rate, year, mileage, engine_volume, engine_power, "
+                      "fuel_type, transmission, body_type, brand_id, model_id, seller_id, region "
+                      "FROM listings WHERE status = 'active'";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db.getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load feature index: " << sqlite3_errmsg(db.getHandle()) << std::endl;
+        return false;
+    }
+    
+    auto text = [stmt](int column) {
+        const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+        return std::string(value ? value : "");
+    };
+    
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    vectors_.clear();
+    ids_.clear();
+    attributes_.clear();
+    rowOf_.clear();
+    int16_t vector[kDims];
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Features f;
+        double price = sqlite3_column_double(stmt, 1);
+        double rate = sqlite3_column_double(stmt, 3);
+        f.priceUah = parseCurrency(text(2)) != Currency::UAH && rate > 0 ? price * rate : price;
+        f.year = sqlite3_column_int(stmt, 4);
+        f.mileage = sqlite3_column_int(stmt, 5);
+        f.engineVolume = sqlite3_column_double(stmt, 6);
+        f.enginePower = sqlite3_column_int(stmt, 7);
+        f.fuelType = text(8);
+        f.transmission = text(9);
+        f.bodyType = text(10);
+        encode(f, vector);
+        Attributes attributes;
+        attributes.brandId = sqlite3_column_int(stmt, 11);
+        attributes.modelId = sqlite3_column_int(stmt, 12);
+        attributes.sellerId = sqlite3_column_int(stmt, 13);
+        attributes.region = regionCodeLocked(text(14));
+        attributes.priceBand = priceBandOf(f.priceUah);
+        attributes.bodyType = bodyTypeCode(f.bodyType);
+        upsertLocked(sqlite3_column_int(stmt, 0), vector, attributes);
+    }
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+void FeatureIndex::upsertLocked(int listingId, const int16_t* vector, const Attributes& attributes) {
+    auto it = rowOf_.find(listingId);
+    size_t row;
+    if (it != rowOf_.end()) {
+        row = it->second;
+    } else {
+        row = ids_.size();
+        ids_.push_back(listingId);
+        attributes_.emplace_back();
+        vectors_.resize(vectors_.size() + kDims);
+        rowOf_[listingId] = row;
+    }
+    std::copy(vector, vector + kDims, vectors_.begin() + row * kDims);
+    attributes_[row] = attributes;
+}
+
+void FeatureIndex::removeLocked(int listingId) {
+    auto it = rowOf_.find(listingId);
+    if (it == rowOf_.end()) return;
+    
+    // Останній рядок переноситься на місце видаленого - масив лишається неперервним
+    size_t row = it->second;
+    size_t last = ids_.size() - 1;
+    if (row != last) {
+        std::copy(vectors_.begin() + last * kDims, vectors_.begin() + (last + 1) * kDims,
+                  vectors_.begin() + row * kDims);
+        ids_[row] = ids_[last];
+        attributes_[row] = attributes_[last];
+        rowOf_[ids_[row]] = row;
+    }
+    ids_.pop_back();
+    attributes_.pop_back();
+    vectors_.resize(last * kDims);
+    rowOf_.erase(it);
+}
+
+std::vector<SimilarListing> FeatureIndex::findSimilar(const Listing& listing, size_t k) const {
+    int16_t query[kDims];
+    encode(featuresOf(listing), query);
+    return findNearest(query, k, listing.getId());
+}
+
+std::vector<SimilarListing> FeatureIndex::findNearest(const int16_t* query, size_t k, int excludeId) const {
+    std::vector<SimilarListing> result;
+    if (k == 0) return result;
+    
+    // Max-купа з k найкращих: новий рядок порівнюється лише з вершиною
+    struct Candidate {
+        int32_t distance;
+        int listingId;
+        bool operator<(const Candidate& other) const { return distance < other.distance; }
+    };
+    std::priority_queue<Candidate> best;
+    
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const int16_t* rows = vectors_.data();
+    const size_t count = ids_.size();
+    
+#if defined(__SSE2__)
+    static_assert(kDims == 24, "SSE kernel expects 3 x 8 int16 lanes");
+    const __m128i q0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(query));
+    const __m128i q1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(query + 8));
+    const __m128i q2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(query + 16));
+#endif
+    
+    for (size_t i = 0; i < count; ++i) {
+        const int16_t* row = rows + i * kDims;
+        int32_t distance;
+#if defined(__SSE2__)
+        // madd_epi16: попарні суми квадратів різниць одразу в int32
+        __m128i d0 = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)), q0);
+        __m128i d1 = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 8)), q1);
+        __m128i d2 = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 16)), q2);
+        __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(d0, d0), _mm_madd_epi16(d1, d1)),
+                                    _mm_madd_epi16(d2, d2));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        distance = _mm_cvtsi128_si32(sum);
+#else
+        distance = 0;
+        for (size_t j = 0; j < kDims; ++j) {
+            int32_t diff = row[j] - query[j];
+            distance += diff * diff;
+        }
+#endif
+        if (best.size() < k) {
+            if (ids_[i] != excludeId) best.push({distance, ids_[i]});
+        } else if (distance < best.top().distance && ids_[i] != excludeId) {
+            best.pop();
+            best.push({distance, ids_[i]});
+        }
+    }
+    lock.unlock();
+    
+    const float norm = 1.0f / (static_cast<float>(kScale) * kScale);
+    result.resize(best.size());
+    for (size_t i = result.size(); i-- > 0;) {
+        result[i] = {best.top().listingId, best.top().distance * norm};
+        best.pop();
+    }
+    return result;
+}
+
+size_t FeatureIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return ids_.size();
+}
+
+void FeatureIndex::onListingChanged(const Listing* before, const Listing* after) {
+    // Зміна, що не зачіпає ознак і статусу (лічильники, фото, опис), вектор не змінює
+    const uint32_t indexed = ListingField::BrandId | ListingField::ModelId | ListingField::Year |
+                             ListingField::Price | ListingField::Currency | ListingField::ExchangeRate |
+                             ListingField::Region | ListingField::Mileage | ListingField::FuelType |
+                             ListingField::Transmission | ListingField::EngineVolume | ListingField::BodyType |
+                             ListingField::EnginePower;
+    if (before && after && before->getStatusCode() == after->getStatusCode() &&
+        (after->getDirtyFields() & indexed) == 0) {
+        return;
+    }
+    
+    // В індексі лише активні оголошення
+    if (after && after->getStatusCode() == ListingStatus::Active) {
+        Features f = featuresOf(*after);
+        int16_t vector[kDims];
+        encode(f, vector);
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Attributes attributes;
+        attributes.brandId = after->getBrandId();
+        attributes.modelId = after->getModelId();
+        attributes.sellerId = after->getSellerId();
+        attributes.region = regionCodeLocked(after->getRegion());
+        attributes.priceBand = priceBandOf(f.priceUah);
+        attributes.bodyType = bodyTypeCode(f.bodyType);
+        upsertLocked(after->getId(), vector, attributes);
+    } else if (before) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        removeLocked(before->getId());
+    }
+}
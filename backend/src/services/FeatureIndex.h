@@ -0,0 +1,98 @@
+// FILE: backend/src/services/FeatureIndex.h
+#pragma once
+#include "../database/Database.h"
+#include "../repositories/ListingRepository.h"
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Схоже оголошення з індексу ознак
+struct SimilarListing {
+    int listingId;
+    float distance; // Квадрат зваженої евклідової відстані
+};
+
+// Клас FeatureIndex - пошук схожих оголошень (kNN) за числовими ознаками.
+// Кожне активне оголошення - вектор з kDims ознак: нормовані ціна (UAH, лог. шкала),
+// рік, пробіг, об'єм та потужність двигуна з вагами, плюс one-hot паливо, КПП і кузов.
+// Ознаки зберігаються як int16 з фіксованою точкою (48 байт на рядок) в одному
+// неперервному масиві; пошук - повний перебір з SSE2 (_mm_madd_epi16).
+// Індекс оновлюється як спостерігач ListingRepository.
+class FeatureIndex : public IListingObserver {
+public:
+    static const size_t kDims = 24; // 18 ознак + вирівнювання до 8 int16 (SSE)
+    static const int kScale = 4096; // Фіксована точка: значення ознаки * kScale
+
+    // Сирі ознаки оголошення
+    struct Features {
+        double priceUah;
+        int year;
+        int mileage;
+        double engineVolume;
+        int enginePower;
+        std::string fuelType;
+        std::string transmission;
+        std::string bodyType;
+    };
+    
+    static const int kPriceBands = 16; // Чверть порядку: 10 тис. .. 10 млн грн
+    static const int kBodyTypes = 7;   // 0 - не вказано, 1..6 - kBodyTypes
+    
+    // Категоріальні атрибути рядка - для скорингу кандидатів (персональні рекомендації)
+    struct Attributes {
+        int brandId;
+        int modelId;
+        int sellerId;
+        uint16_t region;   // Код з regionCodes_, 0 - не вказано
+        uint8_t priceBand;
+        uint8_t bodyType;
+    };
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::vector<int16_t> vectors_;         // rows * kDims
+    std::vector<int> ids_;                 // Оголошення в кожному рядку
+    std::vector<Attributes> attributes_;   // Паралельно з ids_
+    std::unordered_map<int, size_t> rowOf_;
+    std::unordered_map<std::string, uint16_t> regionCodes_; // Лише зростає
+
+public:
+    FeatureIndex() = default;
+    
+    // Завантаження всіх активних оголошень
+    bool load(Database& db);
+    
+    // k найближчих активних оголошень до даного (саме оголошення виключається)
+    std::vector<SimilarListing> findSimilar(const Listing& listing, size_t k) const;
+    std::vector<SimilarListing> findNearest(const int16_t* query, size_t k, int excludeId) const;
+    
+    size_t size() const;
+    
+    // Один прохід по всіх рядках під спільним блокуванням: fn(listingId, attributes)
+    template <typename Fn>
+    void forEachRow(Fn&& fn) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            fn(ids_[i], attributes_[i]);
+        }
+    }
+    
+    // Код регіону для порівняння з Attributes::region (0 - невідомий)
+    uint16_t findRegionCode(const std::string& region) const;
+    
+    // Фіксована нормалізація ознак у вектор з kDims int16
+    static void encode(const Features& features, int16_t* out);
+    static Features featuresOf(const Listing& listing);
+    static uint8_t priceBandOf(double priceUah);
+    static uint8_t bodyTypeCode(const std::string& bodyType);
+    
+    void onListingChanged(const Listing* before, const Listing* after) override;
+
+private:
+    uint16_t regionCodeLocked(const std::string& region);
+    void upsertLocked(int listingId, const int16_t* vector, const Attributes& attributes);
+    void removeLocked(int listingId);
+};
@@ -0,0 +1,499 @@
+// FILE: backend/src/services/ListingFacetIndex.cpp
+#include "ListingFacetIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <queue>
+
+struct ListingFacetIndex::Predicate {
+    std::vector<const RoaringBitmap*> parts; // Усі рядки підходять
+    std::vector<const RoaringBitmap*> edges; // Рядки перевіряються test
+    std::function<bool(const Row&)> test;
+    size_t estimate = 0; // Верхня оцінка кількості рядків
+    // Діапазон: бакети повністю поза ним. Широкий діапазон дешевше застосувати
+    // відніманням цих бакетів, ніж об'єднанням тих, що всередині
+    bool complementable = false;
+    std::vector<const RoaringBitmap*> excluded;
+    size_t excludedCount = 0;
+
+    bool complementCheaper() const { return complementable && excludedCount < estimate; }
+};
+
+namespace {
+
+// Перевірка рядків замість побудови бітмапа, якщо поточна множина
+// у стільки разів менша за оцінку предиката
+const size_t kRowTestRatio = 8;
+
+// До цього розміру множини сторінка - перебір з купою, більші - обхід бакетів ключа
+const size_t kHeapScanMax = 4096;
+
+bool isUnset(double bound) {
+    return bound <= 0;
+}
+
+} // namespace
+
+size_t ListingFacetIndex::RangeFacet::bucketOf(double value) const {
+    auto it = std::upper_bound(bounds.begin(), bounds.end(), value);
+    return it == bounds.begin() ? 0 : static_cast<size_t>(it - bounds.begin()) - 1;
+}
+
+ListingFacetIndex::ListingFacetIndex() {
+    auto linear = [](RangeField field, bool integral, double from, double to, double step) {
+        RangeFacet facet;
+        facet.field = field;
+        facet.integral = integral;
+        for (int i = 0; from + i * step <= to; ++i) {
+            facet.bounds.push_back(from + i * step);
+        }
+        facet.buckets.resize(facet.bounds.size());
+        return facet;
+    };
+    ranges_.push_back(linear(RangeField::Year, true, 1950, 2030, 1));
+    ranges_.push_back(linear(RangeField::Mileage, true, 0, 1000000, 10000));
+    ranges_.push_back(linear(RangeField::EngineVolume, false, 0, 10, 0.2));
+    ranges_.push_back(linear(RangeField::EnginePower, true, 0, 1000, 10));
+
+    // Ціна - геометричні бакети (крок 25%): від 1 тис. до 1 млрд грн
+    RangeFacet price;
+    price.field = RangeField::PriceUah;
+    price.integral = false;
+    price.bounds.push_back(0);
+    for (double bound = 1000; bound <= 1e9; bound *= 1.25) {
+        price.bounds.push_back(std::round(bound));
+    }
+    price.buckets.resize(price.bounds.size());
+    ranges_.push_back(std::move(price));
+
+    // Дата створення - лише для сортування: тижневі бакети 2015-2040
+    ranges_.push_back(linear(RangeField::CreatedAt, true, 1420070400, 2208988800, 7 * 24 * 3600));
+}
+
+double ListingFacetIndex::rangeValue(const Row& row, RangeField field) {
+    switch (field) {
+        case RangeField::Year: return row.year;
+        case RangeField::Mileage: return row.mileage;
+        case RangeField::EngineVolume: return row.engineVolume;
+        case RangeField::EnginePower: return row.enginePower;
+        case RangeField::PriceUah: return row.priceUah;
+        case RangeField::CreatedAt: return static_cast<double>(row.createdAt);
+    }
+    return 0;
+}
+
+bool ListingFacetIndex::load(Database& db) {
+    const char* sql = "SELECT id, brand_id, model_id, region_id, fuel_type, transmission, body_type, color, "
+                      "year, mileage, engine_power, engine_volume, price_uah, price, currency, exchange_rate, "
+                      "created_at FROM listings WHERE status = 'active'";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db.getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load facet index: " << sqlite3_errmsg(db.getHandle()) << std::endl;
+        return false;
+    }
+
+    auto text = [stmt](int column) {
+        const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+        return std::string(value ? value : "");
+    };
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    rows_.clear();
+    freeOrdinals_.clear();
+    ordinalOf_.clear();
+    all_.clear();
+    for (ValueBitmaps* bitmaps : {&brands_, &models_, &regions_, &fuelTypes_, &transmissions_, &bodyTypes_, &colors_}) {
+        bitmaps->clear();
+    }
+    for (RangeFacet& facet : ranges_) {
+        for (RoaringBitmap& bucket : facet.buckets) {
+            bucket.clear();
+        }
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Row row;
+        row.listingId = sqlite3_column_int(stmt, 0);
+        row.brandId = sqlite3_column_int(stmt, 1);
+        row.modelId = sqlite3_column_int(stmt, 2);
+        row.regionId = sqlite3_column_int(stmt, 3);
+        row.fuelType = codeLocked(text(4));
+        row.transmission = codeLocked(text(5));
+        row.bodyType = codeLocked(text(6));
+        row.color = codeLocked(text(7));
+        row.year = sqlite3_column_int(stmt, 8);
+        row.mileage = sqlite3_column_int(stmt, 9);
+        row.enginePower = sqlite3_column_int(stmt, 10);
+        row.engineVolume = sqlite3_column_double(stmt, 11);
+        if (sqlite3_column_type(stmt, 12) != SQLITE_NULL) {
+            row.priceUah = sqlite3_column_double(stmt, 12);
+        } else {
+            // Рядок до дозаповнення price_uah - той самий розрахунок, що й у FeatureIndex
+            double price = sqlite3_column_double(stmt, 13);
+            double rate = sqlite3_column_double(stmt, 15);
+            row.priceUah = parseCurrency(text(14)) != Currency::UAH && rate > 0 ? price * rate : price;
+        }
+        row.createdAt = sqlite3_column_int64(stmt, 16);
+        upsertLocked(row);
+    }
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+int ListingFacetIndex::codeLocked(const std::string& value) {
+    if (value.empty()) return 0;
+    auto it = codes_.find(value);
+    if (it != codes_.end()) return it->second;
+    int code = static_cast<int>(codes_.size()) + 1;
+    codes_.emplace(value, code);
+    return code;
+}
+
+void ListingFacetIndex::indexLocked(uint32_t ordinal, const Row& row, bool add) {
+    auto apply = [ordinal, add](ValueBitmaps& bitmaps, int value) {
+        if (add) {
+            bitmaps[value].add(ordinal);
+            return;
+        }
+        auto it = bitmaps.find(value);
+        if (it != bitmaps.end()) {
+            it->second.remove(ordinal);
+            if (it->second.empty()) bitmaps.erase(it);
+        }
+    };
+    apply(brands_, row.brandId);
+    apply(models_, row.modelId);
+    apply(regions_, row.regionId);
+    apply(fuelTypes_, row.fuelType);
+    apply(transmissions_, row.transmission);
+    apply(bodyTypes_, row.bodyType);
+    apply(colors_, row.color);
+    for (RangeFacet& facet : ranges_) {
+        RoaringBitmap& bucket = facet.buckets[facet.bucketOf(rangeValue(row, facet.field))];
+        if (add) {
+            bucket.add(ordinal);
+        } else {
+            bucket.remove(ordinal);
+        }
+    }
+    if (add) {
+        all_.add(ordinal);
+    } else {
+        all_.remove(ordinal);
+    }
+}
+
+void ListingFacetIndex::upsertLocked(const Row& row) {
+    uint32_t ordinal;
+    auto it = ordinalOf_.find(row.listingId);
+    if (it != ordinalOf_.end()) {
+        ordinal = it->second;
+        indexLocked(ordinal, rows_[ordinal], false);
+    } else if (!freeOrdinals_.empty()) {
+        // Повторне використання ординалів тримає бітмапи щільними
+        ordinal = freeOrdinals_.back();
+        freeOrdinals_.pop_back();
+    } else {
+        ordinal = static_cast<uint32_t>(rows_.size());
+        rows_.push_back(Row());
+    }
+    rows_[ordinal] = row;
+    ordinalOf_[row.listingId] = ordinal;
+    indexLocked(ordinal, row, true);
+}
+
+void ListingFacetIndex::removeLocked(int listingId) {
+    auto it = ordinalOf_.find(listingId);
+    if (it == ordinalOf_.end()) return;
+    uint32_t ordinal = it->second;
+    indexLocked(ordinal, rows_[ordinal], false);
+    rows_[ordinal].listingId = 0;
+    freeOrdinals_.push_back(ordinal);
+    ordinalOf_.erase(it);
+}
+
+bool ListingFacetIndex::supports(const ListingFilter& filter, const std::string& sortBy) {
+    return filter.searchQuery.empty() && (filter.region.empty() || filter.regionId > 0) && sortBy != "view_count";
+}
+
+void ListingFacetIndex::addValuePredicate(const ValueBitmaps& bitmaps, const std::vector<int>& values,
+                                          int Row::*member, std::vector<Predicate>& predicates) {
+    if (values.empty()) return;
+    Predicate predicate;
+    for (int value : values) {
+        auto it = bitmaps.find(value);
+        if (it != bitmaps.end() &&
+            std::find(predicate.parts.begin(), predicate.parts.end(), &it->second) == predicate.parts.end()) {
+            predicate.parts.push_back(&it->second);
+            predicate.estimate += it->second.cardinality();
+        }
+    }
+    predicate.test = [values, member](const Row& row) {
+        return std::find(values.begin(), values.end(), row.*member) != values.end();
+    };
+    predicates.push_back(std::move(predicate));
+}
+
+void ListingFacetIndex::addCodedPredicate(const ValueBitmaps& bitmaps, const std::vector<std::string>& values,
+                                          int Row::*member, std::vector<Predicate>& predicates) const {
+    if (values.empty()) return;
+    // Значення, якого немає в жодному оголошенні, не має коду - і не дає рядків
+    std::vector<int> codes;
+    for (const auto& value : values) {
+        auto it = codes_.find(value);
+        if (it != codes_.end()) codes.push_back(it->second);
+    }
+    if (codes.empty()) {
+        predicates.push_back(Predicate());
+        predicates.back().test = [](const Row&) { return false; };
+        return;
+    }
+    addValuePredicate(bitmaps, codes, member, predicates);
+}
+
+void ListingFacetIndex::addRangePredicate(RangeField field, double min, double max,
+                                          std::vector<Predicate>& predicates) const {
+    if (isUnset(min) && isUnset(max)) return;
+    const RangeFacet& facet = ranges_[static_cast<size_t>(field)];
+    const double lo = isUnset(min) ? -std::numeric_limits<double>::infinity() : min;
+    const double hi = isUnset(max) ? std::numeric_limits<double>::infinity() : max;
+
+    Predicate predicate;
+    predicate.test = [field, lo, hi](const Row& row) {
+        double value = rangeValue(row, field);
+        return value >= lo && value <= hi;
+    };
+    if (lo <= hi) {
+        const size_t first = facet.bucketOf(lo);
+        const size_t last = facet.bucketOf(hi);
+        predicate.complementable = true;
+        for (size_t b = 0; b < facet.buckets.size(); ++b) {
+            const RoaringBitmap& bucket = facet.buckets[b];
+            if (bucket.empty()) continue;
+            if (b < first || b > last) {
+                predicate.excluded.push_back(&bucket);
+                predicate.excludedCount += bucket.cardinality();
+                continue;
+            }
+            // Бакет повністю в діапазоні, якщо обидві його межі всередині;
+            // для цілих верхня межа бакета - bounds[b+1] - 1
+            bool lowInside = b > 0 ? facet.bounds[b] >= lo : isUnset(min);
+            bool highInside = b + 1 < facet.bounds.size()
+                ? (facet.integral ? facet.bounds[b + 1] - 1 : facet.bounds[b + 1]) <= hi
+                : isUnset(max);
+            (lowInside && highInside ? predicate.parts : predicate.edges).push_back(&bucket);
+            predicate.estimate += bucket.cardinality();
+        }
+    }
+    predicates.push_back(std::move(predicate));
+}
+
+RoaringBitmap ListingFacetIndex::materialize(const Predicate& predicate) const {
+    RoaringBitmap result;
+    for (const RoaringBitmap* part : predicate.parts) {
+        result.unite(*part);
+    }
+    for (const RoaringBitmap* edge : predicate.edges) {
+        edge->forEach([&](uint32_t ordinal) {
+            if (predicate.test(rows_[ordinal])) result.add(ordinal);
+        });
+    }
+    return result;
+}
+
+void ListingFacetIndex::subtractExcluded(RoaringBitmap& matched, const Predicate& predicate) const {
+    for (const RoaringBitmap* bucket : predicate.excluded) {
+        matched.subtract(*bucket);
+    }
+    for (const RoaringBitmap* edge : predicate.edges) {
+        edge->forEach([&](uint32_t ordinal) {
+            if (!predicate.test(rows_[ordinal])) matched.remove(ordinal);
+        });
+    }
+}
+
+RoaringBitmap ListingFacetIndex::filterRows(const RoaringBitmap& candidates, const Predicate& predicate) const {
+    RoaringBitmap result;
+    candidates.forEach([&](uint32_t ordinal) {
+        if (predicate.test(rows_[ordinal])) result.add(ordinal);
+    });
+    return result;
+}
+
+bool ListingFacetIndex::query(const ListingFilter& filter, const std::string& sortBy, const std::string& sortOrder,
+                              int limit, int offset, ResultPage& page) const {
+    if (!supports(filter, sortBy)) return false;
+    page.total = 0;
+    page.ids.clear();
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    std::vector<Predicate> predicates;
+    addValuePredicate(brands_, filter.brandIds, &Row::brandId, predicates);
+    addValuePredicate(models_, filter.modelIds, &Row::modelId, predicates);
+    if (filter.regionId > 0) {
+        addValuePredicate(regions_, {filter.regionId}, &Row::regionId, predicates);
+    }
+    addCodedPredicate(fuelTypes_, filter.fuelTypes, &Row::fuelType, predicates);
+    addCodedPredicate(transmissions_, filter.transmissions, &Row::transmission, predicates);
+    addCodedPredicate(bodyTypes_, filter.bodyTypes, &Row::bodyType, predicates);
+    addCodedPredicate(colors_, filter.colors, &Row::color, predicates);
+    addRangePredicate(RangeField::PriceUah, filter.minPriceUah, filter.maxPriceUah, predicates);
+    addRangePredicate(RangeField::Year, filter.minYear, filter.maxYear, predicates);
+    addRangePredicate(RangeField::Mileage, filter.minMileage, filter.maxMileage, predicates);
+    addRangePredicate(RangeField::EngineVolume, filter.minEngineVolume, filter.maxEngineVolume, predicates);
+    addRangePredicate(RangeField::EnginePower, filter.minEnginePower, filter.maxEnginePower, predicates);
+
+    // Від найвужчого предиката: проміжна множина одразу мала, решта - дешеві перетини
+    // або перевірка кількох рядків замість об'єднання широких бакетів
+    std::sort(predicates.begin(), predicates.end(),
+              [](const Predicate& a, const Predicate& b) { return a.estimate < b.estimate; });
+
+    RoaringBitmap matched;
+    const RoaringBitmap* candidates = &all_;
+    if (!predicates.empty()) {
+        if (predicates.front().estimate == 0) return true;
+        const Predicate& first = predicates.front();
+        if (first.parts.size() == 1 && first.edges.empty()) {
+            matched = *first.parts.front();
+        } else if (first.complementCheaper()) {
+            matched = all_;
+            subtractExcluded(matched, first);
+        } else {
+            matched = materialize(first);
+        }
+        for (size_t i = 1; i < predicates.size() && !matched.empty(); ++i) {
+            const Predicate& next = predicates[i];
+            if (matched.cardinality() * kRowTestRatio < next.estimate) {
+                matched = filterRows(matched, next);
+            } else if (next.parts.size() == 1 && next.edges.empty()) {
+                matched = RoaringBitmap::intersect(matched, *next.parts.front());
+            } else if (next.complementCheaper()) {
+                subtractExcluded(matched, next);
+            } else {
+                matched = RoaringBitmap::intersect(matched, materialize(next));
+            }
+        }
+        candidates = &matched;
+    }
+
+    page.total = candidates->cardinality();
+    if (limit <= 0 || offset < 0 || static_cast<size_t>(offset) >= page.total) return true;
+
+    // Ключ сортування - як у SQL-гілці; однакові ключі впорядковуються за id
+    RangeField sortField = RangeField::CreatedAt;
+    if (sortBy == "price") sortField = RangeField::PriceUah;
+    if (sortBy == "year") sortField = RangeField::Year;
+    if (sortBy == "mileage") sortField = RangeField::Mileage;
+    const bool ascending = sortOrder == "ASC" || sortOrder == "asc";
+    const size_t keep = std::min(page.total, static_cast<size_t>(offset) + static_cast<size_t>(limit));
+
+    using Entry = std::pair<double, int>;
+    auto before = [ascending](const Entry& a, const Entry& b) { return ascending ? a < b : a > b; };
+    std::vector<Entry> taken;
+
+    if (candidates->cardinality() <= kHeapScanMax) {
+        // Мала множина - повний перебір з купою offset + limit найкращих
+        std::priority_queue<Entry, std::vector<Entry>, decltype(before)> best(before);
+        candidates->forEach([&](uint32_t ordinal) {
+            const Row& row = rows_[ordinal];
+            Entry entry(rangeValue(row, sortField), row.listingId);
+            if (best.size() < keep) {
+                best.push(entry);
+            } else if (before(entry, best.top())) {
+                best.pop();
+                best.push(entry);
+            }
+        });
+        while (!best.empty()) {
+            taken.push_back(best.top());
+            best.pop();
+        }
+    } else {
+        // Велика множина - бакети ключа вже впорядковані: беремо їх у порядку сортування,
+        // поки не наберемо сторінку; далі лише решта останнього бакета
+        const RangeFacet& facet = ranges_[static_cast<size_t>(sortField)];
+        for (size_t i = 0; i < facet.buckets.size() && taken.size() < keep; ++i) {
+            const RoaringBitmap& bucket = facet.buckets[ascending ? i : facet.buckets.size() - 1 - i];
+            if (bucket.empty()) continue;
+            auto take = [&](uint32_t ordinal) {
+                const Row& row = rows_[ordinal];
+                taken.emplace_back(rangeValue(row, sortField), row.listingId);
+            };
+            if (candidates == &all_) {
+                bucket.forEach(take);
+            } else {
+                RoaringBitmap::intersect(*candidates, bucket).forEach(take);
+            }
+        }
+    }
+    lock.unlock();
+
+    std::sort(taken.begin(), taken.end(), before);
+    taken.resize(std::min(taken.size(), keep));
+    for (size_t i = static_cast<size_t>(offset); i < taken.size(); ++i) {
+        page.ids.push_back(taken[i].second);
+    }
+    return true;
+}
+
+size_t ListingFacetIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return all_.cardinality();
+}
+
+size_t ListingFacetIndex::memoryBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    size_t total = rows_.capacity() * sizeof(Row) + all_.bytes();
+    for (const ValueBitmaps* bitmaps : {&brands_, &models_, &regions_, &fuelTypes_, &transmissions_, &bodyTypes_, &colors_}) {
+        for (const auto& entry : *bitmaps) {
+            total += entry.second.bytes();
+        }
+    }
+    for (const RangeFacet& facet : ranges_) {
+        for (const RoaringBitmap& bucket : facet.buckets) {
+            total += bucket.bytes();
+        }
+    }
+    return total;
+}
+
+void ListingFacetIndex::onListingChanged(const Listing* before, const Listing* after) {
+    // Зміна, що не зачіпає фасетів, сортування і статусу (лічильники, фото, опис), індекс не змінює
+    const uint32_t indexed = ListingField::BrandId | ListingField::ModelId | ListingField::Year |
+                             ListingField::Price | ListingField::Currency | ListingField::ExchangeRate |
+                             ListingField::Region | ListingField::RegionId | ListingField::Mileage |
+                             ListingField::FuelType | ListingField::Transmission | ListingField::Color |
+                             ListingField::EngineVolume | ListingField::BodyType | ListingField::EnginePower;
+    if (before && after && before->getStatusCode() == after->getStatusCode() &&
+        (after->getDirtyFields() & indexed) == 0) {
+        return;
+    }
+
+    // В індексі лише активні оголошення
+    if (after && after->getStatusCode() == ListingStatus::Active) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Row row;
+        row.listingId = after->getId();
+        row.brandId = after->getBrandId();
+        row.modelId = after->getModelId();
+        row.regionId = after->getRegionId();
+        row.fuelType = codeLocked(after->getFuelType());
+        row.transmission = codeLocked(after->getTransmission());
+        row.bodyType = codeLocked(after->getBodyType());
+        row.color = codeLocked(after->getColor());
+        row.year = after->getYear();
+        row.mileage = after->getMileage();
+        row.enginePower = after->getEnginePower();
+        row.engineVolume = after->getEngineVolume();
+        row.priceUah = after->getPriceInUAH();
+        row.createdAt = after->getCreatedAt();
+        upsertLocked(row);
+    } else if (before) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        removeLocked(before->getId());
+    }
+}
@@ -0,0 +1,118 @@
+// FILE: backend/src/services/ListingFacetIndex.h
+#pragma once
+#include "../database/Database.h"
+#include "../models/ListingFilter.h"
+#include "../repositories/ListingRepository.h"
+#include "../utils/RoaringBitmap.h"
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Клас ListingFacetIndex - бітмап-індекс активних оголошень для фільтрів каталогу.
+// Кожне активне оголошення має щільний ординал; для кожного значення марки, моделі,
+// регіону, палива, КПП, кузова та кольору - бітмап ординалів, для року, пробігу,
+// об'єму, потужності та ціни - бітмапи бакетів діапазону. Запит перетинає предикати
+// від найвужчого до найширшого; крайові бакети діапазонів перевіряються по значенню.
+// Сторінка відсортованої видачі береться з бакетів ключа сортування в їхньому порядку.
+// Індекс оновлюється як спостерігач ListingRepository.
+class ListingFacetIndex : public IListingObserver {
+public:
+    // Результат: кількість збігів і id сторінки в порядку сортування
+    struct ResultPage {
+        size_t total = 0;
+        std::vector<int> ids;
+    };
+
+private:
+    // Рядок ординала (listingId 0 - ординал вільний)
+    struct Row {
+        int listingId;
+        int brandId;
+        int modelId;
+        int regionId;
+        int fuelType;     // Коди рядкових значень з codes_
+        int transmission;
+        int bodyType;
+        int color;
+        int year;
+        int mileage;
+        int enginePower;
+        double engineVolume;
+        double priceUah;
+        int64_t createdAt;
+    };
+
+    enum class RangeField { Year, Mileage, EngineVolume, EnginePower, PriceUah, CreatedAt };
+
+    // Діапазонна ознака: бакет b містить значення з [bounds[b], bounds[b+1]);
+    // перший бакет також менші значення, останній - усі більші
+    struct RangeFacet {
+        RangeField field;
+        bool integral;
+        std::vector<double> bounds;
+        std::vector<RoaringBitmap> buckets;
+
+        size_t bucketOf(double value) const;
+    };
+
+    // Предикат плану: об'єднання повністю підхожих бітмапів і крайових бакетів,
+    // рядки яких перевіряються test
+    struct Predicate;
+
+    using ValueBitmaps = std::unordered_map<int, RoaringBitmap>;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Row> rows_;                 // Ординал -> рядок
+    std::vector<uint32_t> freeOrdinals_;
+    std::unordered_map<int, uint32_t> ordinalOf_;
+    std::unordered_map<std::string, int> codes_; // Рядкові значення ознак; лише зростає
+    RoaringBitmap all_;
+    ValueBitmaps brands_;
+    ValueBitmaps models_;
+    ValueBitmaps regions_;
+    ValueBitmaps fuelTypes_;
+    ValueBitmaps transmissions_;
+    ValueBitmaps bodyTypes_;
+    ValueBitmaps colors_;
+    std::vector<RangeFacet> ranges_; // Порядок - як RangeField
+
+public:
+    ListingFacetIndex();
+
+    // Завантаження всіх активних оголошень
+    bool load(Database& db);
+
+    // Чи виражається фільтр індексом: повнотекстовий пошук, регіон поза довідником
+    // і сортування за переглядами лишаються SQL
+    static bool supports(const ListingFilter& filter, const std::string& sortBy);
+
+    // Фільтр, сортування (price, created_at, year, mileage; ASC/DESC) і сторінка.
+    // false - фільтр не підтримується (див. supports)
+    bool query(const ListingFilter& filter, const std::string& sortBy, const std::string& sortOrder,
+               int limit, int offset, ResultPage& page) const;
+
+    size_t size() const;
+    // Приблизний обсяг пам'яті бітмапів
+    size_t memoryBytes() const;
+
+    void onListingChanged(const Listing* before, const Listing* after) override;
+
+private:
+    int codeLocked(const std::string& value);
+    void upsertLocked(const Row& row);
+    void removeLocked(int listingId);
+    void indexLocked(uint32_t ordinal, const Row& row, bool add);
+
+    static double rangeValue(const Row& row, RangeField field);
+    static void addValuePredicate(const ValueBitmaps& bitmaps, const std::vector<int>& values,
+                                  int Row::*member, std::vector<Predicate>& predicates);
+    void addCodedPredicate(const ValueBitmaps& bitmaps, const std::vector<std::string>& values,
+                           int Row::*member, std::vector<Predicate>& predicates) const;
+    void addRangePredicate(RangeField field, double min, double max, std::vector<Predicate>& predicates) const;
+    RoaringBitmap materialize(const Predicate& predicate) const;
+    void subtractExcluded(RoaringBitmap& matched, const Predicate& predicate) const;
+    RoaringBitmap filterRows(const RoaringBitmap& candidates, const Predicate& predicate) const;
+};
@@ -0,0 +1,119 @@
+// FILE: backend/src/services/ListingJsonCache.cpp
+#include "ListingJsonCache.h"
+#include "CurrencyService.h"
+#include <cctype>
+
+namespace {
+
+const char kViewCountKey[] = ",\"viewCount\":";
+// Вузол хеш-таблиці, елемент списку LRU та заголовки рядків
+const size_t kEntryOverhead = 128;
+
+} // namespace
+
+ListingJsonCache::ListingJsonCache(size_t capacityBytes)
+    : capacityBytes_(capacityBytes), bytes_(0), version_(0), hits_(0), misses_(0),
+      evictions_(0), invalidations_(0) {
+}
+
+bool ListingJsonCache::lookup(int listingId, std::string& json, int& sellerId) {
+    uint64_t rateVersion = CurrencyService::getInstance()->getSnapshot()->version;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(listingId);
+    if (it == entries_.end() || it->second.rateVersion != rateVersion) {
+        // Ціни за застарілими курсами - запис більше не знадобиться
+        if (it != entries_.end()) eraseLocked(it);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+
+    const Entry& entry = it->second;
+    std::string views = std::to_string(entry.viewCount);
+    json.clear();
+    json.reserve(entry.head.size() + views.size() + entry.tail.size());
+    json += entry.head;
+    json += views;
+    json += entry.tail;
+    sellerId = entry.sellerId;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ListingJsonCache::store(int listingId, const std::string& json, int sellerId, long long viewCount,
+                             uint64_t rateVersion, uint64_t version) {
+    // Розрізаємо навколо значення viewCount (у тексті опису лапки екрановані - збігу не буде)
+    size_t key = json.find(kViewCountKey);
+    if (key == std::string::npos) return;
+    size_t value = key + sizeof(kViewCountKey) - 1;
+    size_t valueEnd = value;
+    while (valueEnd < json.size() && (std::isdigit(static_cast<unsigned char>(json[valueEnd])) || json[valueEnd] == '-')) {
+        ++valueEnd;
+    }
+    size_t bytes = json.size() + kEntryOverhead;
+    if (bytes > capacityBytes_) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Зміна оголошень під час рендерингу - результат міг застаріти
+    if (version != version_.load()) return;
+
+    auto existing = entries_.find(listingId);
+    if (existing != entries_.end()) eraseLocked(existing);
+    while (!lru_.empty() && bytes_ + bytes > capacityBytes_) {
+        eraseLocked(entries_.find(lru_.back()));
+        ++evictions_;
+    }
+
+    lru_.push_front(listingId);
+    Entry& entry = entries_[listingId];
+    entry.head.assign(json, 0, value);
+    entry.tail.assign(json, valueEnd, std::string::npos);
+    entry.sellerId = sellerId;
+    entry.viewCount = viewCount;
+    entry.rateVersion = rateVersion;
+    entry.bytes = bytes;
+    entry.lru = lru_.begin();
+    bytes_ += bytes;
+}
+
+void ListingJsonCache::recordView(int listingId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(listingId);
+    if (it != entries_.end()) {
+        ++it->second.viewCount;
+    }
+}
+
+void ListingJsonCache::eraseLocked(std::unordered_map<int, Entry>::iterator it) {
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+ListingJsonCache::Stats ListingJsonCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+    stats.capacityBytes = capacityBytes_;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_;
+    stats.invalidations = invalidations_;
+    return stats;
+}
+
+void ListingJsonCache::onListingChanged(const Listing* before, const Listing* after) {
+    // Зміна лише лічильника переглядів кешованого тексту не зачіпає
+    if (before && after && after->getDirtyFields() == ListingField::ViewCount) return;
+    int listingId = after ? after->getId() : before->getId();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    version_.fetch_add(1);
+    auto it = entries_.find(listingId);
+    if (it != entries_.end()) {
+        eraseLocked(it);
+        ++invalidations_;
+    }
+}
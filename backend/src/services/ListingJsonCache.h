@@ -0,0 +1,77 @@
+// FILE: backend/src/services/ListingJsonCache.h
+#pragma once
+#include "../repositories/ListingRepository.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Клас ListingJsonCache - кеш готового JSON сторінки оголошення (без блоку продавця:
+// змін користувачів кеш не відстежує, тож продавець дописується при кожній видачі).
+// Будь-яка зміна оголошення (редагування, фото, продаж, модерація, видалення) скидає
+// його запис; результат рендерингу, почато до зміни, не зберігається (лічильник версій).
+// Лічильник переглядів у кешований текст не входить: JSON зберігається двома частинами
+// навколо значення viewCount, яке підставляється при видачі й збільшується з переглядом.
+// Ціни у валютах залежать від курсів - запис за іншим знімком курсів вважається промахом.
+// Витіснення - LRU за обсягом байтів.
+class ListingJsonCache : public IListingObserver {
+public:
+    struct Stats {
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t capacityBytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+    };
+
+private:
+    struct Entry {
+        std::string head;     // JSON до значення viewCount
+        std::string tail;     // Решта після значення
+        int sellerId;
+        long long viewCount;
+        uint64_t rateVersion; // Версія знімка курсів, за яким пораховано ціни
+        size_t bytes;
+        std::list<int>::iterator lru;
+    };
+
+    size_t capacityBytes_;
+    mutable std::mutex mutex_;
+    std::unordered_map<int, Entry> entries_;
+    std::list<int> lru_; // Спереду - останній використаний
+    size_t bytes_;
+    // Лічильник змін оголошень: рендеринг, що перетнувся зі зміною, не зберігається
+    std::atomic<uint64_t> version_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    uint64_t evictions_;
+    uint64_t invalidations_;
+
+public:
+    explicit ListingJsonCache(size_t capacityBytes = 32 * 1024 * 1024);
+
+    // Готовий JSON з поточним лічильником переглядів та продавець оголошення; false - промах
+    bool lookup(int listingId, std::string& json, int& sellerId);
+    // json - відрендерений за знімком курсів rateVersion, viewCount - значення в ньому;
+    // version - значення version() до читання оголошення з БД
+    void store(int listingId, const std::string& json, int sellerId, long long viewCount,
+               uint64_t rateVersion, uint64_t version);
+    uint64_t version() const { return version_.load(); }
+
+    // Перегляд, уже записаний у БД: збільшує лічильник у кешованому записі.
+    // Перегляди між читанням з БД і store до запису не потрапляють - показаний
+    // лічильник може відставати на кілька переглядів до наступної зміни оголошення
+    void recordView(int listingId);
+
+    Stats getStats() const;
+
+    void onListingChanged(const Listing* before, const Listing* after) override;
+
+private:
+    void eraseLocked(std::unordered_map<int, Entry>::iterator it);
+};
@@ -0,0 +1,370 @@
+// FILE: backend/src/services/ModerationQueue.cpp
+#include "ModerationQueue.h"
+#include "../utils/JsonEscape.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Пауза перед першим повтором пачки; подвоюється з кожною спробою до kMaxRetryDelay
+const std::chrono::milliseconds kRetryDelay(500);
+const std::chrono::milliseconds kMaxRetryDelay(30000);
+
+} // namespace
+
+const int ModerationQueue::kMaxAttempts;
+
+ModerationQueue::ModerationQueue(const std::string& dbPath,
+                                 std::shared_ptr<ModerationService> moderationService,
+                                 std::shared_ptr<ListingRepository> listingRepository,
+                                 std::shared_ptr<EventHub> eventHub,
+                                 std::shared_ptr<UnreadCounters> unreadCounters,
+                                 size_t workerCount,
+                                 size_t batchSize)
+    : dbPath_(dbPath), moderationService_(moderationService), listingRepository_(listingRepository),
+      eventHub_(eventHub), unreadCounters_(unreadCounters),
+      workerCount_(workerCount > 0 ? workerCount : 1), batchSize_(batchSize > 0 ? batchSize : 1),
+      stopping_(false), processed_(0), batches_(0), failedBatches_(0), retriedTasks_(0), droppedTasks_(0) {
+}
+
+ModerationQueue::~ModerationQueue() {
+    stop();
+}
+
+void ModerationQueue::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!workers_.empty()) return;
+    stopping_ = false;
+    for (size_t i = 0; i < workerCount_; ++i) {
+        workers_.emplace_back(&ModerationQueue::workerLoop, this);
+    }
+}
+
+void ModerationQueue::stop() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        workers.swap(workers_);
+    }
+    cv_.notify_all();
+    retryCv_.notify_all();
+    // Незавершені задачі лишаються в БД в очікуванні і повертаються через recoverPending
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void ModerationQueue::enqueue(ModerationTarget target, int id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({target, id});
+    }
+    cv_.notify_one();
+}
+
+size_t ModerationQueue::getQueueSize() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+size_t ModerationQueue::recoverPending(Database& db) {
+    const std::pair<ModerationTarget, const char*> queries[] = {
+        {ModerationTarget::Listing, "SELECT id FROM listings WHERE status = 'pending' ORDER BY id"},
+        {ModerationTarget::Comment, "SELECT id FROM comments WHERE is_approved = 0 ORDER BY id"},
+        {ModerationTarget::Message, "SELECT id FROM messages WHERE status = 'pending' ORDER BY id"},
+    };
+    
+    size_t recovered = 0;
+    for (const auto& query : queries) {
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(db.getHandle(), query.second, -1, &stmt, nullptr) != SQLITE_OK) {
+            continue;
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            enqueue(query.first, sqlite3_column_int(stmt, 0));
+            ++recovered;
+        }
+        sqlite3_finalize(stmt);
+    }
+    return recovered;
+}
+
+void ModerationQueue::workerLoop() {
+    // Власне з'єднання: транзакції воркера не змішуються з запитами HTTP потоків
+    auto db = Database::create(dbPath_);
+    if (!db) {
+        std::cerr << "Moderation worker failed to open database" << std::endl;
+        return;
+    }
+    
+    std::vector<ModerationTask> batch;
+    std::vector<ModerationTask> failed;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) break;
+            
+            batch.clear();
+            while (!queue_.empty() && batch.size() < batchSize_) {
+                batch.push_back(queue_.front());
+                queue_.pop_front();
+            }
+        }
+        
+        failed.clear();
+        try {
+            processBatch(*db, batch, failed);
+        } catch (const std::exception& e) {
+            std::cerr << "Moderation batch failed: " << e.what() << std::endl;
+            failed = batch;
+        }
+        if (!failed.empty()) {
+            retryLater(failed);
+        }
+    }
+}
+
+void ModerationQueue::retryLater(std::vector<ModerationTask>& failed) {
+    failedBatches_.fetch_add(1, std::memory_order_relaxed);
+    
+    int attempts = 0;
+    std::vector<ModerationTask> retry;
+    for (auto& task : failed) {
+        if (++task.attempts >= kMaxAttempts) {
+            std::cerr << "Moderation task " << task.id << " left pending after " << task.attempts
+                      << " failed attempts" << std::endl;
+            droppedTasks_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        attempts = std::max(attempts, task.attempts);
+        retry.push_back(task);
+    }
+    if (retry.empty()) return;
+    auto delay = std::min<std::chrono::milliseconds>(kMaxRetryDelay, kRetryDelay * (1 << (attempts - 1)));
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Пауза займає лише цей воркер; нові задачі обробляють інші
+    if (retryCv_.wait_for(lock, delay, [this] { return stopping_; })) {
+        return; // Задачі лишаються в очікуванні в БД до recoverPending
+    }
+    // Повтор - першими, у вихідному порядку
+    queue_.insert(queue_.begin(), retry.begin(), retry.end());
+    retriedTasks_.fetch_add(retry.size(), std::memory_order_relaxed);
+    lock.unlock();
+    cv_.notify_all();
+}
+
+void ModerationQueue::processBatch(Database& db, const std::vector<ModerationTask>& batch,
+                                   std::vector<ModerationTask>& failed) {
+    // Перевірка тексту - поза транзакцією, щоб не тримати блокування запису
+    std::vector<Verdict> verdicts;
+    verdicts.reserve(batch.size());
+    for (const auto& task : batch) {
+        Verdict verdict;
+        if (moderate(db, task, verdict)) {
+            verdicts.push_back(std::move(verdict));
+        }
+    }
+    if (verdicts.empty()) return;
+    
+    std::vector<const Verdict*> applied;
+    if (!applyVerdicts(db, verdicts, applied)) {
+        std::cerr << "Failed to save moderation verdicts: " << sqlite3_errmsg(db.getHandle()) << std::endl;
+        for (const auto& verdict : verdicts) {
+            failed.push_back(verdict.task);
+        }
+        return;
+    }
+    
+    processed_.fetch_add(verdicts.size(), std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    
+    // Лічильники та інші спостерігачі репозиторію бачать зміну статусу після коміту,
+    // підписники подій - сповіщення та доставлені повідомлення
+    for (const Verdict* verdict : applied) {
+        if (verdict->task.target == ModerationTarget::Listing) {
+            listingRepository_->publishStatusChange(verdict->task.id, "pending");
+        }
+        updateUnreadCounters(*verdict);
+        publishEvents(*verdict);
+    }
+}
+
+void ModerationQueue::updateUnreadCounters(const Verdict& verdict) {
+    if (!unreadCounters_ || verdict.notifyUserId <= 0) return;
+    unreadCounters_->addNotifications(verdict.notifyUserId, 1);
+    // Повідомлення самому собі не рахується непрочитаним (як у conversations)
+    if (verdict.task.target == ModerationTarget::Message && verdict.approved &&
+        verdict.notifyUserId != verdict.authorId) {
+        unreadCounters_->addMessages(verdict.notifyUserId, 1);
+    }
+}
+
+void ModerationQueue::publishEvents(const Verdict& verdict) {
+    if (!eventHub_) return;
+    if (verdict.notifyUserId > 0) {
+        std::ostringstream data;
+        data << "{\"type\":\"" << escapeJson(verdict.notifyType) << "\""
+             << ",\"message\":\"" << escapeJson(verdict.notifyMessage) << "\"}";
+        eventHub_->publish(verdict.notifyUserId, "notification", data.str());
+    }
+    if (verdict.task.target == ModerationTarget::Message && verdict.approved) {
+        std::ostringstream data;
+        data << "{\"id\":" << verdict.task.id << ",\"senderId\":" << verdict.authorId << "}";
+        eventHub_->publish(verdict.notifyUserId, "message", data.str());
+    }
+}
+
+bool ModerationQueue::moderate(Database& db, const ModerationTask& task, Verdict& verdict) {
+    const char* sql = nullptr;
+    switch (task.target) {
+        case ModerationTarget::Listing:
+            sql = "SELECT description, seller_id, 0, '' FROM listings WHERE id = ? AND status = 'pending'";
+            break;
+        case ModerationTarget::Comment:
+            sql = "SELECT c.comment_text, c.user_id, l.seller_id, '' FROM comments c "
+                  "JOIN listings l ON l.id = c.listing_id WHERE c.id = ? AND c.is_approved = 0";
+            break;
+        case ModerationTarget::Message:
+            sql = "SELECT m.message_text, m.sender_id, m.receiver_id, u.first_name FROM messages m "
+                  "LEFT JOIN users u ON u.id = m.sender_id WHERE m.id = ? AND m.status = 'pending'";
+            break;
+    }
+    
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db.getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, task.id);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        // Запис видалено або вже промодеровано вручну
+        sqlite3_finalize(stmt);
+        return false;
+    }
+    const char* textPtr = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    std::string text = textPtr ? textPtr : "";
+    int authorId = sqlite3_column_int(stmt, 1);
+    int recipientId = sqlite3_column_int(stmt, 2);
+    const char* namePtr = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+    std::string authorName = namePtr ? namePtr : "";
+    sqlite3_finalize(stmt);
+    
+    verdict.task = task;
+    verdict.authorId = authorId;
+    std::vector<std::string> foundWords;
+    switch (task.target) {
+        case ModerationTarget::Listing:
+            verdict.approved = moderationService_->moderateListing(text) == "active";
+            verdict.notifyUserId = authorId;
+            verdict.notifyType = "moderation";
+            verdict.notifyMessage = verdict.approved ? "Ваше оголошення схвалено" : "Ваше оголошення відхилено";
+            break;
+        case ModerationTarget::Comment:
+            verdict.approved = !moderationService_->checkForBadWords(text, foundWords);
+            // Схвалений коментар - сповіщення продавцю, відхилений - автору
+            verdict.notifyUserId = verdict.approved ? recipientId : authorId;
+            verdict.notifyType = verdict.approved ? "comment" : "moderation";
+            verdict.notifyMessage = verdict.approved ? "Новий коментар на ваше оголошення"
+                                                     : "Ваш коментар відхилено модерацією";
+            break;
+        case ModerationTarget::Message:
+            verdict.approved = !moderationService_->checkForBadWords(text, foundWords);
+            // Доставлене повідомлення - сповіщення отримувачу, відхилене - відправнику
+            verdict.notifyUserId = verdict.approved ? recipientId : authorId;
+            verdict.notifyType = verdict.approved ? "message" : "moderation";
+            verdict.notifyMessage = verdict.approved ? "Нове повідомлення від " + authorName
+                                                     : "Ваше повідомлення відхилено модерацією";
+            break;
+    }
+    return true;
+}
+
+bool ModerationQueue::applyVerdicts(Database& db, const std::vector<Verdict>& verdicts,
+                                    std::vector<const Verdict*>& applied) {
+    sqlite3* handle = db.getHandle();
+    if (!db.execute("BEGIN IMMEDIATE")) {
+        return false;
+    }
+    
+    sqlite3_stmt* listingStmt = nullptr;
+    sqlite3_stmt* commentStmt = nullptr;
+    sqlite3_stmt* messageStmt = nullptr;
+    sqlite3_stmt* notifStmt = nullptr;
+    bool ok =
+        sqlite3_prepare_v2(handle, "UPDATE listings SET status = ?, last_moderation_date = ? "
+                                   "WHERE id = ? AND status = 'pending'", -1, &listingStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(handle, "UPDATE comments SET is_approved = ? WHERE id = ? AND is_approved = 0",
+                           -1, &commentStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(handle, "UPDATE messages SET status = ? WHERE id = ? AND status = 'pending'",
+                           -1, &messageStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(handle, "INSERT INTO notifications (user_id, type, message, is_read, created_at) "
+                                   "VALUES (?, ?, ?, 0, ?)", -1, &notifStmt, nullptr) == SQLITE_OK;
+    
+    time_t now = time(nullptr);
+    for (size_t i = 0; ok && i < verdicts.size(); ++i) {
+        const Verdict& verdict = verdicts[i];
+        sqlite3_stmt* stmt = nullptr;
+        switch (verdict.task.target) {
+            case ModerationTarget::Listing:
+                stmt = listingStmt;
+                sqlite3_bind_text(stmt, 1, verdict.approved ? "active" : "rejected", -1, SQLITE_STATIC);
+                sqlite3_bind_int64(stmt, 2, now);
+                sqlite3_bind_int(stmt, 3, verdict.task.id);
+                break;
+            case ModerationTarget::Comment:
+                stmt = commentStmt;
+                sqlite3_bind_int(stmt, 1, verdict.approved ? 1 : -1);
+                sqlite3_bind_int(stmt, 2, verdict.task.id);
+                break;
+            case ModerationTarget::Message:
+                stmt = messageStmt;
+                sqlite3_bind_text(stmt, 1, verdict.approved ? "active" : "rejected", -1, SQLITE_STATIC);
+                sqlite3_bind_int(stmt, 2, verdict.task.id);
+                break;
+        }
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+        // Запис міг змінитись між перевіркою та транзакцією (ручна модерація, видалення)
+        if (!ok || sqlite3_changes(handle) == 0) continue;
+        
+        applied.push_back(&verdict);
+        // Доставлене повідомлення оновлює розмову в тій самій транзакції
+        if (verdict.task.target == ModerationTarget::Message && verdict.approved) {
+            ok = MessageRepository::recordDelivery(handle, verdict.task.id);
+            if (!ok) continue;
+        }
+        if (verdict.notifyUserId > 0) {
+            sqlite3_bind_int(notifStmt, 1, verdict.notifyUserId);
+            sqlite3_bind_text(notifStmt, 2, verdict.notifyType.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(notifStmt, 3, verdict.notifyMessage.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(notifStmt, 4, now);
+            ok = sqlite3_step(notifStmt) == SQLITE_DONE;
+            sqlite3_reset(notifStmt);
+        }
+    }
+    
+    sqlite3_finalize(listingStmt);
+    sqlite3_finalize(commentStmt);
+    sqlite3_finalize(messageStmt);
+    sqlite3_finalize(notifStmt);
+    
+    if (!ok) {
+        db.execute("ROLLBACK");
+        applied.clear();
+        return false;
+    }
+    if (!db.execute("COMMIT")) {
+        db.execute("ROLLBACK");
+        applied.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,112 @@
+// FILE: backend/src/services/ModerationQueue.h
+#pragma once
+#include "../database/Database.h"
+#include "../repositories/ListingRepository.h"
+#include "../repositories/MessageRepository.h"
+#include "ModerationService.h"
+#include "EventHub.h"
+#include "UnreadCounters.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Тип об'єкта, що очікує модерації
+enum class ModerationTarget {
+    Listing,  // listings.status = 'pending'
+    Comment,  // comments.is_approved = 0
+    Message   // messages.status = 'pending'
+};
+
+struct ModerationTask {
+    ModerationTarget target;
+    int id;
+    int attempts = 0; // Невдалі спроби записати вердикт
+};
+
+// Клас ModerationQueue - асинхронна модерація оголошень, коментарів та повідомлень.
+// Обробники запитів лише зберігають запис у статусі очікування та ставлять його в чергу;
+// воркери забирають задачі пачками, перевіряють текст і записують вердикти однією
+// транзакцією на пачку через власне з'єднання з БД. Автор отримує сповіщення з вердиктом.
+// Якщо транзакція не вдалась (напр. SQLITE_BUSY), задачі пачки повертаються в чергу після
+// паузи, що подвоюється з кожною спробою; після kMaxAttempts задача лишається в очікуванні
+// до recoverPending при наступному запуску.
+class ModerationQueue {
+public:
+    static const int kMaxAttempts = 8;
+
+private:
+    std::string dbPath_;
+    std::shared_ptr<ModerationService> moderationService_;
+    std::shared_ptr<ListingRepository> listingRepository_;
+    std::shared_ptr<EventHub> eventHub_; // Може бути nullptr
+    std::shared_ptr<UnreadCounters> unreadCounters_; // Може бути nullptr
+    size_t workerCount_;
+    size_t batchSize_;
+    
+    std::deque<ModerationTask> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable retryCv_; // Пауза перед повтором; перериває лише stop()
+    bool stopping_;
+    std::vector<std::thread> workers_;
+    
+    std::atomic<uint64_t> processed_;
+    std::atomic<uint64_t> batches_;
+    std::atomic<uint64_t> failedBatches_;
+    std::atomic<uint64_t> retriedTasks_;
+    std::atomic<uint64_t> droppedTasks_;
+
+public:
+    ModerationQueue(const std::string& dbPath,
+                    std::shared_ptr<ModerationService> moderationService,
+                    std::shared_ptr<ListingRepository> listingRepository,
+                    std::shared_ptr<EventHub> eventHub,
+                    std::shared_ptr<UnreadCounters> unreadCounters,
+                    size_t workerCount = 2,
+                    size_t batchSize = 32);
+    ~ModerationQueue();
+    
+    ModerationQueue(const ModerationQueue&) = delete;
+    ModerationQueue& operator=(const ModerationQueue&) = delete;
+    
+    void start();
+    void stop();
+    
+    void enqueue(ModerationTarget target, int id);
+    
+    // Повторна постановка в чергу записів, що лишились в очікуванні після перезапуску
+    size_t recoverPending(Database& db);
+    
+    size_t getQueueSize();
+    uint64_t getProcessedCount() const { return processed_.load(std::memory_order_relaxed); }
+    uint64_t getBatchCount() const { return batches_.load(std::memory_order_relaxed); }
+    uint64_t getFailedBatchCount() const { return failedBatches_.load(std::memory_order_relaxed); }
+    uint64_t getRetriedCount() const { return retriedTasks_.load(std::memory_order_relaxed); }
+    uint64_t getDroppedCount() const { return droppedTasks_.load(std::memory_order_relaxed); }
+
+private:
+    // Результат модерації одного запису
+    struct Verdict {
+        ModerationTask task;
+        bool approved;
+        int authorId;
+        int notifyUserId;
+        std::string notifyType;
+        std::string notifyMessage;
+    };
+    
+    void workerLoop();
+    // failed - задачі, вердикти яких не вдалось записати
+    void processBatch(Database& db, const std::vector<ModerationTask>& batch, std::vector<ModerationTask>& failed);
+    void retryLater(std::vector<ModerationTask>& failed);
+    bool moderate(Database& db, const ModerationTask& task, Verdict& verdict);
+    // applied - вердикти, що змінили запис (для сповіщень після коміту)
+    bool applyVerdicts(Database& db, const std::vector<Verdict>& verdicts, std::vector<const Verdict*>& applied);
+    void updateUnreadCounters(const Verdict& verdict);
+    void publishEvents(const Verdict& verdict);
+};
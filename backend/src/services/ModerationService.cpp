@@ -1,39 +1,117 @@
 // FILE: backend/src/services/ModerationService.cpp
 #include "ModerationService.h"
-#include <algorithm>
-#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
 
-ModerationService::ModerationService() {
-    initializeBadWords();
+ModerationService::ModerationService(const std::string& dictionaryPath)
+    : dictionaryPath_(dictionaryPath), nextVersion_(1) {
+    DictionaryReport report = reload();
+    if (!report.success) {
+        std::cerr << "Failed to load moderation dictionary: " << report.error << std::endl;
+    }
+}
+
+bool ModerationService::loadWords(std::vector<std::string>& words, std::string& source, std::string& error) const {
+    // Файлу ще немає - вбудований список; наступне перезавантаження підхопить доданий файл
+    struct stat fileStat;
+    bool missing = !dictionaryPath_.empty() && stat(dictionaryPath_.c_str(), &fileStat) != 0 &&
+                   (errno == ENOENT || errno == ENOTDIR);
+    if (dictionaryPath_.empty() || missing) {
+        // Базовий список нецензурних слів (для демонстрації)
+        words = {
+            "мат1", "мат2", "мат3" // В реальному проєкті тут буде повний список
+        };
+        source = "builtin";
+        return true;
+    }
+    
+    // Одне слово чи фраза на рядок; порожні рядки та рядки з # пропускаються
+    std::ifstream file(dictionaryPath_);
+    if (!file.is_open()) {
+        error = "Cannot open " + dictionaryPath_;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        words.push_back(line.substr(begin, end - begin + 1));
+    }
+    source = dictionaryPath_;
+    return true;
 }
 
-void ModerationService::initializeBadWords() {
-    // Базовий список нецензурних слів (для демонстрації)
-    badWords_ = {
-        "мат1", "мат2", "мат3" // В реальному проєкті тут буде повний список
-    };
+DictionaryReport ModerationService::reload() {
+    std::lock_guard<std::mutex> lock(reloadMutex_);
+    auto started = std::chrono::steady_clock::now();
+    
+    auto dictionary = std::make_shared<ModerationDictionary>();
+    std::string error;
+    if (!loadWords(dictionary->words, dictionary->source, error)) {
+        DictionaryReport report = {};
+        report.success = false;
+        report.error = error;
+        return report;
+    }
+    dictionary->matcher = std::make_unique<AhoCorasick>(dictionary->words);
+    dictionary->version = nextVersion_++;
+    dictionary->buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    
+    DictionaryReport report = makeReport(*dictionary);
+    std::atomic_store_explicit(&dictionary_, std::shared_ptr<const ModerationDictionary>(std::move(dictionary)),
+                               std::memory_order_release);
+    return report;
 }
 
-std::string ModerationService::toLower(const std::string& str) {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    return result;
+std::future<DictionaryReport> ModerationService::reloadAsync() {
+    return std::async(std::launch::async, [this] { return reload(); });
 }
 
-bool ModerationService::checkForBadWords(const std::string& text, std::vector<std::string>& foundWords) {
-    std::string lowerText = toLower(text);
+DictionaryReport ModerationService::describe() const {
+    auto dictionary = getDictionary();
+    if (!dictionary) {
+        DictionaryReport report = {};
+        report.success = false;
+        report.error = "Dictionary is not loaded";
+        return report;
+    }
+    return makeReport(*dictionary);
+}
+
+DictionaryReport ModerationService::makeReport(const ModerationDictionary& dictionary) {
+    DictionaryReport report;
+    report.success = true;
+    report.version = dictionary.version;
+    report.source = dictionary.source;
+    report.patternCount = dictionary.matcher->getPatternCount();
+    report.stateCount = dictionary.matcher->getStateCount();
+    report.memoryBytes = dictionary.matcher->getMemoryUsage();
+    for (const auto& word : dictionary.words) {
+        report.memoryBytes += sizeof(std::string) + word.capacity();
+    }
+    report.buildMs = dictionary.buildMs;
+    return report;
+}
+
+bool ModerationService::checkForBadWords(const std::string& text, std::vector<std::string>& foundWords) const {
     foundWords.clear();
+    auto dictionary = getDictionary();
+    if (!dictionary) return false;
     
-    for (const auto& word : badWords_) {
-        if (lowerText.find(toLower(word)) != std::string::npos) {
-            foundWords.push_back(word);
-        }
+    // Один прохід по тексту незалежно від розміру словника
+    for (size_t index : dictionary->matcher->findAll(text)) {
+        foundWords.push_back(dictionary->words[index]);
     }
     
     return !foundWords.empty();
 }
 
-std::string ModerationService::moderateListing(const std::string& description) {
+std::string ModerationService::moderateListing(const std::string& description) const {
     std::vector<std::string> foundWords;
     
     if (checkForBadWords(description, foundWords)) {
@@ -42,6 +120,3 @@ std::string ModerationService::moderateListing(const std::string& description) {
     
     return "active"; // Оголошення пройшло перевірку
 }
-
-
-
@@ -1,26 +1,65 @@
 // FILE: backend/src/services/ModerationService.h
 #pragma once
+#include "../utils/AhoCorasick.h"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+// Скомпільований словник модерації. Незмінний після побудови; публікується
+// атомарно (RCU), тож перевірки, що вже виконуються, дочитують стару версію.
+struct ModerationDictionary {
+    uint64_t version;
+    std::string source;             // Файл словника або "builtin"
+    std::vector<std::string> words; // Список нецензурних слів
+    std::unique_ptr<AhoCorasick> matcher;
+    double buildMs;                 // Час читання та компіляції
+};
+
+// Результат перезавантаження словника
+struct DictionaryReport {
+    bool success;
+    std::string error;
+    uint64_t version;
+    std::string source;
+    size_t patternCount;
+    size_t stateCount;
+    size_t memoryBytes;
+    double buildMs;
+};
+
 // Клас ModerationService - інкапсуляція логіки модерації
 class ModerationService {
 private:
-    std::vector<std::string> badWords_; // Список нецензурних слів
+    std::string dictionaryPath_; // Порожній або файлу немає - вбудований список
+    std::shared_ptr<const ModerationDictionary> dictionary_; // Доступ лише через atomic_load/atomic_store
+    std::mutex reloadMutex_; // Серіалізує перезавантаження, перевірки його не беруть
+    uint64_t nextVersion_;
 
 public:
-    ModerationService();
+    explicit ModerationService(const std::string& dictionaryPath = "");
     
     // Перевірка тексту на нецензурну лексику
-    bool checkForBadWords(const std::string& text, std::vector<std::string>& foundWords);
+    bool checkForBadWords(const std::string& text, std::vector<std::string>& foundWords) const;
     
     // Модерація оголошення
-    std::string moderateListing(const std::string& description);
+    std::string moderateListing(const std::string& description) const;
+    
+    // Перечитати словник та скомпілювати автомат в окремому потоці.
+    // Поточна версія працює до моменту заміни; при помилці лишається старою.
+    std::future<DictionaryReport> reloadAsync();
+    
+    // Опис поточної версії словника
+    DictionaryReport describe() const;
     
 private:
-    void initializeBadWords();
-    std::string toLower(const std::string& str);
+    std::shared_ptr<const ModerationDictionary> getDictionary() const {
+        return std::atomic_load_explicit(&dictionary_, std::memory_order_acquire);
+    }
+    
+    DictionaryReport reload();
+    bool loadWords(std::vector<std::string>& words, std::string& source, std::string& error) const;
+    static DictionaryReport makeReport(const ModerationDictionary& dictionary);
 };
-
-
-
@@ -0,0 +1,168 @@
+// FILE: backend/src/services/PlatformCounters.cpp
+#include "PlatformCounters.h"
+#include "../database/Database.h"
+#include <iostream>
+#include <sqlite3.h>
+
+namespace {
+const char* const kStatusNames[PlatformCounters::kStatusCount] = {
+    "draft", "pending", "active", "rejected", "inactive", "sold", "other"
+};
+const char* const kRoleNames[PlatformCounters::kRoleCount] = {
+    "buyer", "seller", "manager", "administrator", "other"
+};
+const char* const kAccountTypeNames[PlatformCounters::kAccountTypeCount] = {
+    "basic", "premium", "other"
+};
+
+template <size_t N>
+size_t indexOf(const char* const (&names)[N], const std::string& value) {
+    for (size_t i = 0; i + 1 < N; ++i) {
+        if (value == names[i]) return i;
+    }
+    return N - 1; // Невідоме значення
+}
+}
+
+PlatformCounters::PlatformCounters(std::shared_ptr<Database> db)
+    : db_(db), userCount_(0), listingCount_(0), reconciledAt_(0) {
+    for (auto& c : listingsByStatus_) c.store(0);
+    for (auto& c : usersByRole_) c.store(0);
+    for (auto& c : usersByAccountType_) c.store(0);
+}
+
+PlatformCounters::~PlatformCounters() {
+    stopReconciliation();
+}
+
+size_t PlatformCounters::statusIndex(const std::string& status) {
+    return indexOf(kStatusNames, status);
+}
+
+size_t PlatformCounters::roleIndex(const std::string& role) {
+    return indexOf(kRoleNames, role);
+}
+
+size_t PlatformCounters::accountTypeIndex(const std::string& accountType) {
+    return indexOf(kAccountTypeNames, accountType);
+}
+
+std::string PlatformCounters::roleOf(const User* user) {
+    auto roles = user->getRoles();
+    return roles.empty() ? std::string() : roles.front();
+}
+
+bool PlatformCounters::reconcile() {
+    if (!db_ || !db_->getHandle()) return false;
+    
+    std::array<long long, kStatusCount> byStatus{};
+    std::array<long long, kRoleCount> byRole{};
+    std::array<long long, kAccountTypeCount> byAccountType{};
+    long long listings = 0;
+    long long users = 0;
+    
+    sqlite3_stmt* stmt;
+    const char* listingSql = "SELECT status, COUNT(*) FROM listings GROUP BY status";
+    if (sqlite3_prepare_v2(db_->getHandle(), listingSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* statusText = sqlite3_column_text(stmt, 0);
+        long long count = sqlite3_column_int64(stmt, 1);
+        std::string status = statusText ? reinterpret_cast<const char*>(statusText) : "";
+        byStatus[statusIndex(status)] += count;
+        listings += count;
+    }
+    sqlite3_finalize(stmt);
+    
+    const char* userSql = "SELECT role, account_type, COUNT(*) FROM users GROUP BY role, account_type";
+    if (sqlite3_prepare_v2(db_->getHandle(), userSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* roleText = sqlite3_column_text(stmt, 0);
+        const unsigned char* accountText = sqlite3_column_text(stmt, 1);
+        long long count = sqlite3_column_int64(stmt, 2);
+        std::string role = roleText ? reinterpret_cast<const char*>(roleText) : "";
+        std::string accountType = accountText ? reinterpret_cast<const char*>(accountText) : "";
+        byRole[roleIndex(role)] += count;
+        byAccountType[accountTypeIndex(accountType)] += count;
+        users += count;
+    }
+    sqlite3_finalize(stmt);
+    
+    // Записи, що відбулися під час звірки, будуть виправлені наступною звіркою
+    listingCount_.store(listings);
+    userCount_.store(users);
+    for (size_t i = 0; i < kStatusCount; ++i) listingsByStatus_[i].store(byStatus[i]);
+    for (size_t i = 0; i < kRoleCount; ++i) usersByRole_[i].store(byRole[i]);
+    for (size_t i = 0; i < kAccountTypeCount; ++i) usersByAccountType_[i].store(byAccountType[i]);
+    reconciledAt_.store(time(nullptr));
+    return true;
+}
+
+void PlatformCounters::startReconciliation(std::chrono::seconds interval) {
+    reconcileTask_ = std::make_unique<PeriodicTask>(interval, [this] {
+        if (!reconcile()) {
+            std::cerr << "Platform counters reconciliation failed" << std::endl;
+        }
+    });
+    reconcileTask_->start();
+}
+
+void PlatformCounters::stopReconciliation() {
+    if (reconcileTask_) {
+        reconcileTask_->stop();
+        reconcileTask_.reset();
+    }
+}
+
+PlatformStatistics PlatformCounters::getStatistics() const {
+    PlatformStatistics stats;
+    stats.userCount = userCount_.load();
+    stats.listingCount = listingCount_.load();
+    stats.activeListingCount = listingsByStatus_[statusIndex("active")].load();
+    for (size_t i = 0; i < kStatusCount; ++i) {
+        stats.listingsByStatus.push_back({kStatusNames[i], listingsByStatus_[i].load()});
+    }
+    for (size_t i = 0; i < kRoleCount; ++i) {
+        stats.usersByRole.push_back({kRoleNames[i], usersByRole_[i].load()});
+    }
+    for (size_t i = 0; i < kAccountTypeCount; ++i) {
+        stats.usersByAccountType.push_back({kAccountTypeNames[i], usersByAccountType_[i].load()});
+    }
+    stats.reconciledAt = reconciledAt_.load();
+    return stats;
+}
+
+// Індекс лічильника береться прямо з ListingStatus
+static_assert(static_cast<size_t>(ListingStatus::Other) + 1 == PlatformCounters::kStatusCount,
+              "ListingStatus order must match kStatusNames");
+
+void PlatformCounters::onListingChanged(const Listing* before, const Listing* after) {
+    if (before) {
+        listingsByStatus_[static_cast<size_t>(before->getStatusCode())]--;
+    } else {
+        listingCount_++;
+    }
+    if (after) {
+        listingsByStatus_[static_cast<size_t>(after->getStatusCode())]++;
+    } else {
+        listingCount_--;
+    }
+}
+
+void PlatformCounters::onUserChanged(const User* before, const User* after) {
+    if (before) {
+        usersByRole_[roleIndex(roleOf(before))]--;
+        usersByAccountType_[accountTypeIndex(before->getAccountType())]--;
+    } else {
+        userCount_++;
+    }
+    if (after) {
+        usersByRole_[roleIndex(roleOf(after))]++;
+        usersByAccountType_[accountTypeIndex(after->getAccountType())]++;
+    } else {
+        userCount_--;
+    }
+}
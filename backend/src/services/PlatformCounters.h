@@ -0,0 +1,66 @@
+// FILE: backend/src/services/PlatformCounters.h
+#pragma once
+#include "../repositories/ListingRepository.h"
+#include "../repositories/UserRepository.h"
+#include "../utils/PeriodicTask.h"
+#include <array>
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Database;
+
+// Знімок лічильників платформи для адмін-панелі
+struct PlatformStatistics {
+    long long userCount;
+    long long listingCount;
+    long long activeListingCount;
+    std::vector<std::pair<std::string, long long>> listingsByStatus;
+    std::vector<std::pair<std::string, long long>> usersByRole;
+    std::vector<std::pair<std::string, long long>> usersByAccountType;
+    time_t reconciledAt;
+};
+
+// Клас PlatformCounters - матеріалізовані лічильники користувачів та оголошень.
+// Оновлюються репозиторіями при записі, звіряються з SQLite при старті та за таймером.
+class PlatformCounters : public IListingObserver, public IUserObserver {
+public:
+    static constexpr size_t kStatusCount = 7;      // draft, pending, active, rejected, inactive, sold, інші
+    static constexpr size_t kRoleCount = 5;        // buyer, seller, manager, administrator, інші
+    static constexpr size_t kAccountTypeCount = 3; // basic, premium, інші
+
+private:
+    std::shared_ptr<Database> db_;
+    std::atomic<long long> userCount_;
+    std::atomic<long long> listingCount_;
+    std::array<std::atomic<long long>, kStatusCount> listingsByStatus_;
+    std::array<std::atomic<long long>, kRoleCount> usersByRole_;
+    std::array<std::atomic<long long>, kAccountTypeCount> usersByAccountType_;
+    std::atomic<time_t> reconciledAt_;
+    std::unique_ptr<PeriodicTask> reconcileTask_;
+
+public:
+    explicit PlatformCounters(std::shared_ptr<Database> db);
+    ~PlatformCounters() override;
+    
+    // Повний перерахунок з БД (дві GROUP BY вибірки)
+    bool reconcile();
+    
+    // Періодична звірка у фоновому потоці
+    void startReconciliation(std::chrono::seconds interval);
+    void stopReconciliation();
+    
+    PlatformStatistics getStatistics() const;
+    
+    void onListingChanged(const Listing* before, const Listing* after) override;
+    void onUserChanged(const User* before, const User* after) override;
+    
+private:
+    static size_t statusIndex(const std::string& status);
+    static size_t roleIndex(const std::string& role);
+    static size_t accountTypeIndex(const std::string& accountType);
+    static std::string roleOf(const User* user);
+};
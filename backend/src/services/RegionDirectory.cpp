@@ -0,0 +1,274 @@
+// FILE: backend/src/services/RegionDirectory.cpp
+#include "RegionDirectory.h"
+#include "../utils/Utf8.h"
+#include <iostream>
+#include <mutex>
+
+namespace {
+// Вбудований довідник: id стабільні (не змінювати порядок, нові - лише в кінець)
+struct RegionSeed {
+    int id;
+    const char* name;
+    std::vector<const char*> aliases;
+};
+
+const std::vector<RegionSeed>& regionSeeds() {
+    static const std::vector<RegionSeed> seeds = {
+        {1, "Київ", {"Kyiv", "Kiev", "Kyjiv", "Киев", "м. Київ"}},
+        {2, "Київська область", {"Kyiv oblast", "Kiev oblast", "Киевская область"}},
+        {3, "Львів", {"Lviv", "Lvov", "Львов"}},
+        {4, "Львівська область", {"Lviv oblast", "Lvov oblast", "Львовская область"}},
+        {5, "Одеса", {"Odesa", "Odessa", "Одесса"}},
+        {6, "Одеська область", {"Odesa oblast", "Odessa oblast", "Одесская область"}},
+        {7, "Харків", {"Kharkiv", "Kharkov", "Харьков"}},
+        {8, "Харківська область", {"Kharkiv oblast", "Kharkov oblast", "Харьковская область"}},
+        {9, "Дніпро", {"Dnipro", "Dnepr", "Днепр", "Дніпропетровськ", "Днепропетровск", "Dnipropetrovsk"}},
+        {10, "Дніпропетровська область", {"Dnipropetrovsk oblast", "Dnipro oblast", "Днепропетровская область"}},
+        {11, "Запоріжжя", {"Zaporizhzhia", "Zaporizhia", "Zaporozhye", "Запорожье"}},
+        {12, "Запорізька область", {"Zaporizhzhia oblast", "Zaporizhia oblast", "Запорожская область"}},
+        {13, "Вінниця", {"Vinnytsia", "Vinnitsa", "Винница"}},
+        {14, "Вінницька область", {"Vinnytsia oblast", "Винницкая область"}},
+        {15, "Житомир", {"Zhytomyr", "Zhitomir"}},
+        {16, "Житомирська область", {"Zhytomyr oblast", "Житомирская область"}},
+        {17, "Івано-Франківськ", {"Ivano-Frankivsk", "Ивано-Франковск"}},
+        {18, "Івано-Франківська область", {"Ivano-Frankivsk oblast", "Ивано-Франковская область"}},
+        {19, "Кропивницький", {"Kropyvnytskyi", "Кропивницкий", "Кіровоград", "Кировоград", "Kirovohrad"}},
+        {20, "Кіровоградська область", {"Kirovohrad oblast", "Кировоградская область"}},
+        {21, "Луцьк", {"Lutsk", "Луцк"}},
+        {22, "Волинська область", {"Volyn oblast", "Волынская область"}},
+        {23, "Миколаїв", {"Mykolaiv", "Nikolaev", "Николаев"}},
+        {24, "Миколаївська область", {"Mykolaiv oblast", "Николаевская область"}},
+        {25, "Полтава", {"Poltava"}},
+        {26, "Полтавська область", {"Poltava oblast", "Полтавская область"}},
+        {27, "Рівне", {"Rivne", "Rovno", "Ровно"}},
+        {28, "Рівненська область", {"Rivne oblast", "Ровенская область"}},
+        {29, "Суми", {"Sumy", "Сумы"}},
+        {30, "Сумська область", {"Sumy oblast", "Сумская область"}},
+        {31, "Тернопіль", {"Ternopil", "Тернополь"}},
+        {32, "Тернопільська область", {"Ternopil oblast", "Тернопольская область"}},
+        {33, "Ужгород", {"Uzhhorod", "Uzhgorod"}},
+        {34, "Закарпатська область", {"Zakarpattia oblast", "Закарпаття", "Закарпатская область"}},
+        {35, "Хмельницький", {"Khmelnytskyi", "Хмельницкий"}},
+        {36, "Хмельницька область", {"Khmelnytskyi oblast", "Хмельницкая область"}},
+        {37, "Черкаси", {"Cherkasy", "Черкассы"}},
+        {38, "Черкаська область", {"Cherkasy oblast", "Черкасская область"}},
+        {39, "Чернівці", {"Chernivtsi", "Черновцы"}},
+        {40, "Чернівецька область", {"Chernivtsi oblast", "Черновицкая область"}},
+        {41, "Чернігів", {"Chernihiv", "Chernigov", "Чернигов"}},
+        {42, "Чернігівська область", {"Chernihiv oblast", "Черниговская область"}},
+        {43, "Херсон", {"Kherson"}},
+        {44, "Херсонська область", {"Kherson oblast", "Херсонская область"}},
+        {45, "Донецьк", {"Donetsk", "Донецк"}},
+        {46, "Донецька область", {"Donetsk oblast", "Донецкая область"}},
+        {47, "Луганськ", {"Luhansk", "Lugansk", "Луганск"}},
+        {48, "Луганська область", {"Luhansk oblast", "Луганская область"}},
+        {49, "Севастополь", {"Sevastopol"}},
+        {50, "АР Крим", {"Крим", "Crimea", "Krym", "АРК", "Крым", "Автономна Республіка Крим"}},
+    };
+    return seeds;
+}
+
+// Апострофи різних видів зводяться до одного
+bool isApostrophe(char32_t cp) {
+    return cp == U'\'' || cp == U'’' || cp == U'ʼ' || cp == U'`';
+}
+}
+
+RegionDirectory::RegionDirectory(std::shared_ptr<Database> db) : db_(db) {
+}
+
+std::string RegionDirectory::normalizeKey(const std::string& text) {
+    // Слова в нижньому регістрі; розділювачі - пробіли та розділові знаки (крім дефісу)
+    std::vector<std::string> words;
+    std::string word;
+    std::string folded = utf8::foldCase(text);
+    size_t pos = 0;
+    while (pos < folded.size()) {
+        char32_t cp = utf8::decode(folded, pos);
+        bool separator = cp == U' ' || cp == U'\t' || cp == U'\n' || cp == U'\r' ||
+                         cp == U'.' || cp == U',' || cp == U';' || cp == U'(' || cp == U')';
+        if (separator) {
+            if (!word.empty()) words.push_back(std::move(word));
+            word.clear();
+        } else if (isApostrophe(cp)) {
+            word += '\'';
+        } else {
+            utf8::append(word, cp);
+        }
+    }
+    if (!word.empty()) words.push_back(std::move(word));
+
+    // Скорочення та синоніми слова "область"
+    if (!words.empty()) {
+        std::string& last = words.back();
+        if (last == "обл" || last == "обл-ть") last = "область";
+        else if (last == "obl" || last == "region" || last == "oblast'") last = "oblast";
+    }
+
+    std::string key;
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (i > 0) key += ' ';
+        key += words[i];
+    }
+    return key;
+}
+
+bool RegionDirectory::seed() {
+    sqlite3* handle = db_->getHandle();
+    sqlite3_stmt* regionStmt = nullptr;
+    sqlite3_stmt* aliasStmt = nullptr;
+    if (sqlite3_prepare_v2(handle, "INSERT OR IGNORE INTO regions (id, name) VALUES (?, ?)",
+                           -1, &regionStmt, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(handle, "INSERT OR IGNORE INTO region_aliases (alias, region_id) VALUES (?, ?)",
+                           -1, &aliasStmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(regionStmt);
+        sqlite3_finalize(aliasStmt);
+        return false;
+    }
+
+    bool ok = db_->execute("BEGIN");
+    auto addAlias = [&](const std::string& alias, int regionId) {
+        std::string key = normalizeKey(alias);
+        sqlite3_bind_text(aliasStmt, 1, key.c_str(), static_cast<int>(key.length()), SQLITE_TRANSIENT);
+        sqlite3_bind_int(aliasStmt, 2, regionId);
+        ok = sqlite3_step(aliasStmt) == SQLITE_DONE && ok;
+        sqlite3_reset(aliasStmt);
+    };
+    for (const auto& region : regionSeeds()) {
+        sqlite3_bind_int(regionStmt, 1, region.id);
+        sqlite3_bind_text(regionStmt, 2, region.name, -1, SQLITE_STATIC);
+        ok = sqlite3_step(regionStmt) == SQLITE_DONE && ok;
+        sqlite3_reset(regionStmt);
+
+        addAlias(region.name, region.id);
+        for (const char* alias : region.aliases) {
+            addAlias(alias, region.id);
+        }
+    }
+    sqlite3_finalize(regionStmt);
+    sqlite3_finalize(aliasStmt);
+
+    if (!ok) {
+        db_->execute("ROLLBACK");
+        return false;
+    }
+    return db_->execute("COMMIT");
+}
+
+bool RegionDirectory::load() {
+    if (!db_ || !db_->getHandle()) return false;
+    if (!seed()) {
+        std::cerr << "Failed to seed regions" << std::endl;
+    }
+
+    std::unordered_map<std::string, int> aliases;
+    std::unordered_map<int, std::string> names;
+    std::vector<int> order;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_->getHandle(), "SELECT id, name FROM regions ORDER BY id", -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        names[id] = name ? name : "";
+        order.push_back(id);
+        // Канонічна назва завжди розпізнається, навіть без рядка в region_aliases
+        aliases.emplace(normalizeKey(names[id]), id);
+    }
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_prepare_v2(db_->getHandle(), "SELECT alias, region_id FROM region_aliases", -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* alias = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        int id = sqlite3_column_int(stmt, 1);
+        if (alias && names.count(id)) {
+            aliases.emplace(normalizeKey(alias), id);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    aliases_.swap(aliases);
+    names_.swap(names);
+    order_.swap(order);
+    return true;
+}
+
+int RegionDirectory::resolve(const std::string& region) const {
+    if (region.empty()) return 0;
+    std::string key = normalizeKey(region);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = aliases_.find(key);
+    return it != aliases_.end() ? it->second : 0;
+}
+
+std::string RegionDirectory::name(int regionId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = names_.find(regionId);
+    return it != names_.end() ? it->second : std::string();
+}
+
+std::vector<std::pair<int, std::string>> RegionDirectory::all() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::pair<int, std::string>> result;
+    result.reserve(order_.size());
+    for (int id : order_) {
+        result.emplace_back(id, names_.at(id));
+    }
+    return result;
+}
+
+bool RegionDirectory::backfillListings() {
+    sqlite3* handle = db_->getHandle();
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, "SELECT DISTINCT region FROM listings WHERE region_id IS NULL AND region != ''",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    std::vector<std::string> spellings;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* region = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (region) spellings.push_back(region);
+    }
+    sqlite3_finalize(stmt);
+
+    if (spellings.empty()) return true;
+
+    // Відповідність написання -> регіон у тимчасовій таблиці, далі один прохід по listings
+    bool ok = db_->execute("BEGIN") &&
+              db_->execute("CREATE TEMP TABLE region_backfill (spelling TEXT PRIMARY KEY, region_id INTEGER, name TEXT)");
+    if (ok && sqlite3_prepare_v2(handle, "INSERT INTO region_backfill (spelling, region_id, name) VALUES (?, ?, ?)",
+                                 -1, &stmt, nullptr) == SQLITE_OK) {
+        int unresolved = 0;
+        for (const auto& spelling : spellings) {
+            int regionId = resolve(spelling);
+            if (regionId == 0) {
+                unresolved++;
+                continue; // Невідомий регіон лишається вільним текстом
+            }
+            std::string canonical = name(regionId);
+            sqlite3_bind_text(stmt, 1, spelling.c_str(), static_cast<int>(spelling.length()), SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 2, regionId);
+            sqlite3_bind_text(stmt, 3, canonical.c_str(), static_cast<int>(canonical.length()), SQLITE_TRANSIENT);
+            ok = sqlite3_step(stmt) == SQLITE_DONE && ok;
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        if (unresolved > 0) {
+            std::cerr << unresolved << " listing region spellings are not in the region directory" << std::endl;
+        }
+    } else {
+        ok = false;
+    }
+    ok = ok && db_->execute("UPDATE listings SET region_id = m.region_id, region = m.name FROM region_backfill m "
+                            "WHERE listings.region_id IS NULL AND listings.region = m.spelling");
+    ok = db_->execute("DROP TABLE IF EXISTS temp.region_backfill") && ok;
+    if (!ok) {
+        db_->execute("ROLLBACK");
+        return false;
+    }
+    return db_->execute("COMMIT");
+}
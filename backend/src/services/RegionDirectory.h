@@ -0,0 +1,47 @@
+// FILE: backend/src/services/RegionDirectory.h
+#pragma once
+#include "../database/Database.h"
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Клас RegionDirectory - довідник регіонів (таблиці regions та region_aliases).
+// Вільний текст регіону зводиться до канонічного id: назва, латиниця, російські та
+// старі назви ("Kyiv", "Киев", "Дніпропетровськ", "Київська обл.") дають той самий регіон.
+// Таблиці завантажуються в пам'ять один раз; пошук - хеш-таблиця за нормалізованим ключем.
+class RegionDirectory {
+private:
+    std::shared_ptr<Database> db_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, int> aliases_; // Нормалізований ключ -> id
+    std::unordered_map<int, std::string> names_;   // id -> канонічна назва
+    std::vector<int> order_;                       // id у порядку довідника
+
+public:
+    explicit RegionDirectory(std::shared_ptr<Database> db);
+
+    // Дозаповнює вбудований довідник (INSERT OR IGNORE) і завантажує таблиці в пам'ять
+    bool load();
+
+    // id регіону для довільного написання; 0 - невідомий регіон
+    int resolve(const std::string& region) const;
+    // Канонічна назва; порожньо для невідомого id
+    std::string name(int regionId) const;
+    // Усі регіони (id, назва) у порядку довідника
+    std::vector<std::pair<int, std::string>> all() const;
+
+    // Проставляє region_id (і канонічну назву) оголошенням без нього: різні написання
+    // зіставляються з довідником у тимчасовій таблиці region_backfill, після чого
+    // один UPDATE ... FROM region_backfill оновлює listings за один прохід
+    bool backfillListings();
+
+    // Ключ порівняння: нижній регістр (з кирилицею), без крапок/ком і зайвих пробілів,
+    // "обл"/"obl"/"region" -> "область"/"oblast"
+    static std::string normalizeKey(const std::string& text);
+
+private:
+    bool seed();
+};
@@ -0,0 +1,170 @@
+// FILE: backend/src/services/SearchCountCache.cpp
+#include "SearchCountCache.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Роздільник полів ключа (не трапляється в параметрах запиту)
+const char kSeparator = '\x1f';
+
+// LIKE у SQLite нечутливий до регістру лише для ASCII - так само і ключ
+std::string asciiLower(const std::string& text) {
+    std::string result = text;
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+template <typename T>
+void appendSorted(std::ostringstream& out, std::vector<T> values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    for (const auto& value : values) {
+        out << value << ',';
+    }
+    out << kSeparator;
+}
+
+} // namespace
+
+constexpr double SearchCountCache::kDefaultSelectivity;
+
+SearchCountCache::SearchCountCache(const std::string& dbPath, std::shared_ptr<ListingRepository> listingRepository,
+                                   size_t capacity, size_t maxPending)
+    : dbPath_(dbPath), listingRepository_(listingRepository), capacity_(capacity), maxPending_(maxPending),
+      generation_(0), stopping_(false) {
+}
+
+SearchCountCache::~SearchCountCache() {
+    stop();
+}
+
+void SearchCountCache::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (worker_.joinable()) return;
+    stopping_ = false;
+    worker_ = std::thread(&SearchCountCache::workerLoop, this);
+}
+
+void SearchCountCache::stop() {
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        worker.swap(worker_);
+    }
+    cv_.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::string SearchCountCache::textKeyOf(const ListingFilter& filter) {
+    std::string key = asciiLower(filter.searchQuery);
+    key += kSeparator;
+    if (filter.regionId == 0) {
+        key += asciiLower(filter.region);
+    }
+    return key;
+}
+
+std::string SearchCountCache::keyOf(const ListingFilter& filter) {
+    std::ostringstream out;
+    out << textKeyOf(filter) << kSeparator << filter.regionId << kSeparator;
+    appendSorted(out, filter.brandIds);
+    appendSorted(out, filter.modelIds);
+    appendSorted(out, filter.fuelTypes);
+    appendSorted(out, filter.transmissions);
+    appendSorted(out, filter.bodyTypes);
+    appendSorted(out, filter.colors);
+    out << filter.minPriceUah << ',' << filter.maxPriceUah << ',' << filter.minYear << ',' << filter.maxYear << ','
+        << filter.minMileage << ',' << filter.maxMileage << ',' << filter.minEngineVolume << ','
+        << filter.maxEngineVolume << ',' << filter.minEnginePower << ',' << filter.maxEnginePower;
+    return out.str();
+}
+
+bool SearchCountCache::lookup(const std::string& key, size_t& total) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counts_.find(key);
+    if (it == counts_.end() || it->second.generation != generation_.load()) return false;
+    total = it->second.total;
+    return true;
+}
+
+double SearchCountCache::selectivity(const std::string& textKey) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = selectivity_.find(textKey);
+    return it != selectivity_.end() ? it->second : kDefaultSelectivity;
+}
+
+void SearchCountCache::requestCount(const ListingFilter& filter, size_t structuredTotal) {
+    Request request{keyOf(filter), textKeyOf(filter), filter, structuredTotal};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= maxPending_ || pending_.count(request.key)) return;
+        pending_.insert(request.key);
+        queue_.push_back(std::move(request));
+    }
+    cv_.notify_one();
+}
+
+void SearchCountCache::workerLoop() {
+    // Власне з'єднання: повний прохід COUNT(*) не блокує з'єднання потоків HTTP
+    auto db = Database::create(dbPath_);
+    if (!db) {
+        std::cerr << "Search count worker failed to open database" << std::endl;
+        return;
+    }
+
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) break;
+            request = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        // Покоління - до підрахунку: зміна під час проходу робить результат застарілим
+        uint64_t generation = generation_.load();
+        long long count = listingRepository_->countSearch(*db, request.filter);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.erase(request.key);
+        if (count < 0) continue;
+        if (counts_.size() >= capacity_) {
+            // Спершу застарілі, за потреби - усе
+            for (auto it = counts_.begin(); it != counts_.end();) {
+                it = it->second.generation != generation_.load() ? counts_.erase(it) : std::next(it);
+            }
+            if (counts_.size() >= capacity_) counts_.clear();
+        }
+        counts_[request.key] = {static_cast<size_t>(count), generation};
+        if (request.structuredTotal > 0) {
+            if (selectivity_.size() >= capacity_) selectivity_.clear();
+            selectivity_[request.textKey] =
+                std::min(1.0, static_cast<double>(count) / static_cast<double>(request.structuredTotal));
+        }
+    }
+}
+
+void SearchCountCache::onListingChanged(const Listing* before, const Listing* after) {
+    // Пошук бачить лише активні оголошення
+    bool wasActive = before && before->getStatusCode() == ListingStatus::Active;
+    bool isActive = after && after->getStatusCode() == ListingStatus::Active;
+    if (!wasActive && !isActive) return;
+
+    // Лічильники, фото та модерація активного оголошення кількості не змінюють
+    const uint32_t searched = ListingField::BrandId | ListingField::ModelId | ListingField::Year |
+                              ListingField::Price | ListingField::Currency | ListingField::ExchangeRate |
+                              ListingField::Description | ListingField::Region | ListingField::RegionId |
+                              ListingField::Mileage | ListingField::FuelType | ListingField::Transmission |
+                              ListingField::Color | ListingField::EngineVolume | ListingField::BodyType |
+                              ListingField::EnginePower;
+    if (wasActive && isActive && (after->getDirtyFields() & searched) == 0) return;
+    generation_.fetch_add(1);
+}
@@ -0,0 +1,87 @@
+// FILE: backend/src/services/SearchCountCache.h
+#pragma once
+#include "../database/Database.h"
+#include "../models/ListingFilter.h"
+#include "../repositories/ListingRepository.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+// Клас SearchCountCache - кількість результатів пошуку для фільтрів, яких не покриває
+// бітмап-індекс (текстовий пошук, регіон поза довідником). Точну кількість рахує фоновий
+// потік через власне з'єднання - COUNT(*) не виконується в потоках HTTP. Запис, що
+// зачіпає пошук, робить усі збережені значення застарілими (лічильник поколінь).
+// Поки точного значення немає, оцінка - точна кількість структурної частини фільтра
+// з індексу, помножена на вибірковість текстової частини з попередніх підрахунків.
+class SearchCountCache : public IListingObserver {
+public:
+    // Вибірковість текстової частини, яку ще не рахували
+    static constexpr double kDefaultSelectivity = 0.05;
+
+private:
+    struct Entry {
+        size_t total;
+        uint64_t generation;
+    };
+
+    struct Request {
+        std::string key;
+        std::string textKey;
+        ListingFilter filter;
+        size_t structuredTotal;
+    };
+
+    std::string dbPath_;
+    std::shared_ptr<ListingRepository> listingRepository_;
+    size_t capacity_;
+    size_t maxPending_;
+
+    std::atomic<uint64_t> generation_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> counts_;
+    std::unordered_map<std::string, double> selectivity_; // Ключ - textKeyOf
+    std::deque<Request> queue_;
+    std::unordered_set<std::string> pending_;
+    std::condition_variable cv_;
+    bool stopping_;
+    std::thread worker_;
+
+public:
+    SearchCountCache(const std::string& dbPath, std::shared_ptr<ListingRepository> listingRepository,
+                     size_t capacity = 4096, size_t maxPending = 64);
+    ~SearchCountCache();
+
+    SearchCountCache(const SearchCountCache&) = delete;
+    SearchCountCache& operator=(const SearchCountCache&) = delete;
+
+    void start();
+    void stop();
+
+    // Нормалізований ключ фільтра (без сортування і сторінки): порядок значень у списках
+    // і регістр тексту пошуку не впливають
+    static std::string keyOf(const ListingFilter& filter);
+    // Ключ лише текстової частини (пошук + регіон поза довідником)
+    static std::string textKeyOf(const ListingFilter& filter);
+
+    // Точна кількість, якщо вона порахована після останньої зміни оголошень
+    bool lookup(const std::string& key, size_t& total) const;
+    // Частка рядків структурної частини, що проходять текстову
+    double selectivity(const std::string& textKey) const;
+
+    // Ставить підрахунок у чергу; дублікати і запити понад maxPending відкидаються.
+    // structuredTotal - кількість без текстової частини (для вибірковості)
+    void requestCount(const ListingFilter& filter, size_t structuredTotal);
+
+    void onListingChanged(const Listing* before, const Listing* after) override;
+
+private:
+    void workerLoop();
+};
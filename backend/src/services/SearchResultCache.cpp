@@ -0,0 +1,150 @@
+// FILE: backend/src/services/SearchResultCache.cpp
+#include "SearchResultCache.h"
+#include "SearchCountCache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kPriceBuckets = 64;
+const char* const kAllTag = "all"; // Записи без тегованого виміру (напр. лише текстовий пошук)
+
+} // namespace
+
+const size_t SearchResultCache::kMaxIds;
+
+SearchResultCache::SearchResultCache(size_t capacity)
+    : capacity_(capacity), version_(0), hits_(0), misses_(0) {
+}
+
+std::string SearchResultCache::keyOf(const ListingFilter& filter, const std::string& sortBy,
+                                     const std::string& sortOrder) {
+    // Та сама перевірка сортування, що й у пошуку: невідоме поле - created_at
+    std::string field = sortBy;
+    if (field != "price" && field != "mileage" && field != "view_count" && field != "year") {
+        field = "created_at";
+    }
+    std::string order = (sortOrder == "ASC" || sortOrder == "asc") ? "ASC" : "DESC";
+    return SearchCountCache::keyOf(filter) + '\x1f' + field + ' ' + order;
+}
+
+int SearchResultCache::priceBucket(double priceUah) {
+    if (priceUah < 1000) return 0;
+    int bucket = 1 + static_cast<int>(std::log(priceUah / 1000) / std::log(1.25));
+    return std::min(bucket, kPriceBuckets - 1);
+}
+
+std::vector<std::string> SearchResultCache::tagsOf(const ListingFilter& filter) {
+    // Оголошення може потрапити у видачу, лише якщо проходить кожен вимір фільтра, тож
+    // досить тегів одного виміру - найвужчого з наявних
+    std::vector<std::string> tags;
+    if (!filter.modelIds.empty()) {
+        for (int modelId : filter.modelIds) tags.push_back("model:" + std::to_string(modelId));
+    } else if (!filter.brandIds.empty()) {
+        for (int brandId : filter.brandIds) tags.push_back("brand:" + std::to_string(brandId));
+    } else if (filter.regionId > 0) {
+        tags.push_back("region:" + std::to_string(filter.regionId));
+    } else if (filter.minPriceUah > 0 || filter.maxPriceUah > 0) {
+        int from = priceBucket(filter.minPriceUah);
+        int to = filter.maxPriceUah > 0 ? priceBucket(filter.maxPriceUah) : kPriceBuckets - 1;
+        for (int bucket = from; bucket <= to; ++bucket) tags.push_back("price:" + std::to_string(bucket));
+    } else {
+        tags.push_back(kAllTag);
+    }
+    return tags;
+}
+
+void SearchResultCache::addListingTags(const Listing& listing, std::vector<std::string>& tags) {
+    tags.push_back("model:" + std::to_string(listing.getModelId()));
+    tags.push_back("brand:" + std::to_string(listing.getBrandId()));
+    tags.push_back("region:" + std::to_string(listing.getRegionId()));
+    // Збережена price_uah рахувалась за курсом на момент запису - сусідні бакети теж
+    int bucket = priceBucket(listing.getPriceInUAH());
+    for (int b = std::max(0, bucket - 1); b <= std::min(kPriceBuckets - 1, bucket + 1); ++b) {
+        tags.push_back("price:" + std::to_string(b));
+    }
+}
+
+bool SearchResultCache::lookup(const std::string& key, Result& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    result = it->second.result;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SearchResultCache::store(const std::string& key, const ListingFilter& filter, const Result& result,
+                              uint64_t version) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Зміна оголошень під час обчислення - результат міг застаріти
+    if (version != version_.load()) return;
+
+    auto existing = entries_.find(key);
+    if (existing != entries_.end()) eraseLocked(existing);
+    while (!entries_.empty() && entries_.size() >= capacity_) {
+        eraseLocked(entries_.find(lru_.back()));
+    }
+
+    lru_.push_front(key);
+    Entry& entry = entries_[key];
+    entry.result = result;
+    entry.tags = tagsOf(filter);
+    entry.lru = lru_.begin();
+    for (const auto& tag : entry.tags) {
+        keysByTag_[tag].insert(key);
+    }
+}
+
+void SearchResultCache::eraseLocked(std::unordered_map<std::string, Entry>::iterator it) {
+    for (const auto& tag : it->second.tags) {
+        auto tagged = keysByTag_.find(tag);
+        if (tagged == keysByTag_.end()) continue;
+        tagged->second.erase(it->first);
+        if (tagged->second.empty()) keysByTag_.erase(tagged);
+    }
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+size_t SearchResultCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void SearchResultCache::onListingChanged(const Listing* before, const Listing* after) {
+    // Видача містить лише активні оголошення
+    bool wasActive = before && before->getStatusCode() == ListingStatus::Active;
+    bool isActive = after && after->getStatusCode() == ListingStatus::Active;
+    if (!wasActive && !isActive) return;
+
+    // Поля фільтрів і сортування; лічильники, фото та дати модерації видачі не змінюють
+    const uint32_t searched = ListingField::BrandId | ListingField::ModelId | ListingField::Year |
+                              ListingField::Price | ListingField::Currency | ListingField::ExchangeRate |
+                              ListingField::Description | ListingField::Region | ListingField::RegionId |
+                              ListingField::Mileage | ListingField::FuelType | ListingField::Transmission |
+                              ListingField::Color | ListingField::EngineVolume | ListingField::BodyType |
+                              ListingField::EnginePower;
+    if (wasActive && isActive && (after->getDirtyFields() & searched) == 0) return;
+
+    std::vector<std::string> tags;
+    tags.push_back(kAllTag);
+    if (before) addListingTags(*before, tags);
+    if (after) addListingTags(*after, tags);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    version_.fetch_add(1);
+    for (const auto& tag : tags) {
+        auto tagged = keysByTag_.find(tag);
+        if (tagged == keysByTag_.end()) continue;
+        std::vector<std::string> keys(tagged->second.begin(), tagged->second.end());
+        for (const auto& key : keys) {
+            auto it = entries_.find(key);
+            if (it != entries_.end()) eraseLocked(it);
+        }
+    }
+}
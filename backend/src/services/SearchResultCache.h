@@ -0,0 +1,74 @@
+// FILE: backend/src/services/SearchResultCache.h
+#pragma once
+#include "../models/ListingFilter.h"
+#include "../repositories/ListingRepository.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Клас SearchResultCache - кеш упорядкованих списків id для повторюваних запитів пошуку
+// (той самий фільтр і сортування). Сторінки нарізаються з кешованого списку, картки
+// довантажуються одним пакетним запитом. Кожен запис має теги свого найвужчого виміру
+// фільтра (модель, марка, регіон або ціновий бакет); зміна оголошення скидає лише записи
+// з тегами цього оголошення до і після зміни. Витіснення - LRU за кількістю записів.
+class SearchResultCache : public IListingObserver {
+public:
+    // Довжина кешованого префікса видачі; глибші сторінки йдуть повз кеш
+    static const size_t kMaxIds = 200;
+
+    struct Result {
+        std::vector<int> ids;    // Перші kMaxIds id у порядку сортування
+        size_t total = 0;
+        bool totalKnown = false; // false - total невідомий (префікс видачі неповний)
+    };
+
+private:
+    struct Entry {
+        Result result;
+        std::vector<std::string> tags;
+        std::list<std::string>::iterator lru;
+    };
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<std::string, std::unordered_set<std::string>> keysByTag_;
+    std::list<std::string> lru_; // Спереду - останній використаний
+    // Лічильник інвалідацій: результат, порахований до зміни, не зберігається
+    std::atomic<uint64_t> version_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+
+public:
+    explicit SearchResultCache(size_t capacity = 1024);
+
+    // Нормалізований ключ: фільтр + перевірене сортування
+    static std::string keyOf(const ListingFilter& filter, const std::string& sortBy, const std::string& sortOrder);
+    // Сортування за переглядами змінюється з кожним переглядом - такі запити не кешуються
+    static bool cacheable(const std::string& sortBy) { return sortBy != "view_count"; }
+
+    bool lookup(const std::string& key, Result& result);
+    // version - значення version() до обчислення result
+    void store(const std::string& key, const ListingFilter& filter, const Result& result, uint64_t version);
+    uint64_t version() const { return version_.load(); }
+
+    uint64_t getHitCount() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t getMissCount() const { return misses_.load(std::memory_order_relaxed); }
+    size_t size() const;
+
+    void onListingChanged(const Listing* before, const Listing* after) override;
+
+    // Геометричний ціновий бакет (крок 25% від 1 тис. грн)
+    static int priceBucket(double priceUah);
+
+private:
+    static std::vector<std::string> tagsOf(const ListingFilter& filter);
+    static void addListingTags(const Listing& listing, std::vector<std::string>& tags);
+    void eraseLocked(std::unordered_map<std::string, Entry>::iterator it);
+};
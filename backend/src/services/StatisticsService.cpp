@@ -91,9 +91,9 @@ SellerStatistics StatisticsService::getSellerStatistics(int sellerId) {
     std::vector<std::pair<std::string, int>> popular; // (listing_name, views)
     
     for (const auto& listing : listings) {
-        if (listing->getStatus() == "active") {
+        if (listing->getStatusCode() == ListingStatus::Active) {
             stats.activeListings++;
-        } else if (listing->getStatus() == "sold") {
+        } else if (listing->getStatusCode() == ListingStatus::Sold) {
             stats.soldListings++;
         }
         
@@ -149,18 +149,27 @@ SellerStatistics StatisticsService::getSellerStatistics(int sellerId) {
 }
 
 double StatisticsService::calculateAveragePriceByRegion(int brandId, int modelId, const std::string& region) {
-    std::ostringstream sql;
-    sql << "SELECT AVG(price) FROM listings WHERE brand_id = " << brandId
-        << " AND model_id = " << modelId
-        << " AND status = 'active'";
-    if (!region.empty()) {
-        sql << " AND region = '" << region << "'";
+    // Будь-яке написання регіону з довідника зводиться до region_id; інакше - точний текст
+    auto regions = listingRepository_ ? listingRepository_->getRegionDirectory() : nullptr;
+    int regionId = (regions && !region.empty()) ? regions->resolve(region) : 0;
+    
+    std::string sql = "SELECT AVG(price) FROM listings WHERE brand_id = ? AND model_id = ? AND status = 'active'";
+    if (regionId > 0) {
+        sql += " AND region_id = ?";
+    } else if (!region.empty()) {
+        sql += " AND region = ?";
     }
     
     sqlite3_stmt* stmt;
-    const char* sqlStr = sql.str().c_str();
     double avgPrice = 0.0;
-    if (sqlite3_prepare_v2(db_->getHandle(), sqlStr, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(db_->getHandle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, brandId);
+        sqlite3_bind_int(stmt, 2, modelId);
+        if (regionId > 0) {
+            sqlite3_bind_int(stmt, 3, regionId);
+        } else if (!region.empty()) {
+            sqlite3_bind_text(stmt, 3, region.c_str(), static_cast<int>(region.length()), SQLITE_TRANSIENT);
+        }
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             avgPrice = sqlite3_column_double(stmt, 0);
         }
@@ -0,0 +1,105 @@
+// FILE: backend/src/services/UnreadCounters.cpp
+#include "UnreadCounters.h"
+#include <algorithm>
+#include <iostream>
+
+UnreadCounters::UnreadCounters(std::shared_ptr<Database> db) : db_(db), reconciledAt_(0) {
+}
+
+UnreadCounters::~UnreadCounters() {
+    stopReconciliation();
+}
+
+bool UnreadCounters::reconcile() {
+    if (!db_ || !db_->getHandle()) return false;
+
+    std::unordered_map<int, UnreadCounts> counts;
+    sqlite3_stmt* stmt;
+    const char* notificationSql = "SELECT user_id, COUNT(*) FROM notifications WHERE is_read = 0 GROUP BY user_id";
+    if (sqlite3_prepare_v2(db_->getHandle(), notificationSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        counts[sqlite3_column_int(stmt, 0)].notifications = sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+
+    const char* messageSql = "SELECT receiver_id, COUNT(*) FROM messages "
+                             "WHERE is_read = 0 AND status = 'active' AND sender_id != receiver_id "
+                             "GROUP BY receiver_id";
+    if (sqlite3_prepare_v2(db_->getHandle(), messageSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        counts[sqlite3_column_int(stmt, 0)].messages = sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+
+    // Записи, що відбулися під час звірки, будуть виправлені наступною звіркою
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        counts_.swap(counts);
+    }
+    reconciledAt_.store(time(nullptr));
+    return true;
+}
+
+void UnreadCounters::startReconciliation(std::chrono::seconds interval) {
+    reconcileTask_ = std::make_unique<PeriodicTask>(interval, [this] {
+        if (!reconcile()) {
+            std::cerr << "Unread counters reconciliation failed" << std::endl;
+        }
+    });
+    reconcileTask_->start();
+}
+
+void UnreadCounters::stopReconciliation() {
+    if (reconcileTask_) {
+        reconcileTask_->stop();
+        reconcileTask_.reset();
+    }
+}
+
+UnreadCounts UnreadCounters::get(int userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counts_.find(userId);
+    return it != counts_.end() ? it->second : UnreadCounts{0, 0};
+}
+
+void UnreadCounters::eraseIfEmptyLocked(std::unordered_map<int, UnreadCounts>::iterator it) {
+    if (it->second.notifications == 0 && it->second.messages == 0) {
+        counts_.erase(it);
+    }
+}
+
+void UnreadCounters::addNotifications(int userId, long long delta) {
+    if (userId <= 0 || delta == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counts_.emplace(userId, UnreadCounts{0, 0}).first;
+    it->second.notifications = std::max(0LL, it->second.notifications + delta);
+    eraseIfEmptyLocked(it);
+}
+
+void UnreadCounters::addMessages(int userId, long long delta) {
+    if (userId <= 0 || delta == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counts_.emplace(userId, UnreadCounts{0, 0}).first;
+    it->second.messages = std::max(0LL, it->second.messages + delta);
+    eraseIfEmptyLocked(it);
+}
+
+void UnreadCounters::clearNotifications(int userId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counts_.find(userId);
+    if (it == counts_.end()) return;
+    it->second.notifications = 0;
+    eraseIfEmptyLocked(it);
+}
+
+void UnreadCounters::clearMessages(int userId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counts_.find(userId);
+    if (it == counts_.end()) return;
+    it->second.messages = 0;
+    eraseIfEmptyLocked(it);
+}
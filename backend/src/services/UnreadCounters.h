@@ -0,0 +1,51 @@
+// FILE: backend/src/services/UnreadCounters.h
+#pragma once
+#include "../database/Database.h"
+#include "../utils/PeriodicTask.h"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Непрочитані сповіщення та повідомлення користувача (бейджі в інтерфейсі)
+struct UnreadCounts {
+    long long notifications;
+    long long messages; // Доставлені (status = 'active') повідомлення від інших користувачів
+};
+
+// Клас UnreadCounters - лічильники непрочитаного в пам'яті, O(1) на запит.
+// Оновлюються після коміту запису (нове сповіщення, доставка повідомлення, прочитання),
+// звіряються з SQLite при старті та за таймером.
+class UnreadCounters {
+private:
+    std::shared_ptr<Database> db_;
+    mutable std::mutex mutex_;
+    std::unordered_map<int, UnreadCounts> counts_; // Лише користувачі з ненульовими лічильниками
+    std::atomic<time_t> reconciledAt_;
+    std::unique_ptr<PeriodicTask> reconcileTask_;
+
+public:
+    explicit UnreadCounters(std::shared_ptr<Database> db);
+    ~UnreadCounters();
+
+    // Повний перерахунок з БД (дві GROUP BY вибірки по частковим індексам)
+    bool reconcile();
+
+    // Періодична звірка у фоновому потоці
+    void startReconciliation(std::chrono::seconds interval);
+    void stopReconciliation();
+
+    UnreadCounts get(int userId) const;
+    time_t getReconciledAt() const { return reconciledAt_.load(); }
+
+    // Зміни після успішного запису (лічильник не стає від'ємним)
+    void addNotifications(int userId, long long delta);
+    void addMessages(int userId, long long delta);
+    void clearNotifications(int userId);
+    void clearMessages(int userId);
+
+private:
+    void eraseIfEmptyLocked(std::unordered_map<int, UnreadCounts>::iterator it);
+};
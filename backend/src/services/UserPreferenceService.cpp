@@ -0,0 +1,242 @@
+// FILE: backend/src/services/UserPreferenceService.cpp
+#include "UserPreferenceService.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <queue>
+
+namespace {
+
+// Ваги вимірів профілю в оцінці кандидата (частки профілю в [0, 1])
+const float kBrandWeight = 3.0f;
+const float kModelWeight = 4.0f;
+const float kPriceWeight = 2.0f;
+const float kBodyTypeWeight = 1.5f;
+const float kRegionWeight = 1.0f;
+const float kNeighborBandShare = 0.5f; // Сусідній ціновий діапазон - половина ваги
+
+double signalWeight(PreferenceSignal signal) {
+    switch (signal) {
+        case PreferenceSignal::View: return 1.0;
+        case PreferenceSignal::Comparison: return 2.0;
+        case PreferenceSignal::Favorite: return 3.0;
+        case PreferenceSignal::Message: return 4.0;
+    }
+    return 1.0;
+}
+
+double decayFactor(time_t elapsed) {
+    if (elapsed <= 0) return 1.0;
+    return std::exp2(-static_cast<double>(elapsed) / UserPreferenceService::kHalfLifeSeconds);
+}
+
+// Приводить усі ваги профілю до моменту now
+void decayTo(PreferenceProfile& profile, time_t now) {
+    if (now <= profile.updatedAt) return;
+    double factor = decayFactor(now - profile.updatedAt);
+    profile.updatedAt = now;
+    if (factor == 1.0) return;
+    profile.total *= factor;
+    for (auto& entry : profile.brands) entry.second *= factor;
+    for (auto& entry : profile.models) entry.second *= factor;
+    for (auto& weight : profile.priceBands) weight *= factor;
+    for (auto& weight : profile.bodyTypes) weight *= factor;
+    for (auto& entry : profile.regions) entry.second *= factor;
+}
+
+void addInteraction(PreferenceProfile& profile, int listingId, int brandId, int modelId,
+                    double priceUah, const std::string& bodyType, const std::string& region, double weight) {
+    profile.total += weight;
+    profile.brands[brandId] += weight;
+    profile.models[modelId] += weight;
+    profile.priceBands[FeatureIndex::priceBandOf(priceUah)] += weight;
+    profile.bodyTypes[FeatureIndex::bodyTypeCode(bodyType)] += weight;
+    if (!region.empty()) {
+        profile.regions[region] += weight;
+    }
+    profile.seen.insert(listingId);
+}
+
+double priceInUah(double price, const std::string& currency, double exchangeRate) {
+    return parseCurrency(currency) != Currency::UAH && exchangeRate > 0 ? price * exchangeRate : price;
+}
+
+// Частки профілю у вигляді щільної таблиці за id - O(1) на кандидата
+std::vector<float> denseWeights(const std::unordered_map<int, double>& affinities, double total, float weight) {
+    int maxId = 0;
+    for (const auto& entry : affinities) maxId = std::max(maxId, entry.first);
+    std::vector<float> dense(maxId + 1, 0.0f);
+    for (const auto& entry : affinities) {
+        if (entry.first > 0) dense[entry.first] = static_cast<float>(entry.second / total) * weight;
+    }
+    return dense;
+}
+
+inline float lookup(const std::vector<float>& dense, int id) {
+    return id >= 0 && static_cast<size_t>(id) < dense.size() ? dense[id] : 0.0f;
+}
+
+} // namespace
+
+UserPreferenceService::UserPreferenceService(std::shared_ptr<Database> db, std::shared_ptr<FeatureIndex> featureIndex)
+    : db_(db), featureIndex_(featureIndex) {
+}
+
+std::unique_ptr<PreferenceProfile> UserPreferenceService::loadProfile(int userId, time_t now) {
+    auto profile = std::unique_ptr<PreferenceProfile>(new PreferenceProfile());
+    profile->updatedAt = now;
+    profile->lastAccess = now;
+
+    // Уся історія одним запитом; kind - PreferenceSignal
+    const char* sql =
+        "SELECT e.listing_id, e.at, e.kind, l.brand_id, l.model_id, l.price, l.currency, l.exchange_rate, "
+        "l.body_type, l.region FROM ("
+        "  SELECT listing_id, viewed_at AS at, 0 AS kind FROM listing_views WHERE user_id = ?1"
+        "  UNION ALL SELECT CAST(j.value AS INTEGER), c.created_at, 1 FROM listing_comparisons c, "
+        "    json_each(CASE WHEN json_valid(c.listing_ids) THEN c.listing_ids ELSE '[]' END) j WHERE c.user_id = ?1"
+        "  UNION ALL SELECT listing_id, created_at, 2 FROM favorites WHERE user_id = ?1"
+        "  UNION ALL SELECT listing_id, created_at, 3 FROM messages WHERE sender_id = ?1 AND listing_id IS NOT NULL"
+        ") e JOIN listings l ON l.id = e.listing_id";
+    sqlite3* handle = db_->getHandle();
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to load preference profile: " << sqlite3_errmsg(handle) << std::endl;
+        return profile;
+    }
+
+    auto text = [stmt](int column) {
+        const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+        return std::string(value ? value : "");
+    };
+
+    sqlite3_bind_int(stmt, 1, userId);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int kind = std::min(3, std::max(0, sqlite3_column_int(stmt, 2)));
+        time_t at = static_cast<time_t>(sqlite3_column_int64(stmt, 1));
+        double weight = signalWeight(static_cast<PreferenceSignal>(kind)) * decayFactor(now - at);
+        addInteraction(*profile, sqlite3_column_int(stmt, 0),
+                       sqlite3_column_int(stmt, 3), sqlite3_column_int(stmt, 4),
+                       priceInUah(sqlite3_column_double(stmt, 5), text(6), sqlite3_column_double(stmt, 7)),
+                       text(8), text(9), weight);
+    }
+    sqlite3_finalize(stmt);
+    return profile;
+}
+
+PreferenceProfile* UserPreferenceService::findOrLoad(std::unique_lock<std::mutex>& lock, int userId, time_t now) {
+    auto it = profiles_.find(userId);
+    if (it == profiles_.end()) {
+        lock.unlock();
+        auto loaded = loadProfile(userId, now);
+        lock.lock();
+        // Паралельний запит міг завантажити профіль раніше - лишаємо наявний
+        it = profiles_.emplace(userId, std::move(loaded)).first;
+        evictLocked();
+        it = profiles_.find(userId);
+    }
+    PreferenceProfile* profile = it->second.get();
+    profile->lastAccess = now;
+    decayTo(*profile, now);
+    return profile;
+}
+
+void UserPreferenceService::evictLocked() {
+    while (profiles_.size() > kMaxProfiles) {
+        auto oldest = profiles_.begin();
+        for (auto it = profiles_.begin(); it != profiles_.end(); ++it) {
+            if (it->second->lastAccess < oldest->second->lastAccess) oldest = it;
+        }
+        profiles_.erase(oldest);
+    }
+}
+
+void UserPreferenceService::recordSignal(int userId, const Listing& listing, PreferenceSignal signal) {
+    if (userId <= 0) return;
+    time_t now = time(nullptr);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = profiles_.find(userId);
+    if (it == profiles_.end()) return;
+
+    PreferenceProfile& profile = *it->second;
+    decayTo(profile, now);
+    addInteraction(profile, listing.getId(), listing.getBrandId(), listing.getModelId(),
+                   priceInUah(listing.getPrice(), listing.getCurrency(), listing.getExchangeRate()),
+                   listing.getBodyType(), listing.getRegion(), signalWeight(signal));
+}
+
+std::vector<ScoredListing> UserPreferenceService::recommend(int userId, size_t limit) {
+    std::vector<ScoredListing> result;
+    if (limit == 0) return result;
+    time_t now = time(nullptr);
+
+    // 1. Профіль -> щільні таблиці ваг; під блокуванням лише копіювання
+    std::vector<float> brandWeights, modelWeights;
+    std::array<float, FeatureIndex::kPriceBands> priceWeights{};
+    std::array<float, FeatureIndex::kBodyTypes> bodyWeights{};
+    std::vector<std::pair<std::string, float>> regionShares;
+    std::unordered_set<int> seen;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        PreferenceProfile* profile = findOrLoad(lock, userId, now);
+        if (profile->total <= 0) return result;
+
+        double total = profile->total;
+        brandWeights = denseWeights(profile->brands, total, kBrandWeight);
+        modelWeights = denseWeights(profile->models, total, kModelWeight);
+        for (int band = 0; band < FeatureIndex::kPriceBands; ++band) {
+            float share = static_cast<float>(profile->priceBands[band] / total) * kPriceWeight;
+            priceWeights[band] += share;
+            if (band > 0) priceWeights[band - 1] += share * kNeighborBandShare;
+            if (band + 1 < FeatureIndex::kPriceBands) priceWeights[band + 1] += share * kNeighborBandShare;
+        }
+        // Код 0 (тип кузова не вказано) не є вподобанням
+        for (int code = 1; code < FeatureIndex::kBodyTypes; ++code) {
+            bodyWeights[code] = static_cast<float>(profile->bodyTypes[code] / total) * kBodyTypeWeight;
+        }
+        for (const auto& entry : profile->regions) {
+            regionShares.emplace_back(entry.first, static_cast<float>(entry.second / total) * kRegionWeight);
+        }
+        seen = profile->seen;
+    }
+
+    std::vector<float> regionWeights;
+    for (const auto& share : regionShares) {
+        uint16_t code = featureIndex_->findRegionCode(share.first);
+        if (code == 0) continue;
+        if (regionWeights.size() <= code) regionWeights.resize(code + 1, 0.0f);
+        regionWeights[code] = share.second;
+    }
+
+    // 2. Один прохід по активних оголошеннях з min-купою з limit найкращих
+    struct Candidate {
+        float score;
+        int listingId;
+        // Більший бал, за рівності - новіше (більший id) оголошення
+        bool operator>(const Candidate& other) const {
+            return score != other.score ? score > other.score : listingId > other.listingId;
+        }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> best;
+
+    featureIndex_->forEachRow([&](int listingId, const FeatureIndex::Attributes& row) {
+        if (row.sellerId == userId) return;
+        float score = lookup(brandWeights, row.brandId) + lookup(modelWeights, row.modelId) +
+                      priceWeights[row.priceBand] + bodyWeights[row.bodyType] +
+                      lookup(regionWeights, row.region);
+        if (score <= 0.0f) return;
+        Candidate candidate = {score, listingId};
+        if (best.size() >= limit && !(candidate > best.top())) return;
+        // Вже переглянуті не пропонуємо; перевірка лише для тих, хто проходить у top
+        if (seen.count(listingId)) return;
+        if (best.size() >= limit) best.pop();
+        best.push(candidate);
+    });
+
+    result.resize(best.size());
+    for (size_t i = result.size(); i-- > 0;) {
+        result[i] = {best.top().listingId, best.top().score};
+        best.pop();
+    }
+    return result;
+}
@@ -0,0 +1,73 @@
+// FILE: backend/src/services/UserPreferenceService.h
+#pragma once
+#include "../database/Database.h"
+#include "../models/Listing.h"
+#include "FeatureIndex.h"
+#include <array>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Тип взаємодії користувача з оголошенням; вага - сила сигналу вподобань
+enum class PreferenceSignal {
+    View,       // 1
+    Comparison, // 2
+    Favorite,   // 3
+    Message     // 4 - написав продавцю
+};
+
+// Оцінене оголошення для персональних рекомендацій
+struct ScoredListing {
+    int listingId;
+    float score;
+};
+
+// Профіль вподобань: згасаючі (експоненційно, з періодом напіврозпаду) ваги
+// марок, моделей, цінових діапазонів, типів кузова та регіонів.
+// Усі ваги приведені до моменту updatedAt.
+struct PreferenceProfile {
+    time_t updatedAt = 0;
+    time_t lastAccess = 0;
+    double total = 0;
+    std::unordered_map<int, double> brands;
+    std::unordered_map<int, double> models;
+    std::array<double, FeatureIndex::kPriceBands> priceBands{};
+    std::array<double, FeatureIndex::kBodyTypes> bodyTypes{};
+    std::unordered_map<std::string, double> regions;
+    std::unordered_set<int> seen; // Оголошення, з якими вже була взаємодія
+};
+
+// Клас UserPreferenceService - персональні рекомендації з повної історії користувача
+// (перегляди, порівняння, обране, повідомлення). Профіль будується з БД одним запитом
+// при першому зверненні, далі кешується в пам'яті та оновлюється інкрементально.
+// Кандидати оцінюються за один прохід по рядках FeatureIndex (активні оголошення).
+class UserPreferenceService {
+public:
+    static const time_t kHalfLifeSeconds = 30 * 24 * 3600;
+    static const size_t kMaxProfiles = 10000; // Понад ліміт витісняється найдавніший за доступом
+
+private:
+    std::shared_ptr<Database> db_;
+    std::shared_ptr<FeatureIndex> featureIndex_;
+    std::mutex mutex_; // Захищає profiles_ та вміст профілів
+    std::unordered_map<int, std::unique_ptr<PreferenceProfile>> profiles_;
+
+public:
+    UserPreferenceService(std::shared_ptr<Database> db, std::shared_ptr<FeatureIndex> featureIndex);
+
+    // Інкрементальне оновлення закешованого профілю (незакешований буде прочитано з БД разом з подією)
+    void recordSignal(int userId, const Listing& listing, PreferenceSignal signal);
+
+    // До limit найкращих активних оголошень (крім власних та вже переглянутих)
+    std::vector<ScoredListing> recommend(int userId, size_t limit);
+
+private:
+    // Профіль з кешу або з БД (читання - без блокування, lock знімається на цей час)
+    PreferenceProfile* findOrLoad(std::unique_lock<std::mutex>& lock, int userId, time_t now);
+    std::unique_ptr<PreferenceProfile> loadProfile(int userId, time_t now);
+    void evictLocked();
+};
@@ -0,0 +1,134 @@
+// FILE: backend/src/utils/AhoCorasick.cpp
+#include "AhoCorasick.h"
+#include "Utf8.h"
+#include <queue>
+
+AhoCorasick::AhoCorasick(const std::vector<std::string>& patterns)
+    : directClass_(kDirectClasses, 0), alphabetSize_(1), patternCount_(patterns.size()) {
+    // Шаблони в нижньому регістрі як послідовності класів символів
+    std::vector<std::vector<uint16_t>> encoded;
+    encoded.reserve(patterns.size());
+    size_t maxStates = 1;
+    for (const auto& pattern : patterns) {
+        std::vector<uint16_t> classes;
+        size_t pos = 0;
+        while (pos < pattern.size()) {
+            classes.push_back(addClass(utf8::foldCase(utf8::decode(pattern, pos))));
+        }
+        maxStates += classes.size();
+        encoded.push_back(std::move(classes));
+    }
+    
+    // Бор: переходи одразу в пласкій таблиці, -1 - переходу немає
+    transitions_.assign(maxStates * alphabetSize_, -1);
+    patternAt_.assign(1, -1);
+    for (size_t p = 0; p < encoded.size(); ++p) {
+        if (encoded[p].empty()) continue;
+        int32_t state = 0;
+        for (uint16_t c : encoded[p]) {
+            int32_t& next = transitions_[state * alphabetSize_ + c];
+            if (next < 0) {
+                next = static_cast<int32_t>(patternAt_.size());
+                patternAt_.push_back(-1);
+            }
+            state = next;
+        }
+        if (patternAt_[state] < 0) {
+            patternAt_[state] = static_cast<int32_t>(p);
+        }
+    }
+    size_t stateCount = patternAt_.size();
+    transitions_.resize(stateCount * alphabetSize_);
+    transitions_.shrink_to_fit();
+    
+    // BFS: суфіксні посилання та перетворення бору на повний ДСА
+    std::vector<int32_t> fail(stateCount, 0);
+    outputLink_.assign(stateCount, -1);
+    std::queue<int32_t> queue;
+    for (size_t c = 0; c < alphabetSize_; ++c) {
+        int32_t& next = transitions_[c];
+        if (next < 0) {
+            next = 0;
+        } else {
+            queue.push(next);
+        }
+    }
+    while (!queue.empty()) {
+        int32_t state = queue.front();
+        queue.pop();
+        int32_t* row = &transitions_[state * alphabetSize_];
+        const int32_t* failRow = &transitions_[fail[state] * alphabetSize_];
+        for (size_t c = 0; c < alphabetSize_; ++c) {
+            if (row[c] < 0) {
+                row[c] = failRow[c];
+            } else {
+                int32_t child = row[c];
+                fail[child] = failRow[c];
+                outputLink_[child] = patternAt_[fail[child]] >= 0 ? fail[child] : outputLink_[fail[child]];
+                queue.push(child);
+            }
+        }
+    }
+}
+
+uint16_t AhoCorasick::addClass(char32_t cp) {
+    uint16_t existing = classOf(cp);
+    if (existing != 0) return existing;
+    
+    uint16_t cls = static_cast<uint16_t>(alphabetSize_++);
+    if (cp < kDirectClasses) {
+        directClass_[cp] = cls;
+    } else {
+        otherClasses_[cp] = cls;
+    }
+    return cls;
+}
+
+uint16_t AhoCorasick::classOf(char32_t cp) const {
+    if (cp < kDirectClasses) {
+        return directClass_[cp];
+    }
+    auto it = otherClasses_.find(cp);
+    return it != otherClasses_.end() ? it->second : 0;
+}
+
+std::vector<size_t> AhoCorasick::findAll(const std::string& text) const {
+    std::vector<size_t> found;
+    std::vector<bool> seen(patternCount_, false);
+    int32_t state = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        uint16_t c = classOf(utf8::foldCase(utf8::decode(text, pos)));
+        state = transitions_[state * alphabetSize_ + c];
+        
+        for (int32_t s = patternAt_[state] >= 0 ? state : outputLink_[state]; s >= 0; s = outputLink_[s]) {
+            size_t pattern = static_cast<size_t>(patternAt_[s]);
+            if (!seen[pattern]) {
+                seen[pattern] = true;
+                found.push_back(pattern);
+            }
+        }
+    }
+    return found;
+}
+
+bool AhoCorasick::containsAny(const std::string& text) const {
+    int32_t state = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        uint16_t c = classOf(utf8::foldCase(utf8::decode(text, pos)));
+        state = transitions_[state * alphabetSize_ + c];
+        if (patternAt_[state] >= 0 || outputLink_[state] >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t AhoCorasick::getMemoryUsage() const {
+    return transitions_.capacity() * sizeof(int32_t)
+         + patternAt_.capacity() * sizeof(int32_t)
+         + outputLink_.capacity() * sizeof(int32_t)
+         + directClass_.capacity() * sizeof(uint16_t)
+         + otherClasses_.size() * (sizeof(char32_t) + sizeof(uint16_t) + 2 * sizeof(void*));
+}
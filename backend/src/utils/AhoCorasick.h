@@ -0,0 +1,48 @@
+// FILE: backend/src/utils/AhoCorasick.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Клас AhoCorasick - скомпільований автомат для пошуку багатьох шаблонів
+// за один прохід по UTF-8 тексту. Шаблони і текст приводяться до нижнього
+// регістру (utf8::foldCase), збіг - як підрядок.
+//
+// Символи шаблонів стискаються в компактний алфавіт (клас 0 - будь-який
+// символ, якого немає в словнику), переходи зберігаються пласким масивом
+// states x alphabet, тож крок автомата - одне звернення до пам'яті.
+class AhoCorasick {
+private:
+    static const char32_t kDirectClasses = 0x500; // Латиниця та кирилиця - прямою таблицею
+    
+    std::vector<uint16_t> directClass_;                    // Клас символу для cp < kDirectClasses
+    std::unordered_map<char32_t, uint16_t> otherClasses_;  // Клас для решти символів
+    size_t alphabetSize_;
+    
+    std::vector<int32_t> transitions_; // [state * alphabetSize_ + class] -> state
+    std::vector<int32_t> patternAt_;   // Шаблон, що закінчується в стані (-1 - немає)
+    std::vector<int32_t> outputLink_;  // Найближчий суфіксний стан з шаблоном (-1 - немає)
+    size_t patternCount_;
+
+public:
+    explicit AhoCorasick(const std::vector<std::string>& patterns);
+    
+    // Індекси знайдених шаблонів (кожен - один раз) у порядку першої появи в тексті.
+    // Шаблони, що збігаються після приведення регістру, мають індекс першого з них.
+    std::vector<size_t> findAll(const std::string& text) const;
+    
+    // Чи містить текст хоча б один шаблон (зупиняється на першому збігу)
+    bool containsAny(const std::string& text) const;
+    
+    size_t getPatternCount() const { return patternCount_; }
+    size_t getStateCount() const { return patternAt_.size(); }
+    size_t getAlphabetSize() const { return alphabetSize_; }
+    
+    // Приблизний обсяг пам'яті автомата в байтах
+    size_t getMemoryUsage() const;
+
+private:
+    uint16_t classOf(char32_t cp) const;
+    uint16_t addClass(char32_t cp);
+};
@@ -0,0 +1,24 @@
+// FILE: backend/src/utils/InternedString.cpp
+#include "InternedString.h"
+
+InternedString::Vocabulary::Vocabulary(std::initializer_list<const char*> values)
+    : values_(values.begin(), values.end()) {
+}
+
+const std::string* InternedString::Vocabulary::find(const std::string& value) const {
+    // Словники на кілька значень - лінійний пошук швидший за хешування
+    for (const auto& known : values_) {
+        if (known == value) return &known;
+    }
+    return nullptr;
+}
+
+InternedString::InternedString(const std::string& value, const Vocabulary& vocabulary)
+    : value_(value.empty() ? &emptyValue() : vocabulary.find(value)) {
+    if (!value_) own_ = value;
+}
+
+const std::string& InternedString::emptyValue() {
+    static const std::string empty;
+    return empty;
+}
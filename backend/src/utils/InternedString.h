@@ -0,0 +1,42 @@
+// FILE: backend/src/utils/InternedString.h
+#pragma once
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Значення поля із закритим словником (тип пального, коробка, тип кузова). Відоме
+// значення - вказівник на єдину копію в таблиці словника (без алокації, порівняння за
+// вказівником); невідоме (старі записи, довільне введення) зберігається власною копією.
+// Таблиці задаються в коді й не ростуть - для вільного тексту (регіон, колір) не потрібне.
+class InternedString {
+public:
+    // Фіксований набір значень поля; має жити до кінця процесу
+    class Vocabulary {
+    private:
+        std::vector<std::string> values_;
+
+    public:
+        Vocabulary(std::initializer_list<const char*> values);
+        // nullptr - значення немає в словнику
+        const std::string* find(const std::string& value) const;
+    };
+
+private:
+    const std::string* value_; // Значення зі словника; nullptr - значення в own_
+    std::string own_;
+
+public:
+    InternedString() : value_(&emptyValue()) {}
+    InternedString(const std::string& value, const Vocabulary& vocabulary);
+    
+    const std::string& str() const { return value_ ? *value_ : own_; }
+    bool empty() const { return str().empty(); }
+    
+    bool operator==(const InternedString& other) const {
+        return (value_ && value_ == other.value_) || str() == other.str();
+    }
+    bool operator!=(const InternedString& other) const { return !(*this == other); }
+
+private:
+    static const std::string& emptyValue();
+};
@@ -0,0 +1,30 @@
+// FILE: backend/src/utils/JsonEscape.cpp
+#include "JsonEscape.h"
+
+std::string escapeJson(const std::string& str) {
+    static const char kHex[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(str.size() + 8);
+    for (char ch : str) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\b': result += "\\b"; break;
+            case '\f': result += "\\f"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    result += "\\u00";
+                    result += kHex[c >> 4];
+                    result += kHex[c & 0x0F];
+                } else {
+                    result += ch;
+                }
+                break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,7 @@
+// FILE: backend/src/utils/JsonEscape.h
+#pragma once
+#include <string>
+
+// Екранування рядка для вставки в JSON між лапками. Контрольні символи (0x00-0x1F)
+// стають \uXXXX, решта байтів (включно з UTF-8) копіюється як є.
+std::string escapeJson(const std::string& str);
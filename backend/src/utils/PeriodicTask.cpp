@@ -0,0 +1,50 @@
+// FILE: backend/src/utils/PeriodicTask.cpp
+#include "PeriodicTask.h"
+#include <exception>
+#include <iostream>
+
+PeriodicTask::PeriodicTask(std::chrono::milliseconds interval, std::function<void()> task)
+    : interval_(interval), task_(std::move(task)), stopping_(false), runImmediately_(false) {
+}
+
+PeriodicTask::~PeriodicTask() {
+    stop();
+}
+
+void PeriodicTask::start(bool runImmediately) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    runImmediately_ = runImmediately;
+    thread_ = std::thread(&PeriodicTask::run, this);
+}
+
+void PeriodicTask::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+void PeriodicTask::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool skipWait = runImmediately_;
+    while (!stopping_) {
+        if (!skipWait && cv_.wait_for(lock, interval_, [this] { return stopping_; })) {
+            break;
+        }
+        skipWait = false;
+        lock.unlock();
+        try {
+            task_();
+        } catch (const std::exception& e) {
+            // Помилка задачі не повинна зупиняти таймер
+            std::cerr << "Periodic task failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
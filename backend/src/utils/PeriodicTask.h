@@ -0,0 +1,35 @@
+// FILE: backend/src/utils/PeriodicTask.h
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Клас PeriodicTask - фоновий потік, що виконує задачу з заданим інтервалом
+class PeriodicTask {
+private:
+    std::chrono::milliseconds interval_;
+    std::function<void()> task_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_;
+    bool runImmediately_;
+
+public:
+    PeriodicTask(std::chrono::milliseconds interval, std::function<void()> task);
+    ~PeriodicTask();
+
+    PeriodicTask(const PeriodicTask&) = delete;
+    PeriodicTask& operator=(const PeriodicTask&) = delete;
+
+    // Запуск потоку (перше виконання - через interval або одразу, у фоновому потоці)
+    void start(bool runImmediately = false);
+
+    // Зупинка з очікуванням завершення поточного виконання
+    void stop();
+
+private:
+    void run();
+};
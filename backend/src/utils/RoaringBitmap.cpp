@@ -0,0 +1,284 @@
+// FILE: backend/src/utils/RoaringBitmap.cpp
+#include "RoaringBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (isBitset()) {
+        return (words[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(values.begin(), values.end(), low);
+}
+
+RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t key) {
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return it != containers_.end() && it->key == key ? &*it : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t key) const {
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return it != containers_.end() && it->key == key ? &*it : nullptr;
+}
+
+void RoaringBitmap::toBitset(Container& c) {
+    c.words.assign(kWords, 0);
+    for (uint16_t low : c.values) {
+        c.words[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    c.values.clear();
+    c.values.shrink_to_fit();
+}
+
+void RoaringBitmap::toArray(Container& c) {
+    c.values.clear();
+    c.values.reserve(c.cardinality);
+    for (size_t w = 0; w < kWords; ++w) {
+        uint64_t word = c.words[w];
+        while (word) {
+            c.values.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+    c.words.clear();
+    c.words.shrink_to_fit();
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+        Container c;
+        c.key = key;
+        c.cardinality = 0;
+        it = containers_.insert(it, std::move(c));
+    }
+    Container& c = *it;
+    if (c.isBitset()) {
+        uint64_t& word = c.words[low >> 6];
+        uint64_t mask = uint64_t(1) << (low & 63);
+        if (word & mask) return;
+        word |= mask;
+    } else {
+        auto pos = std::lower_bound(c.values.begin(), c.values.end(), low);
+        if (pos != c.values.end() && *pos == low) return;
+        c.values.insert(pos, low);
+        if (c.values.size() > kArrayMax) {
+            c.cardinality++;
+            cardinality_++;
+            toBitset(c);
+            return;
+        }
+    }
+    c.cardinality++;
+    cardinality_++;
+}
+
+bool RoaringBitmap::remove(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) return false;
+    Container& c = *it;
+    if (c.isBitset()) {
+        uint64_t& word = c.words[low >> 6];
+        uint64_t mask = uint64_t(1) << (low & 63);
+        if (!(word & mask)) return false;
+        word &= ~mask;
+        c.cardinality--;
+        // Гістерезис: назад у масив лише з половини порогу, щоб не перемикатись на межі
+        if (c.cardinality <= kArrayMax / 2) toArray(c);
+    } else {
+        auto pos = std::lower_bound(c.values.begin(), c.values.end(), low);
+        if (pos == c.values.end() || *pos != low) return false;
+        c.values.erase(pos);
+        c.cardinality--;
+    }
+    cardinality_--;
+    if (c.cardinality == 0) containers_.erase(it);
+    return true;
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    const Container* c = findContainer(static_cast<uint16_t>(value >> 16));
+    return c && c->contains(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+void RoaringBitmap::clear() {
+    containers_.clear();
+    cardinality_ = 0;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersectContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    result.cardinality = 0;
+    if (a.isBitset() && b.isBitset()) {
+        result.words.resize(kWords);
+        uint32_t count = 0;
+        for (size_t w = 0; w < kWords; ++w) {
+            result.words[w] = a.words[w] & b.words[w];
+            count += static_cast<uint32_t>(__builtin_popcountll(result.words[w]));
+        }
+        result.cardinality = count;
+        if (count <= kArrayMax) toArray(result);
+    } else if (a.isBitset() || b.isBitset()) {
+        // Масив перевіряється по бітсету - O(розмір масиву)
+        const Container& array = a.isBitset() ? b : a;
+        const Container& bits = a.isBitset() ? a : b;
+        for (uint16_t low : array.values) {
+            if ((bits.words[low >> 6] >> (low & 63)) & 1) result.values.push_back(low);
+        }
+        result.cardinality = static_cast<uint32_t>(result.values.size());
+    } else {
+        const Container& small = a.values.size() <= b.values.size() ? a : b;
+        const Container& large = a.values.size() <= b.values.size() ? b : a;
+        if (small.values.size() * 32 < large.values.size()) {
+            // Дуже різні розміри - бінарний пошук з просуванням замість злиття
+            auto from = large.values.begin();
+            for (uint16_t low : small.values) {
+                from = std::lower_bound(from, large.values.end(), low);
+                if (from == large.values.end()) break;
+                if (*from == low) result.values.push_back(low);
+            }
+        } else {
+            std::set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                                  std::back_inserter(result.values));
+        }
+        result.cardinality = static_cast<uint32_t>(result.values.size());
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap result;
+    auto ia = a.containers_.begin();
+    auto ib = b.containers_.begin();
+    while (ia != a.containers_.end() && ib != b.containers_.end()) {
+        if (ia->key < ib->key) {
+            ++ia;
+        } else if (ib->key < ia->key) {
+            ++ib;
+        } else {
+            Container c = intersectContainers(*ia, *ib);
+            if (c.cardinality > 0) {
+                result.cardinality_ += c.cardinality;
+                result.containers_.push_back(std::move(c));
+            }
+            ++ia;
+            ++ib;
+        }
+    }
+    return result;
+}
+
+void RoaringBitmap::uniteContainers(Container& target, const Container& other) {
+    if (!target.isBitset() && !other.isBitset()) {
+        std::vector<uint16_t> merged;
+        merged.reserve(target.values.size() + other.values.size());
+        std::set_union(target.values.begin(), target.values.end(), other.values.begin(), other.values.end(),
+                       std::back_inserter(merged));
+        target.values.swap(merged);
+        target.cardinality = static_cast<uint32_t>(target.values.size());
+        if (target.cardinality > kArrayMax) toBitset(target);
+        return;
+    }
+    if (!target.isBitset()) toBitset(target);
+    if (other.isBitset()) {
+        uint32_t count = 0;
+        for (size_t w = 0; w < kWords; ++w) {
+            target.words[w] |= other.words[w];
+            count += static_cast<uint32_t>(__builtin_popcountll(target.words[w]));
+        }
+        target.cardinality = count;
+    } else {
+        for (uint16_t low : other.values) {
+            uint64_t& word = target.words[low >> 6];
+            uint64_t mask = uint64_t(1) << (low & 63);
+            if (!(word & mask)) {
+                word |= mask;
+                target.cardinality++;
+            }
+        }
+    }
+}
+
+void RoaringBitmap::unite(const RoaringBitmap& other) {
+    std::vector<Container> merged;
+    merged.reserve(containers_.size() + other.containers_.size());
+    auto ia = containers_.begin();
+    auto ib = other.containers_.begin();
+    while (ia != containers_.end() || ib != other.containers_.end()) {
+        if (ib == other.containers_.end() || (ia != containers_.end() && ia->key < ib->key)) {
+            merged.push_back(std::move(*ia++));
+        } else if (ia == containers_.end() || ib->key < ia->key) {
+            merged.push_back(*ib++);
+        } else {
+            uniteContainers(*ia, *ib);
+            merged.push_back(std::move(*ia));
+            ++ia;
+            ++ib;
+        }
+    }
+    containers_.swap(merged);
+    cardinality_ = 0;
+    for (const Container& c : containers_) {
+        cardinality_ += c.cardinality;
+    }
+}
+
+void RoaringBitmap::subtractContainer(Container& target, const Container& other) {
+    if (!target.isBitset()) {
+        auto end = std::remove_if(target.values.begin(), target.values.end(),
+                                  [&other](uint16_t low) { return other.contains(low); });
+        target.values.erase(end, target.values.end());
+        target.cardinality = static_cast<uint32_t>(target.values.size());
+        return;
+    }
+    if (other.isBitset()) {
+        uint32_t count = 0;
+        for (size_t w = 0; w < kWords; ++w) {
+            target.words[w] &= ~other.words[w];
+            count += static_cast<uint32_t>(__builtin_popcountll(target.words[w]));
+        }
+        target.cardinality = count;
+    } else {
+        for (uint16_t low : other.values) {
+            uint64_t& word = target.words[low >> 6];
+            uint64_t mask = uint64_t(1) << (low & 63);
+            if (word & mask) {
+                word &= ~mask;
+                target.cardinality--;
+            }
+        }
+    }
+    if (target.cardinality <= kArrayMax / 2) toArray(target);
+}
+
+void RoaringBitmap::subtract(const RoaringBitmap& other) {
+    auto ib = other.containers_.begin();
+    for (Container& c : containers_) {
+        while (ib != other.containers_.end() && ib->key < c.key) ++ib;
+        if (ib == other.containers_.end()) break;
+        if (ib->key == c.key) subtractContainer(c, *ib);
+    }
+    containers_.erase(std::remove_if(containers_.begin(), containers_.end(),
+                                     [](const Container& c) { return c.cardinality == 0; }),
+                      containers_.end());
+    cardinality_ = 0;
+    for (const Container& c : containers_) {
+        cardinality_ += c.cardinality;
+    }
+}
+
+size_t RoaringBitmap::bytes() const {
+    size_t total = containers_.capacity() * sizeof(Container);
+    for (const Container& c : containers_) {
+        total += c.values.capacity() * sizeof(uint16_t) + c.words.capacity() * sizeof(uint64_t);
+    }
+    return total;
+}
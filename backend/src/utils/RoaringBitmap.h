@@ -0,0 +1,76 @@
+// FILE: backend/src/utils/RoaringBitmap.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Стиснений бітмап 32-бітних чисел (спрощений Roaring): старші 16 біт значення - ключ
+// контейнера, молодші - в контейнері. Контейнер - відсортований масив uint16 (до 4096
+// значень, 2 байти на значення) або бітсет на 65536 біт (8 КБ) для щільних діапазонів.
+class RoaringBitmap {
+private:
+    struct Container {
+        uint16_t key;
+        uint32_t cardinality;
+        std::vector<uint16_t> values; // Масив, якщо words порожній
+        std::vector<uint64_t> words;  // Бітсет з kWords слів
+
+        bool isBitset() const { return !words.empty(); }
+        bool contains(uint16_t low) const;
+    };
+
+    static const uint32_t kArrayMax = 4096;
+    static const size_t kWords = 65536 / 64;
+
+    std::vector<Container> containers_; // Впорядковані за key
+    size_t cardinality_ = 0;
+
+public:
+    void add(uint32_t value);
+    bool remove(uint32_t value);
+    bool contains(uint32_t value) const;
+    size_t cardinality() const { return cardinality_; }
+    bool empty() const { return cardinality_ == 0; }
+    void clear();
+
+    // a AND b
+    static RoaringBitmap intersect(const RoaringBitmap& a, const RoaringBitmap& b);
+    // this |= other
+    void unite(const RoaringBitmap& other);
+    // this &= ~other
+    void subtract(const RoaringBitmap& other);
+
+    // Обхід у порядку зростання: fn(value)
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const Container& c : containers_) {
+            uint32_t high = static_cast<uint32_t>(c.key) << 16;
+            if (c.isBitset()) {
+                for (size_t w = 0; w < kWords; ++w) {
+                    uint64_t word = c.words[w];
+                    while (word) {
+                        uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(word));
+                        fn(high | static_cast<uint32_t>(w * 64 + bit));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (uint16_t low : c.values) {
+                    fn(high | low);
+                }
+            }
+        }
+    }
+
+    // Приблизний обсяг пам'яті контейнерів
+    size_t bytes() const;
+
+private:
+    Container* findContainer(uint16_t key);
+    const Container* findContainer(uint16_t key) const;
+    static void toBitset(Container& c);
+    static void toArray(Container& c);
+    static Container intersectContainers(const Container& a, const Container& b);
+    static void uniteContainers(Container& target, const Container& other);
+    static void subtractContainer(Container& target, const Container& other);
+};
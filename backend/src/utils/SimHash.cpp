@@ -0,0 +1,78 @@
+// FILE: backend/src/utils/SimHash.cpp
+#include "SimHash.h"
+#include "Utf8.h"
+#include <vector>
+
+namespace simhash {
+
+namespace {
+
+uint64_t hashWord(const std::string& word, uint64_t seed) {
+    // FNV-1a з фінальним перемішуванням (splitmix64) для рівномірних бітів
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (unsigned char c : word) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+bool isWordChar(char32_t cp) {
+    return (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') ||
+           (cp >= 0xC0 && cp <= 0x24F) || (cp >= 0x0400 && cp <= 0x052F) ||
+           cp == 0x2019 || cp == '\'';
+}
+
+} // namespace
+
+uint64_t fingerprint(const std::string& text) {
+    // Слова у нижньому регістрі
+    std::vector<std::string> words;
+    std::string current;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char32_t cp = utf8::foldCase(utf8::decode(text, pos));
+        if (isWordChar(cp)) {
+            utf8::append(current, cp);
+        } else if (!current.empty()) {
+            words.push_back(std::move(current));
+            current.clear();
+        }
+    }
+    if (!current.empty()) {
+        words.push_back(std::move(current));
+    }
+    if (words.size() < kMinWords) {
+        return 0;
+    }
+    
+    // Голосування по бітах: слова та біграми (біграми враховують порядок слів)
+    int votes[64] = {0};
+    auto addFeature = [&votes](uint64_t h) {
+        for (int bit = 0; bit < 64; ++bit) {
+            votes[bit] += ((h >> bit) & 1) ? 1 : -1;
+        }
+    };
+    for (size_t i = 0; i < words.size(); ++i) {
+        addFeature(hashWord(words[i], 0));
+        if (i + 1 < words.size()) {
+            addFeature(hashWord(words[i], 1) ^ hashWord(words[i + 1], 2));
+        }
+    }
+    
+    uint64_t result = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (votes[bit] > 0) {
+            result |= 1ULL << bit;
+        }
+    }
+    // 0 зарезервовано як "без відбитка"
+    return result != 0 ? result : 1;
+}
+
+} // namespace simhash
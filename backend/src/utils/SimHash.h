@@ -0,0 +1,22 @@
+// FILE: backend/src/utils/SimHash.h
+#pragma once
+#include <cstdint>
+#include <string>
+
+// SimHash - 64-бітний відбиток тексту, стійкий до дрібних правок:
+// близькі тексти дають відбитки з малою відстанню Хеммінга.
+namespace simhash {
+
+// Мінімальна кількість слів, з якої текст має відбиток; коротші описи
+// ("Продам авто") занадто загальні й давали б хибні збіги
+const size_t kMinWords = 5;
+
+// Відбиток за словами та парами сусідніх слів (UTF-8, без урахування регістру).
+// 0 - тексту замало для відбитка.
+uint64_t fingerprint(const std::string& text);
+
+inline int distance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+} // namespace simhash
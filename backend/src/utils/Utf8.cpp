@@ -0,0 +1,87 @@
+// FILE: backend/src/utils/Utf8.cpp
+#include "Utf8.h"
+
+namespace utf8 {
+
+char32_t decode(const std::string& text, size_t& pos) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.size();
+    unsigned char c = p[pos];
+    
+    if (c < 0x80) {
+        ++pos;
+        return c;
+    }
+    
+    size_t length;
+    char32_t cp;
+    if ((c & 0xE0) == 0xC0) { length = 2; cp = c & 0x1F; }
+    else if ((c & 0xF0) == 0xE0) { length = 3; cp = c & 0x0F; }
+    else if ((c & 0xF8) == 0xF0) { length = 4; cp = c & 0x07; }
+    else { ++pos; return 0xFFFD; }
+    
+    if (pos + length > n) {
+        ++pos;
+        return 0xFFFD;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if ((p[pos + i] & 0xC0) != 0x80) {
+            ++pos;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (p[pos + i] & 0x3F);
+    }
+    pos += length;
+    return cp;
+}
+
+void append(std::string& out, char32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+char32_t foldCase(char32_t cp) {
+    if (cp >= 'A' && cp <= 'Z') return cp + 0x20;
+    if (cp < 0xC0) return cp;
+    // Латиниця-1: À..Þ, крім ×
+    if (cp <= 0xDE) return cp == 0xD7 ? cp : cp + 0x20;
+    // Кирилиця: Ѐ..Џ (включно з Є, І, Ї) та А..Я
+    if (cp >= 0x0400 && cp <= 0x040F) return cp + 0x50;
+    if (cp >= 0x0410 && cp <= 0x042F) return cp + 0x20;
+    // Розширена кирилиця: пари велика/мала з великою на парній позиції (Ѡ..ҁ, Ҋ..ҿ, Ӑ..ӿ)
+    if ((cp >= 0x0460 && cp <= 0x0481) || (cp >= 0x048A && cp <= 0x04BF) || (cp >= 0x04D0 && cp <= 0x04FF)) {
+        return (cp & 1) ? cp : cp + 1;
+    }
+    // Палочка Ӏ - мала ӏ стоїть окремо, після блоку Ӂ..ӎ
+    if (cp == 0x04C0) return 0x04CF;
+    // Ӂ..ӎ: велика на непарній позиції
+    if (cp >= 0x04C1 && cp <= 0x04CE) {
+        return (cp & 1) ? cp + 1 : cp;
+    }
+    return cp;
+}
+
+std::string foldCase(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+    size_t pos = 0;
+    while (pos < text.size()) {
+        append(result, foldCase(decode(text, pos)));
+    }
+    return result;
+}
+
+} // namespace utf8
@@ -0,0 +1,22 @@
+// FILE: backend/src/utils/Utf8.h
+#pragma once
+#include <string>
+
+// Утиліти для роботи з UTF-8 текстом
+namespace utf8 {
+
+// Декодування наступного символу з позиції pos (pos зсувається за символ).
+// Некоректна послідовність дає U+FFFD і зсув на один байт.
+char32_t decode(const std::string& text, size_t& pos);
+
+// Кодування символу в UTF-8
+void append(std::string& out, char32_t cp);
+
+// Приведення символу до нижнього регістру (case folding) для латиниці (ASCII,
+// Латиниця-1) та кирилиці U+0400..U+04FF, включно з українськими Є, І, Ї, Ґ
+char32_t foldCase(char32_t cp);
+
+// Рядок у нижньому регістрі з урахуванням кирилиці
+std::string foldCase(const std::string& text);
+
+} // namespace utf8
@@ -0,0 +1,68 @@
+// FILE: backend/tests/Utf8Test.cpp
+#include "utils/Utf8.h"
+#include <cstdio>
+
+// Перевірки utf8::foldCase; запуск - ctest (збірка з -DAUTORIA_BUILD_TESTS=ON)
+
+static int failures = 0;
+
+static void expectFold(char32_t cp, char32_t expected) {
+    char32_t actual = utf8::foldCase(cp);
+    if (actual != expected) {
+        std::printf("foldCase(U+%04X) = U+%04X, expected U+%04X\n",
+                    static_cast<unsigned>(cp), static_cast<unsigned>(actual), static_cast<unsigned>(expected));
+        ++failures;
+    }
+}
+
+static void expectFold(const char* text, const char* expected) {
+    std::string actual = utf8::foldCase(std::string(text));
+    if (actual != expected) {
+        std::printf("foldCase(\"%s\") = \"%s\", expected \"%s\"\n", text, actual.c_str(), expected);
+        ++failures;
+    }
+}
+
+int main() {
+    // ASCII та Латиниця-1 (× не має пари)
+    expectFold(U'A', U'a');
+    expectFold(U'z', U'z');
+    expectFold(0x00C0, 0x00E0);
+    expectFold(0x00D7, 0x00D7);
+    expectFold(0x00DE, 0x00FE);
+
+    // Основна кирилиця та українські літери
+    expectFold(0x0400, 0x0450); // Ѐ
+    expectFold(0x0404, 0x0454); // Є
+    expectFold(0x0406, 0x0456); // І
+    expectFold(0x0407, 0x0457); // Ї
+    expectFold(0x040F, 0x045F); // Џ
+    expectFold(0x0410, 0x0430); // А
+    expectFold(0x042F, 0x044F); // Я
+    expectFold(0x0490, 0x0491); // Ґ
+    expectFold(0x0491, 0x0491);
+
+    // Межі розширеної кирилиці
+    expectFold(0x0481, 0x0481);
+    expectFold(0x0482, 0x0482); // ҂ - не літера
+    expectFold(0x048A, 0x048B);
+    expectFold(0x04BE, 0x04BF);
+    expectFold(0x04BF, 0x04BF);
+    expectFold(0x04C0, 0x04CF); // Палочка
+    expectFold(0x04C1, 0x04C2); // Ӂ
+    expectFold(0x04C2, 0x04C2);
+    expectFold(0x04CD, 0x04CE);
+    expectFold(0x04CF, 0x04CF);
+    expectFold(0x04D0, 0x04D1);
+    expectFold(0x04FE, 0x04FF);
+    expectFold(0x04FF, 0x04FF);
+    expectFold(0x0500, 0x0500); // Поза заявленим діапазоном - без змін
+
+    expectFold("ҐАНОК Їжак ЄВРО", "ґанок їжак євро");
+    expectFold("ӀӁӾ", "ӏӂӿ");
+
+    if (failures == 0) {
+        std::printf("Utf8Test: OK\n");
+    }
+    return failures == 0 ? 0 : 1;
+}